@@ -5,6 +5,11 @@
 #define HAVE_SSE4_1 1
 #define HAVE_SSE_INTRINSICS 1
 
+/* Define to 1 if we have AVX CPU extensions, else 0 */
+#define HAVE_AVX 1
+/* Define to 1 if we have AVX2 and FMA3 CPU extensions, else 0 */
+#define HAVE_AVX2 1
+
 /* Define to 1 if we have ARM Neon CPU extensions, else 0 */
 #ifdef GRANITE_SYSTEM_LINUX
 #define HAVE_NEON 1
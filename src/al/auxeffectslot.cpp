@@ -23,16 +23,22 @@
 #include "auxeffectslot.h"
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <iterator>
 #include <memory>
 #include <mutex>
 #include <numeric>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "AL/al.h"
@@ -49,6 +55,8 @@
 #include "almalloc.h"
 #include "alnumeric.h"
 #include "alspan.h"
+#include "alstring.h"
+#include "althrd_setname.h"
 #include "atomic.h"
 #include "buffer.h"
 #include "core/buffer_storage.h"
@@ -59,6 +67,7 @@
 #include "direct_defs.h"
 #include "effect.h"
 #include "flexarray.h"
+#include "fmt/core.h"
 #include "opthelpers.h"
 
 #if ALSOFT_EAX
@@ -320,6 +329,154 @@ inline void UpdateProps(ALeffectslot *slot, ALCcontext *context)
     slot->mPropsDirty = true;
 }
 
+
+/* A request to prepare an effect state with a new buffer, for an effect slot
+ * using asynchronous buffer loading.
+ */
+struct BufferLoadRequest {
+    ContextRef mContext;
+    ALuint mSlotId{};
+    uint mRequestId{};
+    EffectSlotType mType{};
+    /* Referenced by the request, separately from the effect slot. */
+    ALbuffer *mBuffer{};
+
+    BufferLoadRequest() = default;
+    BufferLoadRequest(BufferLoadRequest&& rhs) noexcept
+        : mContext{std::move(rhs.mContext)}, mSlotId{rhs.mSlotId}, mRequestId{rhs.mRequestId}
+        , mType{rhs.mType}, mBuffer{std::exchange(rhs.mBuffer, nullptr)}
+    { }
+    ~BufferLoadRequest() { if(mBuffer) DecrementRef(mBuffer->ref); }
+
+    BufferLoadRequest& operator=(BufferLoadRequest&&) = delete;
+};
+
+std::atomic<uint> NextBufferRequestId{1u};
+
+void FinishBufferLoad(const BufferLoadRequest &request)
+{
+    ALCcontext *context{request.mContext.get()};
+    auto *device = context->mALDevice.get();
+
+    EffectStateFactory *factory{getFactoryByType(request.mType)};
+    assert(factory);
+    al::intrusive_ptr<EffectState> state{factory->create()};
+
+    /* Do the expensive preparation of the buffer without holding any device
+     * locks, for the sample rate the device has now. It's kept loaded until
+     * the state is updated below, which then reuses it.
+     */
+    uint devrate{};
+    {
+        std::lock_guard<std::mutex> statelock{device->StateLock};
+        devrate = device->Frequency;
+    }
+    std::shared_ptr<void> prepared;
+    if(request.mType == EffectSlotType::Convolution)
+    {
+        FPUCtl mixer_mode{};
+        prepared = PrepareConvolutionBuffer(devrate, request.mBuffer);
+    }
+
+    /* Only publish the new state if the effect slot still exists and hasn't
+     * had its effect or buffer changed since the request.
+     */
+    {
+        std::lock_guard<std::mutex> statelock{device->StateLock};
+        std::lock_guard<std::mutex> proplock{context->mPropLock};
+        std::lock_guard<std::mutex> slotlock{context->mEffectSlotLock};
+
+        ALeffectslot *slot{LookupEffectSlot(context, request.mSlotId)};
+        if(!slot || slot->mBufferRequestId != request.mRequestId
+            || slot->Effect.Type != request.mType)
+            return;
+
+        /* Update the state for the device's current output. This is cheap
+         * when the sample rate hasn't changed since preparing the buffer.
+         */
+        {
+            state->mOutTarget = device->Dry.Buffer;
+            FPUCtl mixer_mode{};
+            state->deviceUpdate(device, request.mBuffer);
+        }
+        slot->Effect.State = std::move(state);
+        slot->mBufferRequestId = 0;
+        UpdateProps(slot, context);
+    }
+
+    std::lock_guard<std::mutex> eventlock{context->mEventCbLock};
+    const auto enabledevts = context->mEnabledEvts.load(std::memory_order_acquire);
+    if(context->mEventCb
+        && enabledevts.test(al::to_underlying(AsyncEnableBits::EffectSlotBufferReady)))
+    {
+        const ALuint bufferid{request.mBuffer ? request.mBuffer->id : 0u};
+        const auto msg = fmt::format("Effect slot {} buffer {} ready", request.mSlotId,
+            bufferid);
+        context->mEventCb(AL_EVENT_TYPE_EFFECTSLOT_BUFFER_READY_SOFT, request.mSlotId,
+            bufferid, al::sizei(msg), msg.c_str(), context->mEventParam);
+    }
+}
+
+/* Prepares effect states for asynchronous buffer loads in the order they're
+ * requested, on a background thread.
+ */
+class BufferLoader {
+    std::mutex mLock;
+    std::condition_variable mCond;
+    std::deque<BufferLoadRequest> mQueue;
+    bool mQuit{false};
+    std::thread mThread;
+
+    void threadProc()
+    {
+        althrd_setname("alsoft-bufload");
+
+        auto loadlock = std::unique_lock{mLock};
+        while(true)
+        {
+            mCond.wait(loadlock, [this]{ return mQuit || !mQueue.empty(); });
+            if(mQuit) break;
+
+            auto request = BufferLoadRequest{std::move(mQueue.front())};
+            mQueue.pop_front();
+            loadlock.unlock();
+
+            try {
+                FinishBufferLoad(request);
+            }
+            catch(std::exception &e) {
+                ERR("Failed to load buffer for effect slot {}: {}", request.mSlotId,
+                    e.what());
+            }
+            loadlock.lock();
+        }
+    }
+
+public:
+    ~BufferLoader()
+    {
+        {
+            std::lock_guard<std::mutex> loadlock{mLock};
+            mQuit = true;
+        }
+        mCond.notify_one();
+        if(mThread.joinable())
+            mThread.join();
+    }
+
+    void queue(BufferLoadRequest&& request)
+    {
+        {
+            std::lock_guard<std::mutex> loadlock{mLock};
+            if(!mThread.joinable())
+                mThread = std::thread{&BufferLoader::threadProc, this};
+            mQueue.emplace_back(std::move(request));
+        }
+        mCond.notify_one();
+    }
+};
+BufferLoader gBufferLoader;
+
 } // namespace
 
 
@@ -568,6 +725,46 @@ try {
         else if(value == 0)
             return;
 
+        if(slot->mAsyncBuffer)
+        {
+            auto *device = context->mALDevice.get();
+            auto bufferlock = std::unique_lock{device->BufferLock};
+            ALbuffer *buffer{};
+            if(value)
+            {
+                buffer = LookupBuffer(device, static_cast<ALuint>(value));
+                if(!buffer)
+                    context->throw_error(AL_INVALID_VALUE, "Invalid buffer ID {}", value);
+                if(buffer->mCallback)
+                    context->throw_error(AL_INVALID_OPERATION,
+                        "Callback buffer not valid for effects");
+
+                /* One reference for the effect slot, and one for the request. */
+                IncrementRef(buffer->ref);
+                IncrementRef(buffer->ref);
+            }
+
+            if(ALbuffer *oldbuffer{slot->Buffer})
+                DecrementRef(oldbuffer->ref);
+            slot->Buffer = buffer;
+            bufferlock.unlock();
+
+            /* The effect slot keeps its current state until the new one is
+             * ready. A newer request replaces any still pending.
+             */
+            auto request = BufferLoadRequest{};
+            context->add_ref();
+            request.mContext = ContextRef{context};
+            request.mSlotId = slot->id;
+            request.mRequestId = NextBufferRequestId.fetch_add(1u, std::memory_order_relaxed);
+            request.mType = slot->Effect.Type;
+            request.mBuffer = buffer;
+            slot->mBufferRequestId = request.mRequestId;
+            gBufferLoader.queue(std::move(request));
+            return;
+        }
+        slot->mBufferRequestId = 0;
+
         if(slot->mState == SlotState::Playing)
         {
             EffectStateFactory *factory{getFactoryByType(slot->Effect.Type)};
@@ -639,6 +836,12 @@ try {
 
     case AL_EFFECTSLOT_STATE_SOFT:
         context->throw_error(AL_INVALID_OPERATION, "AL_EFFECTSLOT_STATE_SOFT is read-only");
+
+    case AL_EFFECTSLOT_ASYNC_BUFFER_SOFT:
+        if(!(value == AL_TRUE || value == AL_FALSE))
+            context->throw_error(AL_INVALID_VALUE, "Effect slot async buffer out of range");
+        slot->mAsyncBuffer = !!value;
+        return;
     }
 
     context->throw_error(AL_INVALID_ENUM, "Invalid effect slot integer property {:#04x}",
@@ -661,6 +864,7 @@ try {
     case AL_EFFECTSLOT_TARGET_SOFT:
     case AL_EFFECTSLOT_STATE_SOFT:
     case AL_BUFFER:
+    case AL_EFFECTSLOT_ASYNC_BUFFER_SOFT:
         alAuxiliaryEffectSlotiDirect(context, effectslot, param, *values);
         return;
     }
@@ -774,6 +978,10 @@ try {
         else
             *value = 0;
         return;
+
+    case AL_EFFECTSLOT_ASYNC_BUFFER_SOFT:
+        *value = slot->mAsyncBuffer ? AL_TRUE : AL_FALSE;
+        return;
     }
 
     context->throw_error(AL_INVALID_ENUM, "Invalid effect slot integer property {:#04x}",
@@ -796,6 +1004,7 @@ try {
     case AL_EFFECTSLOT_TARGET_SOFT:
     case AL_EFFECTSLOT_STATE_SOFT:
     case AL_BUFFER:
+    case AL_EFFECTSLOT_ASYNC_BUFFER_SOFT:
         alGetAuxiliaryEffectSlotiDirect(context, effectslot, param, values);
         return;
     }
@@ -918,6 +1127,7 @@ ALenum ALeffectslot::initEffect(ALuint effectId, ALenum effectType, const Effect
         Effect.Props = effectProps;
 
         Effect.State = std::move(state);
+        mBufferRequestId = 0;
     }
     else if(newtype != EffectSlotType::None)
         Effect.Props = effectProps;
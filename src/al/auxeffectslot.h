@@ -62,6 +62,12 @@ struct ALeffectslot {
 
     SlotState mState{SlotState::Initial};
 
+    /* Whether new buffers are prepared on a background thread, and the ID of
+     * the pending request for it (0 if none).
+     */
+    bool mAsyncBuffer{false};
+    ALuint mBufferRequestId{0u};
+
     std::atomic<ALuint> ref{0u};
 
     EffectSlot *mSlot{nullptr};
@@ -36,6 +36,7 @@
 #include <numeric>
 #include <optional>
 #include <stdexcept>
+#include <system_error>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -59,6 +60,7 @@
 #include "direct_defs.h"
 #include "intrusive_ptr.h"
 #include "opthelpers.h"
+#include "source.h"
 
 #if ALSOFT_EAX
 #include <unordered_set>
@@ -366,6 +368,8 @@ void LoadData(ALCcontext *context, ALbuffer *ALBuf, ALsizei freq, ALuint size,
         newdata.swap(ALBuf->mDataStorage);
     }
     ALBuf->mData = ALBuf->mDataStorage;
+    ALBuf->mFileMap.reset();
+    ALBuf->newGeneration();
 #if ALSOFT_EAX
     eax_x_ram_clear(*context->mALDevice, *ALBuf);
 #endif
@@ -431,6 +435,8 @@ void PrepareCallback(ALCcontext *context, ALbuffer *ALBuf, ALsizei freq,
     using BufferVectorType = decltype(ALBuf->mDataStorage);
     BufferVectorType(line_blocks*BlockSize).swap(ALBuf->mDataStorage);
     ALBuf->mData = ALBuf->mDataStorage;
+    ALBuf->mFileMap.reset();
+    ALBuf->newGeneration();
 
 #if ALSOFT_EAX
     eax_x_ram_clear(*context->mALDevice, *ALBuf);
@@ -525,6 +531,8 @@ void PrepareUserPtr(ALCcontext *context [[maybe_unused]], ALbuffer *ALBuf, ALsiz
 
     decltype(ALBuf->mDataStorage){}.swap(ALBuf->mDataStorage);
     ALBuf->mData = al::span{sdata, sdatalen};
+    ALBuf->mFileMap.reset();
+    ALBuf->newGeneration();
 
 #if ALSOFT_EAX
     eax_x_ram_clear(*context->mALDevice, *ALBuf);
@@ -662,6 +670,69 @@ auto DecomposeUserFormat(ALenum format) noexcept -> std::optional<DecompResult>
     return std::nullopt;
 }
 
+
+constexpr ALbitfieldSOFT INVALID_MAP_FILE_FLAGS{~unsigned(AL_MAP_FILE_SEQUENTIAL_BIT_SOFT
+    | AL_MAP_FILE_RANDOM_BIT_SOFT | AL_MAP_FILE_PRELOAD_BIT_SOFT)};
+
+/**
+ * Maps part of a file with the given mapper, and sets it as the buffer's
+ * storage. The samples are read straight from the mapping by the mixer, so
+ * they're only paged in from the file as they're needed (unless preloaded).
+ */
+template<typename F>
+void LoadFileData(ALCcontext *context, const ALuint buffer, const ALenum format,
+    const ALint64SOFT offset, const ALsizei size, const ALsizei freq, const ALbitfieldSOFT flags,
+    F&& mapper)
+{
+    auto *device = context->mALDevice.get();
+    auto buflock = std::lock_guard{device->BufferLock};
+
+    ALbuffer *albuf{LookupBuffer(device, buffer)};
+    if(!albuf)
+        context->throw_error(AL_INVALID_NAME, "Invalid buffer ID {}", buffer);
+    if(offset < 0)
+        context->throw_error(AL_INVALID_VALUE, "Negative file offset {}", offset);
+    if(size < 0)
+        context->throw_error(AL_INVALID_VALUE, "Negative storage size {}", size);
+    if(freq < 1)
+        context->throw_error(AL_INVALID_VALUE, "Invalid sample rate {}", freq);
+    if((flags&INVALID_MAP_FILE_FLAGS) != 0)
+        context->throw_error(AL_INVALID_VALUE, "Invalid file mapping flags {:#x}",
+            flags&INVALID_MAP_FILE_FLAGS);
+    if((flags&AL_MAP_FILE_SEQUENTIAL_BIT_SOFT) && (flags&AL_MAP_FILE_RANDOM_BIT_SOFT))
+        context->throw_error(AL_INVALID_VALUE,
+            "Declaring file access as both sequential and random");
+
+    auto usrfmt = DecomposeUserFormat(format);
+    if(!usrfmt)
+        context->throw_error(AL_INVALID_ENUM, "Invalid format {:#04x}", as_unsigned(format));
+    if(albuf->ref.load(std::memory_order_relaxed) != 0 || albuf->MappedAccess != 0)
+        context->throw_error(AL_INVALID_OPERATION, "Modifying storage for in-use buffer {}",
+            albuf->id);
+
+    std::optional<FileMapping> filemap{mapper(static_cast<std::uint64_t>(offset),
+        static_cast<std::size_t>(size))};
+    if(!filemap)
+        context->throw_error(AL_INVALID_VALUE, "Failed to map file: {}",
+            std::generic_category().message(errno));
+
+    const auto data = filemap->data();
+    if(data.size() > std::numeric_limits<ALsizei>::max())
+        context->throw_error(AL_OUT_OF_MEMORY, "Mapped file size {} is too large",
+            data.size());
+
+    if((flags&AL_MAP_FILE_SEQUENTIAL_BIT_SOFT))
+        filemap->advise(FileMapping::Advice::Sequential);
+    else if((flags&AL_MAP_FILE_RANDOM_BIT_SOFT))
+        filemap->advise(FileMapping::Advice::Random);
+    if((flags&AL_MAP_FILE_PRELOAD_BIT_SOFT))
+        filemap->advise(FileMapping::Advice::WillNeed);
+
+    PrepareUserPtr(context, albuf, freq, usrfmt->channels, usrfmt->type, data.data(),
+        static_cast<ALuint>(data.size()));
+    albuf->mFileMap = std::move(*filemap);
+}
+
 } // namespace
 
 
@@ -696,6 +767,9 @@ try {
         context->throw_error(AL_INVALID_VALUE, "Deleting {} buffers", n);
     if(n <= 0) UNLIKELY return;
 
+    /* Finished one-shot sounds may still hold the buffers being deleted. */
+    ReclaimOneShotSources(context);
+
     auto *device = context->mALDevice.get();
     auto buflock = std::lock_guard{device->BufferLock};
 
@@ -811,6 +885,42 @@ catch(std::exception &e) {
     ERR("Caught exception: {}", e.what());
 }
 
+AL_API DECL_FUNCEXT7(void, alBufferDataFile,SOFT, ALuint,buffer, ALenum,format, const ALchar*,filename, ALint64SOFT,offset, ALsizei,size, ALsizei,freq, ALbitfieldSOFT,flags)
+FORCE_ALIGN void AL_APIENTRY alBufferDataFileDirectSOFT(ALCcontext *context, ALuint buffer,
+    ALenum format, const ALchar *filename, ALint64SOFT offset, ALsizei size, ALsizei freq,
+    ALbitfieldSOFT flags) noexcept
+try {
+    if(!filename)
+        context->throw_error(AL_INVALID_VALUE, "NULL filename");
+
+    LoadFileData(context, buffer, format, offset, size, freq, flags,
+        [filename](const std::uint64_t fileoffset, const std::size_t length)
+        { return FileMapping::Open(filename, fileoffset, length); });
+}
+catch(al::base_exception&) {
+}
+catch(std::exception &e) {
+    ERR("Caught exception: {}", e.what());
+}
+
+AL_API DECL_FUNCEXT7(void, alBufferDataFd,SOFT, ALuint,buffer, ALenum,format, ALint,fd, ALint64SOFT,offset, ALsizei,size, ALsizei,freq, ALbitfieldSOFT,flags)
+FORCE_ALIGN void AL_APIENTRY alBufferDataFdDirectSOFT(ALCcontext *context, ALuint buffer,
+    ALenum format, ALint fd, ALint64SOFT offset, ALsizei size, ALsizei freq,
+    ALbitfieldSOFT flags) noexcept
+try {
+    if(fd < 0)
+        context->throw_error(AL_INVALID_VALUE, "Invalid file descriptor {}", fd);
+
+    LoadFileData(context, buffer, format, offset, size, freq, flags,
+        [fd](const std::uint64_t fileoffset, const std::size_t length)
+        { return FileMapping::Open(fd, fileoffset, length); });
+}
+catch(al::base_exception&) {
+}
+catch(std::exception &e) {
+    ERR("Caught exception: {}", e.what());
+}
+
 AL_API DECL_FUNCEXT4(void*, alMapBuffer,SOFT, ALuint,buffer, ALsizei,offset, ALsizei,length, ALbitfieldSOFT,access)
 FORCE_ALIGN void* AL_APIENTRY alMapBufferDirectSOFT(ALCcontext *context, ALuint buffer,
     ALsizei offset, ALsizei length, ALbitfieldSOFT access) noexcept
@@ -874,6 +984,11 @@ try {
     if(albuf->MappedAccess == 0)
         context->throw_error(AL_INVALID_OPERATION, "Unmapping unmapped buffer {}", buffer);
 
+    /* Data written through the mapping makes anything prepared from the
+     * buffer out of date.
+     */
+    if((albuf->MappedAccess&AL_MAP_WRITE_BIT_SOFT))
+        albuf->newGeneration();
     albuf->MappedAccess = 0;
     albuf->MappedOffset = 0;
     albuf->MappedSize = 0;
@@ -909,6 +1024,7 @@ try {
      * and hope for the best...
      */
     std::atomic_thread_fence(std::memory_order_seq_cst);
+    albuf->newGeneration();
 }
 catch(al::base_exception&) {
 }
@@ -966,6 +1082,7 @@ try {
             length, byte_align, align);
 
     std::memcpy(albuf->mData.data()+offset, data, static_cast<ALuint>(length));
+    albuf->newGeneration();
 }
 catch(al::base_exception&) {
 }
@@ -17,6 +17,7 @@
 #include "almalloc.h"
 #include "alnumeric.h"
 #include "core/buffer_storage.h"
+#include "filemap.h"
 #include "vector.h"
 
 #if ALSOFT_EAX
@@ -32,6 +33,8 @@ struct ALbuffer : public BufferStorage {
     ALbitfieldSOFT Access{0u};
 
     al::vector<std::byte,16> mDataStorage;
+    /* Backs mData when the buffer is loaded from a file. */
+    FileMapping mFileMap;
 
     ALuint OriginalSize{0};
 
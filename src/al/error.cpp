@@ -125,5 +125,13 @@ FORCE_ALIGN ALenum AL_APIENTRY alGetErrorDirect(ALCcontext *context) noexcept
     ALenum ret{context->mLastThreadError.get()};
     if(ret != AL_NO_ERROR) UNLIKELY
         context->mLastThreadError.set(AL_NO_ERROR);
+    /* Report an invalid ID in an asynchronous source command, which is found
+     * when the command is applied on another thread.
+     */
+    else if(context->mSourceCommandInvalid.load(std::memory_order_relaxed)) UNLIKELY
+    {
+        if(context->mSourceCommandInvalid.exchange(false, std::memory_order_acquire))
+            ret = AL_INVALID_NAME;
+    }
     return ret;
 }
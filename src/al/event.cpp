@@ -5,6 +5,7 @@
 
 #include <atomic>
 #include <bitset>
+#include <chrono>
 #include <exception>
 #include <memory>
 #include <mutex>
@@ -19,7 +20,9 @@
 #include "AL/alc.h"
 #include "AL/alext.h"
 
+#include "al/source.h"
 #include "alc/context.h"
+#include "alc/events.h"
 #include "alnumeric.h"
 #include "alsem.h"
 #include "alspan.h"
@@ -31,6 +34,7 @@
 #include "core/logging.h"
 #include "debug.h"
 #include "direct_defs.h"
+#include "fmt/core.h"
 #include "intrusive_ptr.h"
 #include "opthelpers.h"
 #include "ringbuffer.h"
@@ -50,6 +54,16 @@ int EventThread(ALCcontext *context)
     bool quitnow{false};
     while(!quitnow)
     {
+        if(context->mSourceCommandsPending.exchange(false, std::memory_order_acq_rel))
+        {
+            try {
+                ProcessSourceCommands(context);
+            }
+            catch(std::exception &e) {
+                ERR("Caught exception applying source commands: {}", e.what());
+            }
+        }
+
         auto evt_data = ring->getReadVector()[0];
         if(evt_data.len == 0)
         {
@@ -124,8 +138,18 @@ int EventThread(ALCcontext *context)
                     evt.msg.c_str(), context->mEventParam);
             };
 
+            auto proc_overrun = [context](AsyncMixerOverrunEvent &evt)
+            {
+                using fmilliseconds = std::chrono::duration<double,std::milli>;
+                const auto msg = fmt::format("Mixer overrun: {:.2f}ms to mix {} samples ({:.2f}ms)",
+                    fmilliseconds{evt.mMixTime}.count(), evt.mSamples,
+                    fmilliseconds{evt.mBudget}.count());
+                alc::Event(alc::EventType::MixerOverrun, alc::DeviceType::Playback,
+                    context->mALDevice.get(), msg);
+            };
+
             std::visit(overloaded{proc_srcstate, proc_buffercomp, proc_release, proc_disconnect,
-                proc_killthread}, event);
+                proc_overrun, proc_killthread}, event);
         }
         std::destroy(evt_span.begin(), evt_span.end());
         ring->readAdvance(evt_span.size());
@@ -140,6 +164,8 @@ constexpr std::optional<AsyncEnableBits> GetEventType(ALenum etype) noexcept
     case AL_EVENT_TYPE_BUFFER_COMPLETED_SOFT: return AsyncEnableBits::BufferCompleted;
     case AL_EVENT_TYPE_DISCONNECTED_SOFT: return AsyncEnableBits::Disconnected;
     case AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT: return AsyncEnableBits::SourceState;
+    case AL_EVENT_TYPE_EFFECTSLOT_BUFFER_READY_SOFT:
+        return AsyncEnableBits::EffectSlotBufferReady;
     }
     return std::nullopt;
 }
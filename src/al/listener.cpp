@@ -31,6 +31,7 @@
 #include "AL/efx.h"
 
 #include "alc/context.h"
+#include "alc/inprogext.h"
 #include "alnumeric.h"
 #include "alspan.h"
 #include "core/except.h"
@@ -91,6 +92,30 @@ try {
         listener.mMetersPerUnit = value;
         UpdateProps(context);
         return;
+
+    case AL_LOW_ORDER_PANNING_DISTANCE_SOFT:
+        if(!(value >= 0.0f))
+            context->throw_error(AL_INVALID_VALUE,
+                "Listener low-order panning distance {:f} out of range", value);
+        listener.mLowOrderDistance = value;
+        UpdateProps(context);
+        return;
+
+    case AL_LOW_ORDER_PANNING_GAIN_SOFT:
+        if(!(value >= 0.0f && std::isfinite(value)))
+            context->throw_error(AL_INVALID_VALUE,
+                "Listener low-order panning gain {:f} out of range", value);
+        listener.mLowOrderGain = value;
+        UpdateProps(context);
+        return;
+
+    case AL_LISTENER_UPDATE_TOLERANCE_SOFT:
+        if(!(value >= 0.0f && std::isfinite(value)))
+            context->throw_error(AL_INVALID_VALUE,
+                "Listener update tolerance {:f} out of range", value);
+        listener.mUpdateTolerance = value;
+        UpdateProps(context);
+        return;
     }
     context->throw_error(AL_INVALID_ENUM, "Invalid listener float property {:#04x}",
         as_unsigned(param));
@@ -147,6 +172,9 @@ try {
     {
     case AL_GAIN:
     case AL_METERS_PER_UNIT:
+    case AL_LOW_ORDER_PANNING_DISTANCE_SOFT:
+    case AL_LOW_ORDER_PANNING_GAIN_SOFT:
+    case AL_LISTENER_UPDATE_TOLERANCE_SOFT:
         alListenerfDirect(context, param, *values);
         return;
 
@@ -268,6 +296,9 @@ try {
     {
     case AL_GAIN: *value = listener.Gain; return;
     case AL_METERS_PER_UNIT: *value = listener.mMetersPerUnit; return;
+    case AL_LOW_ORDER_PANNING_DISTANCE_SOFT: *value = listener.mLowOrderDistance; return;
+    case AL_LOW_ORDER_PANNING_GAIN_SOFT: *value = listener.mLowOrderGain; return;
+    case AL_LISTENER_UPDATE_TOLERANCE_SOFT: *value = listener.mUpdateTolerance; return;
     }
     context->throw_error(AL_INVALID_ENUM, "Invalid listener float property {:#04x}",
         as_unsigned(param));
@@ -321,6 +352,9 @@ try {
     {
     case AL_GAIN:
     case AL_METERS_PER_UNIT:
+    case AL_LOW_ORDER_PANNING_DISTANCE_SOFT:
+    case AL_LOW_ORDER_PANNING_GAIN_SOFT:
+    case AL_LISTENER_UPDATE_TOLERANCE_SOFT:
         alGetListenerfDirect(context, param, values);
         return;
 
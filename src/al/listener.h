@@ -2,6 +2,7 @@
 #define AL_LISTENER_H
 
 #include <array>
+#include <limits>
 
 #include "AL/efx.h"
 
@@ -15,6 +16,9 @@ struct ALlistener {
     std::array<float,3> OrientUp{{0.0f, 1.0f, 0.0f}};
     float Gain{1.0f};
     float mMetersPerUnit{AL_DEFAULT_METERS_PER_UNIT};
+    float mLowOrderDistance{std::numeric_limits<float>::max()};
+    float mLowOrderGain{0.0f};
+    float mUpdateTolerance{0.0f};
 
     DISABLE_ALLOC
 };
@@ -72,6 +72,7 @@
 #include "flexarray.h"
 #include "intrusive_ptr.h"
 #include "opthelpers.h"
+#include "ringbuffer.h"
 
 #if ALSOFT_EAX
 #include "eax/api.h"
@@ -147,6 +148,7 @@ void UpdateSourceProps(const ALsource *source, Voice *voice, ALCcontext *context
     props->mResampler = source->mResampler;
     props->DirectChannels = source->DirectChannels;
     props->mSpatializeMode = source->mSpatialize;
+    props->mLowOrderMode = source->mLowOrder;
 
     props->DryGainHFAuto = source->DryGainHFAuto;
     props->WetGainAuto = source->WetGainAuto;
@@ -445,7 +447,7 @@ struct VoicePos {
  * using the given offset type and offset. If the offset is out of range,
  * returns an empty optional.
  */
-std::optional<VoicePos> GetSampleOffset(std::deque<ALbufferQueueItem> &BufferList,
+std::optional<VoicePos> GetSampleOffset(ALbufferQueue &BufferList,
     ALenum OffsetType, double Offset)
 {
     /* Find the first valid Buffer in the Queue */
@@ -551,6 +553,7 @@ void InitVoice(Voice *voice, ALsource *source, ALbufferQueueItem *BufferList, AL
 
     if(buffer->mCallback) voice->mFlags.set(VoiceIsCallback);
     else if(source->SourceType == AL_STATIC) voice->mFlags.set(VoiceIsStatic);
+    if(source->mOneShot) voice->mFlags.set(VoiceIsOneShot);
     voice->mNumCallbackBlocks = 0;
     voice->mCallbackBlockBase = 0;
 
@@ -628,8 +631,7 @@ auto SetVoiceOffset(Voice *oldvoice, const VoicePos &vpos, ALsource *source, ALC
     }
     if(!newvoice) UNLIKELY
     {
-        auto &allvoices = *context->mVoices.load(std::memory_order_relaxed);
-        if(allvoices.size() == voicelist.size())
+        if(context->getVoiceCapacity() == voicelist.size())
             context->allocVoices(1);
         context->mActiveVoiceCount.fetch_add(1, std::memory_order_release);
         voicelist = context->getVoicesSpan();
@@ -896,6 +898,28 @@ ALenum EnumFromSpatializeMode(SpatializeMode mode)
         int{al::to_underlying(mode)})};
 }
 
+auto LowOrderModeFromEnum = [](auto mode) noexcept -> std::optional<LowOrderMode>
+{
+    switch(mode)
+    {
+    case AL_FALSE: return LowOrderMode::Off;
+    case AL_TRUE: return LowOrderMode::On;
+    case AL_AUTO_SOFT: return LowOrderMode::Auto;
+    }
+    return std::nullopt;
+};
+ALenum EnumFromLowOrderMode(LowOrderMode mode)
+{
+    switch(mode)
+    {
+    case LowOrderMode::Off: return AL_FALSE;
+    case LowOrderMode::On: return AL_TRUE;
+    case LowOrderMode::Auto: return AL_AUTO_SOFT;
+    }
+    throw std::runtime_error{fmt::format("Invalid LowOrderMode: {}",
+        int{al::to_underlying(mode)})};
+}
+
 auto DirectModeFromEnum = [](auto mode) noexcept -> std::optional<DirectMode>
 {
     switch(mode)
@@ -1030,6 +1054,12 @@ enum SourceProp : ALenum {
     /* AL_SOFT_source_panning */
     srcPanningEnabledSOFT = AL_PANNING_ENABLED_SOFT,
     srcPanSOFT = AL_PAN_SOFT,
+
+    /* AL_SOFT_buffer_queue_capacity */
+    srcBufferQueueCapacitySOFT = AL_BUFFER_QUEUE_CAPACITY_SOFT,
+
+    /* AL_SOFT_low_order_panning */
+    srcLowOrderPanningSOFT = AL_LOW_ORDER_PANNING_SOFT,
 };
 
 
@@ -1056,9 +1086,11 @@ constexpr ALuint IntValsByProp(ALenum prop)
     case AL_DISTANCE_MODEL:
     case AL_SOURCE_RESAMPLER_SOFT:
     case AL_SOURCE_SPATIALIZE_SOFT:
+    case AL_LOW_ORDER_PANNING_SOFT:
     case AL_STEREO_MODE_SOFT:
     case AL_PANNING_ENABLED_SOFT:
     case AL_PAN_SOFT:
+    case AL_BUFFER_QUEUE_CAPACITY_SOFT:
         return 1;
 
     case AL_SOURCE_RADIUS: /*AL_BYTE_RW_OFFSETS_SOFT:*/
@@ -1135,9 +1167,11 @@ constexpr ALuint Int64ValsByProp(ALenum prop)
     case AL_DISTANCE_MODEL:
     case AL_SOURCE_RESAMPLER_SOFT:
     case AL_SOURCE_SPATIALIZE_SOFT:
+    case AL_LOW_ORDER_PANNING_SOFT:
     case AL_STEREO_MODE_SOFT:
     case AL_PANNING_ENABLED_SOFT:
     case AL_PAN_SOFT:
+    case AL_BUFFER_QUEUE_CAPACITY_SOFT:
         return 1;
 
     case AL_SOURCE_RADIUS: /*AL_BYTE_RW_OFFSETS_SOFT:*/
@@ -1226,6 +1260,7 @@ constexpr ALuint FloatValsByProp(ALenum prop)
     case AL_SOURCE_TYPE:
     case AL_SOURCE_RESAMPLER_SOFT:
     case AL_SOURCE_SPATIALIZE_SOFT:
+    case AL_LOW_ORDER_PANNING_SOFT:
     case AL_BYTE_LENGTH_SOFT:
     case AL_SAMPLE_LENGTH_SOFT:
     case AL_SEC_LENGTH_SOFT:
@@ -1260,6 +1295,7 @@ constexpr ALuint FloatValsByProp(ALenum prop)
     case AL_BUFFER:
     case AL_DIRECT_FILTER:
     case AL_AUXILIARY_SEND_FILTER:
+    case AL_BUFFER_QUEUE_CAPACITY_SOFT:
         break; /* i/i64 only */
     case AL_SAMPLE_OFFSET_LATENCY_SOFT:
     case AL_SAMPLE_OFFSET_CLOCK_SOFT:
@@ -1301,6 +1337,7 @@ constexpr ALuint DoubleValsByProp(ALenum prop)
     case AL_SOURCE_TYPE:
     case AL_SOURCE_RESAMPLER_SOFT:
     case AL_SOURCE_SPATIALIZE_SOFT:
+    case AL_LOW_ORDER_PANNING_SOFT:
     case AL_BYTE_LENGTH_SOFT:
     case AL_SAMPLE_LENGTH_SOFT:
     case AL_SEC_LENGTH_SOFT:
@@ -1333,6 +1370,7 @@ constexpr ALuint DoubleValsByProp(ALenum prop)
     case AL_BUFFER:
     case AL_DIRECT_FILTER:
     case AL_AUXILIARY_SEND_FILTER:
+    case AL_BUFFER_QUEUE_CAPACITY_SOFT:
         break; /* i/i64 only */
     case AL_SAMPLE_OFFSET_LATENCY_SOFT:
     case AL_SAMPLE_OFFSET_CLOCK_SOFT:
@@ -1422,6 +1460,8 @@ auto GetCheckers(ALCcontext *context, const SourceProp prop, const al::span<T,N>
     };
 }
 
+void ApplySourceCommands(ALCcontext *const context);
+
 template<typename T>
 NOINLINE void SetProperty(ALsource *const Source, ALCcontext *const Context, const SourceProp prop,
     const al::span<const T> values)
@@ -1613,17 +1653,20 @@ NOINLINE void SetProperty(ALsource *const Source, ALCcontext *const Context, con
         if constexpr(std::is_integral_v<T>)
         {
             CheckSize(1);
+            /* Apply any queued commands first, to check the current state. */
+            ApplySourceCommands(Context);
             if(const ALenum state{GetSourceState(Source, GetSourceVoice(Source, Context))};
                 state == AL_PLAYING || state == AL_PAUSED)
                 Context->throw_error(AL_INVALID_OPERATION,
                     "Setting buffer on playing or paused source {}", Source->id);
 
-            std::deque<ALbufferQueueItem> oldlist;
+            std::unique_lock<std::mutex> buflock{device->BufferLock, std::defer_lock};
+            ALbuffer *buffer{nullptr};
             if(values[0])
             {
                 using UT = std::make_unsigned_t<T>;
-                std::lock_guard<std::mutex> buflock{device->BufferLock};
-                ALbuffer *buffer{LookupBuffer(device, static_cast<UT>(values[0]))};
+                buflock.lock();
+                buffer = LookupBuffer(device, static_cast<UT>(values[0]));
                 if(!buffer)
                     Context->throw_error(AL_INVALID_VALUE, "Invalid buffer ID {}", values[0]);
                 if(buffer->MappedAccess && !(buffer->MappedAccess&AL_MAP_PERSISTENT_BIT_SOFT))
@@ -1632,42 +1675,56 @@ NOINLINE void SetProperty(ALsource *const Source, ALCcontext *const Context, con
                 if(buffer->mCallback && buffer->ref.load(std::memory_order_relaxed) != 0)
                     Context->throw_error(AL_INVALID_OPERATION,
                         "Setting already-set callback buffer {}", buffer->id);
+            }
+
+            /* Delete all elements in the previous queue */
+            for(auto &item : Source->mQueue)
+            {
+                if(ALbuffer *oldbuffer{item.mBuffer})
+                    DecrementRef(oldbuffer->ref);
+            }
+            Source->mQueue.clear();
 
+            if(buffer)
+            {
                 /* Add the selected buffer to a one-item queue */
-                std::deque<ALbufferQueueItem> newlist;
-                newlist.emplace_back();
-                newlist.back().mCallback = buffer->mCallback;
-                newlist.back().mUserData = buffer->mUserData;
-                newlist.back().mBlockAlign = buffer->mBlockAlign;
-                newlist.back().mSampleLen = buffer->mSampleLen;
-                newlist.back().mLoopStart = buffer->mLoopStart;
-                newlist.back().mLoopEnd = buffer->mLoopEnd;
-                newlist.back().mSamples = buffer->mData;
-                newlist.back().mBuffer = buffer;
+                auto &item = Source->mQueue.emplace_back();
+                item.mCallback = buffer->mCallback;
+                item.mUserData = buffer->mUserData;
+                item.mBlockAlign = buffer->mBlockAlign;
+                item.mSampleLen = buffer->mSampleLen;
+                item.mLoopStart = buffer->mLoopStart;
+                item.mLoopEnd = buffer->mLoopEnd;
+                item.mSamples = buffer->mData;
+                item.mBuffer = buffer;
                 IncrementRef(buffer->ref);
 
                 /* Source is now Static */
                 Source->SourceType = AL_STATIC;
-                Source->mQueue.swap(oldlist);
-                Source->mQueue.swap(newlist);
             }
             else
             {
                 /* Source is now Undetermined */
                 Source->SourceType = AL_UNDETERMINED;
-                Source->mQueue.swap(oldlist);
-            }
-
-            /* Delete all elements in the previous queue */
-            for(auto &item : oldlist)
-            {
-                if(ALbuffer *buffer{item.mBuffer})
-                    DecrementRef(buffer->ref);
             }
             return;
         }
         break;
 
+    case AL_BUFFER_QUEUE_CAPACITY_SOFT:
+        if constexpr(std::is_integral_v<T>)
+        {
+            CheckSize(1);
+            CheckValue(values[0] >= 0 && values[0] <= T{MaxBufferQueueCapacity});
+            if(!Source->mQueue.empty())
+                Context->throw_error(AL_INVALID_OPERATION,
+                    "Setting buffer queue capacity on source {} with queued buffers",
+                    Source->id);
+
+            Source->mQueue.setCapacity(static_cast<size_t>(values[0]));
+            return;
+        }
+        break;
 
     case AL_SEC_OFFSET:
     case AL_SAMPLE_OFFSET:
@@ -1931,6 +1988,20 @@ NOINLINE void SetProperty(ALsource *const Source, ALCcontext *const Context, con
         }
         break;
 
+    case AL_LOW_ORDER_PANNING_SOFT:
+        if constexpr(std::is_integral_v<T>)
+        {
+            CheckSize(1);
+            if(auto mode = LowOrderModeFromEnum(values[0]))
+            {
+                Source->mLowOrder = *mode;
+                return UpdateSourceProps(Source, Context);
+            }
+            Context->throw_error(AL_INVALID_VALUE, "Invalid source low-order panning mode: {}",
+                values[0]);
+        }
+        break;
+
     case AL_STEREO_MODE_SOFT:
         if constexpr(std::is_integral_v<T>)
         {
@@ -2348,10 +2419,8 @@ NOINLINE void GetProperty(ALsource *const Source, ALCcontext *const Context, con
             else if(Voice *voice{GetSourceVoice(Source, Context)})
             {
                 VoiceBufferItem *Current{voice->mCurrentBuffer.load(std::memory_order_relaxed)};
-                const auto iter = std::find_if(Source->mQueue.cbegin(), Source->mQueue.cend(),
-                    [Current](const ALbufferQueueItem &item) noexcept -> bool
-                    { return &item == Current; });
-                BufferList = (iter != Source->mQueue.cend()) ? al::to_address(iter) : nullptr;
+                const size_t idx{Source->mQueue.indexOf(Current)};
+                BufferList = (idx < Source->mQueue.size()) ? &Source->mQueue[idx] : nullptr;
             }
             ALbuffer *buffer{BufferList ? BufferList->mBuffer : nullptr};
             values[0] = buffer ? static_cast<T>(buffer->id) : T{0};
@@ -2377,6 +2446,15 @@ NOINLINE void GetProperty(ALsource *const Source, ALCcontext *const Context, con
         }
         break;
 
+    case AL_BUFFER_QUEUE_CAPACITY_SOFT:
+        if constexpr(std::is_integral_v<T>)
+        {
+            CheckSize(1);
+            values[0] = static_cast<T>(Source->mQueue.capacity());
+            return;
+        }
+        break;
+
     case AL_BUFFERS_PROCESSED:
         if constexpr(std::is_integral_v<T>)
         {
@@ -2390,20 +2468,15 @@ NOINLINE void GetProperty(ALsource *const Source, ALCcontext *const Context, con
             }
             else
             {
-                int played{0};
+                size_t played{0};
                 if(Source->state != AL_INITIAL)
                 {
                     const VoiceBufferItem *Current{nullptr};
                     if(Voice *voice{GetSourceVoice(Source, Context)})
                         Current = voice->mCurrentBuffer.load(std::memory_order_relaxed);
-                    for(auto &item : Source->mQueue)
-                    {
-                        if(&item == Current)
-                            break;
-                        ++played;
-                    }
+                    played = Source->mQueue.indexOf(Current);
                 }
-                values[0] = played;
+                values[0] = static_cast<T>(played);
             }
             return;
         }
@@ -2481,6 +2554,15 @@ NOINLINE void GetProperty(ALsource *const Source, ALCcontext *const Context, con
         }
         break;
 
+    case AL_LOW_ORDER_PANNING_SOFT:
+        if constexpr(std::is_integral_v<T>)
+        {
+            CheckSize(1);
+            values[0] = EnumFromLowOrderMode(Source->mLowOrder);
+            return;
+        }
+        break;
+
     case AL_STEREO_MODE_SOFT:
         if constexpr(std::is_integral_v<T>)
         {
@@ -2536,11 +2618,11 @@ void StartSources(ALCcontext *const context, const al::span<ALsource*> srchandle
     if(srchandles.size() != free_voices) UNLIKELY
     {
         const size_t inc_amount{srchandles.size() - free_voices};
-        auto &allvoices = *context->mVoices.load(std::memory_order_relaxed);
-        if(inc_amount > allvoices.size() - voicelist.size())
+        const size_t capacity{context->getVoiceCapacity()};
+        if(inc_amount > capacity - voicelist.size())
         {
             /* Increase the number of voices to handle the request. */
-            context->allocVoices(inc_amount - (allvoices.size() - voicelist.size()));
+            context->allocVoices(inc_amount - (capacity - voicelist.size()));
         }
         context->mActiveVoiceCount.fetch_add(inc_amount, std::memory_order_release);
         voicelist = context->getVoicesSpan();
@@ -2637,6 +2719,8 @@ void StartSources(ALCcontext *const context, const al::span<ALsource*> srchandle
         voice->mPositionFrac.store(0, std::memory_order_relaxed);
         voice->mCurrentBuffer.store(&source->mQueue.front(), std::memory_order_relaxed);
         voice->mStartTime = start_time;
+        voice->mStopTime = nanoseconds::max();
+        voice->mGainRamp = VoiceGainRamp{};
         voice->mFlags.reset();
         /* A source that's not playing or paused has any offset applied when it
          * starts playing.
@@ -2669,8 +2753,333 @@ void StartSources(ALCcontext *const context, const al::span<ALsource*> srchandle
         SendVoiceChanges(context, tail);
 }
 
+void PauseSources(ALCcontext *const context, const al::span<ALsource*> srchandles)
+{
+    /* Pausing has to be done in two steps. First, for each source that's
+     * detected to be playing, chamge the voice (asynchronously) to
+     * stopping/paused.
+     */
+    VoiceChange *tail{}, *cur{};
+    for(ALsource *source : srchandles)
+    {
+        Voice *voice{GetSourceVoice(source, context)};
+        if(GetSourceState(source, voice) == AL_PLAYING)
+        {
+            if(!cur)
+                cur = tail = GetVoiceChanger(context);
+            else
+            {
+                cur->mNext.store(GetVoiceChanger(context), std::memory_order_relaxed);
+                cur = cur->mNext.load(std::memory_order_relaxed);
+            }
+            cur->mVoice = voice;
+            cur->mSourceID = source->id;
+            cur->mState = VChangeState::Pause;
+        }
+    }
+    if(tail) LIKELY
+    {
+        SendVoiceChanges(context, tail);
+        /* Second, now that the voice changes have been sent, because it's
+         * possible that the voice stopped after it was detected playing and
+         * before the voice got paused, recheck that the source is still
+         * considered playing and set it to paused if so.
+         */
+        for(ALsource *source : srchandles)
+        {
+            Voice *voice{GetSourceVoice(source, context)};
+            if(GetSourceState(source, voice) == AL_PLAYING)
+                source->state = AL_PAUSED;
+        }
+    }
+}
+
+void StopSources(ALCcontext *const context, const al::span<ALsource*> srchandles)
+{
+    VoiceChange *tail{}, *cur{};
+    for(ALsource *source : srchandles)
+    {
+        if(Voice *voice{GetSourceVoice(source, context)})
+        {
+            if(!cur)
+                cur = tail = GetVoiceChanger(context);
+            else
+            {
+                cur->mNext.store(GetVoiceChanger(context), std::memory_order_relaxed);
+                cur = cur->mNext.load(std::memory_order_relaxed);
+            }
+            voice->mPendingChange.store(true, std::memory_order_relaxed);
+            cur->mVoice = voice;
+            cur->mSourceID = source->id;
+            cur->mState = VChangeState::Stop;
+            source->state = AL_STOPPED;
+        }
+        source->Offset = 0.0;
+        source->OffsetType = AL_NONE;
+        source->VoiceIdx = InvalidVoiceIndex;
+    }
+    if(tail) LIKELY
+        SendVoiceChanges(context, tail);
+}
+
+/* Applies the queued source commands. Must be called with the source lock
+ * held. Consecutive commands of the same type are applied together, so they
+ * share a voice change list for the mixer.
+ */
+void ApplySourceCommands(ALCcontext *const context)
+{
+    std::array<ALsource*,64> batch{};
+    size_t count{0};
+    auto cmdtype = SourceCommandType::Play;
+
+    auto flush_batch = [context,&batch,&count,&cmdtype]
+    {
+        const auto srchandles = al::span{batch}.first(count);
+        count = 0;
+        switch(cmdtype)
+        {
+        case SourceCommandType::Play: StartSources(context, srchandles); break;
+        case SourceCommandType::Pause: PauseSources(context, srchandles); break;
+        case SourceCommandType::Stop: StopSources(context, srchandles); break;
+        }
+    };
+
+    while(auto cmd = context->mSourceCommands.pop())
+    {
+        /* The IDs are checked here instead of when queued, to avoid taking
+         * the source lock then. This may be on another thread, so flag the
+         * error for the app's next alGetError call on any thread.
+         */
+        ALsource *source{LookupSource(context, cmd->mSourceID)};
+        if(!source) UNLIKELY
+        {
+            WARN("Invalid source ID {} in queued command", cmd->mSourceID);
+            context->mSourceCommandInvalid.store(true, std::memory_order_release);
+            continue;
+        }
+
+        if(count > 0 && (cmd->mType != cmdtype || count == batch.size()))
+            flush_batch();
+        cmdtype = cmd->mType;
+        batch[count++] = source;
+    }
+    if(count > 0)
+        flush_batch();
+}
+
+/* Queues the given command for each source, for the event thread to apply.
+ * Only if the queue fills up are the pending commands applied here.
+ */
+void QueueSourceCommands(ALCcontext *const context, const al::span<const ALuint> sids,
+    const SourceCommandType type)
+{
+    for(const ALuint sid : sids)
+    {
+        while(!context->mSourceCommands.push(SourceCommand{sid, type})) UNLIKELY
+        {
+            std::lock_guard<std::mutex> sourcelock{context->mSourceLock};
+            ApplySourceCommands(context);
+        }
+    }
+    if(!context->mSourceCommandsPending.exchange(true, std::memory_order_acq_rel))
+        context->mEventSem.post();
+}
+
+/* Sends a scheduled stop or gain ramp to the voices of the given sources.
+ * Sources that aren't playing or paused have no voice and are skipped. Must
+ * be called with the source lock held.
+ */
+void ScheduleSourceChanges(ALCcontext *const context, const al::span<ALsource*> srchandles,
+    const VChangeState state, const nanoseconds time, const nanoseconds duration,
+    const float gain)
+{
+    VoiceChange *tail{}, *cur{};
+    for(ALsource *source : srchandles)
+    {
+        Voice *voice{GetSourceVoice(source, context)};
+        if(!voice) continue;
+
+        if(!cur)
+            cur = tail = GetVoiceChanger(context);
+        else
+        {
+            cur->mNext.store(GetVoiceChanger(context), std::memory_order_relaxed);
+            cur = cur->mNext.load(std::memory_order_relaxed);
+        }
+        /* Keep the voice from being reused until the mixer sees the change,
+         * so it can't apply to a new play of the same source.
+         */
+        voice->mPendingChange.store(true, std::memory_order_relaxed);
+        cur->mVoice = voice;
+        cur->mSourceID = source->id;
+        cur->mState = state;
+        cur->mTime = time;
+        cur->mDuration = duration;
+        cur->mGain = gain;
+    }
+    if(tail) LIKELY
+        SendVoiceChanges(context, tail);
+}
+
+/* The most finished one-shot sources kept for reuse. Any more are deleted,
+ * so an occasional burst of one-shot sounds doesn't keep holding sources.
+ */
+constexpr size_t MaxIdleOneShots{16};
+
+/* Looks up a source of the one-shot pool, which may have been deleted. */
+ALsource *LookupOneShotSource(ALCcontext *const context, const ALuint id) noexcept
+{
+    ALsource *source{LookupSource(context, id)};
+    return (source && source->mOneShot) ? source : nullptr;
+}
+
+/* Deletes a source of the one-shot pool. Must be called with the source lock
+ * held.
+ */
+void FreeOneShotSource(ALCcontext *const context, ALsource *const source)
+{
+    auto iter = std::find(context->mOneShotSources.begin(), context->mOneShotSources.end(),
+        source->id);
+    if(iter != context->mOneShotSources.end())
+    {
+        *iter = context->mOneShotSources.back();
+        context->mOneShotSources.pop_back();
+    }
+    context->mNumOneShotSources.store(context->mOneShotSources.size(),
+        std::memory_order_relaxed);
+    FreeSource(context, source);
+}
+
+/* Moves the one-shot sources the mixer reported as finished to the free list,
+ * releasing their buffers, or deletes them if enough are already free. Must be
+ * called with the source lock held.
+ */
+void CollectOneShotSources(ALCcontext *const context)
+{
+    RingBuffer *ring{context->mOneShotsDone.get()};
+    if(!ring) return;
+
+    static constexpr ALint nobuffer{0};
+    ALuint id{};
+    while(ring->read(&id, 1) > 0)
+    {
+        ALsource *source{LookupOneShotSource(context, id)};
+        if(!source) continue;
+
+        const ALenum state{GetSourceState(source, GetSourceVoice(source, context))};
+        if(state == AL_PLAYING || state == AL_PAUSED)
+            continue;
+        if(context->mFreeOneShots.size() >= MaxIdleOneShots)
+        {
+            FreeOneShotSource(context, source);
+            continue;
+        }
+        SetProperty<ALint>(source, context, srcBuffer, {&nobuffer, 1u});
+        context->mFreeOneShots.emplace_back(id);
+    }
+}
+
+/* Deletes the finished one-shot sources, to make room for the app's sources.
+ * Must be called with the source lock held.
+ */
+void FreeIdleOneShotSources(ALCcontext *const context)
+{
+    if(RingBuffer *ring{context->mOneShotsDone.get()})
+    {
+        ALuint id{};
+        while(ring->read(&id, 1) > 0)
+            context->mFreeOneShots.emplace_back(id);
+    }
+
+    for(const ALuint id : context->mFreeOneShots)
+    {
+        ALsource *source{LookupOneShotSource(context, id)};
+        if(!source) continue;
+
+        const ALenum state{GetSourceState(source, GetSourceVoice(source, context))};
+        if(state != AL_PLAYING && state != AL_PAUSED)
+            FreeOneShotSource(context, source);
+    }
+    context->mFreeOneShots.clear();
+}
+
+/* Gets an unused one-shot source, reusing a finished one if possible. Must be
+ * called with the source lock held.
+ */
+ALsource *GetOneShotSource(ALCcontext *const context)
+{
+    auto is_stopped = [context](ALsource *source) -> bool
+    {
+        const ALenum state{GetSourceState(source, GetSourceVoice(source, context))};
+        return state != AL_PLAYING && state != AL_PAUSED;
+    };
+
+    CollectOneShotSources(context);
+    while(!context->mFreeOneShots.empty())
+    {
+        ALsource *source{LookupOneShotSource(context, context->mFreeOneShots.back())};
+        context->mFreeOneShots.pop_back();
+        if(source && is_stopped(source))
+            return source;
+    }
+
+    auto *device = context->mALDevice.get();
+    if(context->mNumSources < device->SourcesMax)
+    {
+        if(!context->mOneShotsDone)
+            context->mOneShotsDone = RingBuffer::Create(device->SourcesMax, sizeof(ALuint),
+                false);
+        context->mOneShotSources.reserve(context->mOneShotSources.size()+1);
+        if(!EnsureSources(context, 1))
+            context->throw_error(AL_OUT_OF_MEMORY, "Failed to allocate a one-shot source");
+
+        ALsource *source{AllocSource(context)};
+        source->mOneShot = true;
+        context->mOneShotSources.emplace_back(source->id);
+        context->mNumOneShotSources.store(context->mOneShotSources.size(),
+            std::memory_order_relaxed);
+        return source;
+    }
+
+    /* At the source limit, check for one-shots that stopped without being
+     * reported back (e.g. from the device disconnecting).
+     */
+    for(const ALuint id : context->mOneShotSources)
+    {
+        ALsource *source{LookupOneShotSource(context, id)};
+        if(source && is_stopped(source))
+            return source;
+    }
+    context->throw_error(AL_OUT_OF_MEMORY, "Exceeding {} source limit for one-shot sounds",
+        device->SourcesMax);
+}
+
 } // namespace
 
+void ProcessSourceCommands(ALCcontext *context)
+{
+    std::lock_guard<std::mutex> sourcelock{context->mSourceLock};
+    ApplySourceCommands(context);
+}
+
+void ReclaimOneShotSources(ALCcontext *context)
+{
+    if(context->mNumOneShotSources.load(std::memory_order_relaxed) == 0)
+        return;
+
+    std::lock_guard<std::mutex> proplock{context->mPropLock};
+    std::lock_guard<std::mutex> sourcelock{context->mSourceLock};
+    CollectOneShotSources(context);
+}
+
+void ReserveSourceVoices(ALCcontext *context)
+{
+    std::lock_guard<std::mutex> sourcelock{context->mSourceLock};
+    const size_t capacity{context->getVoiceCapacity()};
+    if(context->mNumSources > capacity)
+        context->allocVoices(context->mNumSources - capacity);
+}
+
 AL_API DECL_FUNC2(void, alGenSources, ALsizei,n, ALuint*,sources)
 FORCE_ALIGN void AL_APIENTRY alGenSourcesDirect(ALCcontext *context, ALsizei n, ALuint *sources) noexcept
 try {
@@ -2682,8 +3091,15 @@ try {
     auto *device = context->mALDevice.get();
 
     const al::span sids{sources, static_cast<ALuint>(n)};
-    if(context->mNumSources > device->SourcesMax
-        || sids.size() > device->SourcesMax-context->mNumSources)
+    auto at_limit = [context,device,&sids]() noexcept -> bool
+    {
+        return context->mNumSources > device->SourcesMax
+            || sids.size() > device->SourcesMax-context->mNumSources;
+    };
+    /* Finished one-shot sounds don't hold on to sources the app needs. */
+    if(at_limit())
+        FreeIdleOneShotSources(context);
+    if(at_limit())
         context->throw_error(AL_OUT_OF_MEMORY, "Exceeding {} source limit ({} + {})",
             device->SourcesMax, context->mNumSources, n);
     if(!EnsureSources(context, sids.size()))
@@ -2707,10 +3123,19 @@ try {
     if(n <= 0) UNLIKELY return;
 
     std::lock_guard<std::mutex> srclock{context->mSourceLock};
+    /* Apply any queued commands first, so they don't apply to a new source
+     * reusing a deleted ID.
+     */
+    ApplySourceCommands(context);
 
-    /* Check that all Sources are valid */
+    /* Check that all Sources are valid. One-shot sources can't be deleted by
+     * the app.
+     */
     auto validate_source = [context](const ALuint sid) -> bool
-    { return LookupSource(context, sid) != nullptr; };
+    {
+        const ALsource *source{LookupSource(context, sid)};
+        return source != nullptr && !source->mOneShot;
+    };
 
     const al::span sids{sources, static_cast<ALuint>(n)};
     auto invsrc = std::find_if_not(sids.begin(), sids.end(), validate_source);
@@ -2735,7 +3160,7 @@ AL_API DECL_FUNC1(ALboolean, alIsSource, ALuint,source)
 FORCE_ALIGN ALboolean AL_APIENTRY alIsSourceDirect(ALCcontext *context, ALuint source) noexcept
 {
     std::lock_guard<std::mutex> srclock{context->mSourceLock};
-    if(LookupSource(context, source) != nullptr)
+    if(const ALsource *src{LookupSource(context, source)}; src && !src->mOneShot)
         return AL_TRUE;
     return AL_FALSE;
 }
@@ -2800,6 +3225,159 @@ catch(std::exception &e) {
 }
 
 
+AL_API DECL_FUNCEXT2(void, alSourcePropsv,SOFT, ALsizei,count, const ALsourcePropsSOFT*,props)
+FORCE_ALIGN void AL_APIENTRY alSourcePropsvDirectSOFT(ALCcontext *context, ALsizei count,
+    const ALsourcePropsSOFT *props) noexcept
+try {
+    if(count < 0)
+        context->throw_error(AL_INVALID_VALUE, "Setting properties of {} sources", count);
+    if(count <= 0) UNLIKELY return;
+    if(!props)
+        context->throw_error(AL_INVALID_VALUE, "NULL pointer");
+
+    static constexpr ALbitfieldSOFT AllPropBits{AL_SOURCE_PROPS_POSITION_BIT_SOFT
+        | AL_SOURCE_PROPS_VELOCITY_BIT_SOFT | AL_SOURCE_PROPS_DIRECTION_BIT_SOFT
+        | AL_SOURCE_PROPS_GAIN_BIT_SOFT | AL_SOURCE_PROPS_PITCH_BIT_SOFT};
+
+    const auto propspan = al::span{props, static_cast<ALuint>(count)};
+    source_store_variant source_store;
+    const auto srchandles = [&source_store](size_t num) -> al::span<ALsource*>
+    {
+        if(num > std::tuple_size_v<source_store_array>)
+            return al::span{source_store.emplace<source_store_vector>(num)};
+        return al::span{source_store.emplace<source_store_array>()}.first(num);
+    }(propspan.size());
+
+    std::lock_guard<std::mutex> proplock{context->mPropLock};
+    std::lock_guard<std::mutex> sourcelock{context->mSourceLock};
+
+    /* Check all the sources and values first, so an error leaves every source
+     * unchanged.
+     */
+    auto check_props = [context](const ALsourcePropsSOFT &prop) -> ALsource*
+    {
+        ALsource *source{LookupSource(context, prop.source)};
+        if(!source)
+            context->throw_error(AL_INVALID_NAME, "Invalid source ID {}", prop.source);
+        if((prop.flags&~AllPropBits) != 0)
+            context->throw_error(AL_INVALID_VALUE, "Invalid source property flags {:#x}",
+                prop.flags);
+
+        auto is_finite = [](const al::span<const ALfloat,3> vec) noexcept -> bool
+        { return std::all_of(vec.begin(), vec.end(), [](float f) { return std::isfinite(f); }); };
+        if((prop.flags&AL_SOURCE_PROPS_POSITION_BIT_SOFT) && !is_finite(prop.position))
+            context->throw_error(AL_INVALID_VALUE, "Source {} position out of range",
+                prop.source);
+        if((prop.flags&AL_SOURCE_PROPS_VELOCITY_BIT_SOFT) && !is_finite(prop.velocity))
+            context->throw_error(AL_INVALID_VALUE, "Source {} velocity out of range",
+                prop.source);
+        if((prop.flags&AL_SOURCE_PROPS_DIRECTION_BIT_SOFT) && !is_finite(prop.direction))
+            context->throw_error(AL_INVALID_VALUE, "Source {} direction out of range",
+                prop.source);
+        if((prop.flags&AL_SOURCE_PROPS_GAIN_BIT_SOFT)
+            && !(prop.gain >= 0.0f && std::isfinite(prop.gain)))
+            context->throw_error(AL_INVALID_VALUE, "Source {} gain out of range", prop.source);
+        if((prop.flags&AL_SOURCE_PROPS_PITCH_BIT_SOFT)
+            && !(prop.pitch >= 0.0f && std::isfinite(prop.pitch)))
+            context->throw_error(AL_INVALID_VALUE, "Source {} pitch out of range", prop.source);
+        return source;
+    };
+    std::transform(propspan.begin(), propspan.end(), srchandles.begin(), check_props);
+
+    for(size_t i{0};i < propspan.size();++i)
+    {
+        const ALsourcePropsSOFT &prop = propspan[i];
+        ALsource *source{srchandles[i]};
+        if((prop.flags&AL_SOURCE_PROPS_POSITION_BIT_SOFT))
+            std::copy_n(std::cbegin(prop.position), 3, source->Position.begin());
+        if((prop.flags&AL_SOURCE_PROPS_VELOCITY_BIT_SOFT))
+            std::copy_n(std::cbegin(prop.velocity), 3, source->Velocity.begin());
+        if((prop.flags&AL_SOURCE_PROPS_DIRECTION_BIT_SOFT))
+            std::copy_n(std::cbegin(prop.direction), 3, source->Direction.begin());
+        if((prop.flags&AL_SOURCE_PROPS_GAIN_BIT_SOFT))
+            source->Gain = prop.gain;
+        if((prop.flags&AL_SOURCE_PROPS_PITCH_BIT_SOFT))
+            source->Pitch = prop.pitch;
+    }
+
+    if(context->mDeferUpdates)
+    {
+        std::for_each(srchandles.begin(), srchandles.end(),
+            [](ALsource *source) noexcept { source->mPropsDirty = true; });
+        return;
+    }
+
+    /* Hold the mixer's updates while providing the new properties, so they all
+     * get applied together in the same update. Make sure they're released
+     * even if providing them fails.
+     */
+    struct UpdateHolder {
+        ALCcontext *const mContext;
+        ~UpdateHolder() { mContext->mHoldUpdates.store(false, std::memory_order_release); }
+    };
+    context->mHoldUpdates.store(true, std::memory_order_release);
+    const UpdateHolder holder{context};
+    while((context->mUpdateCount.load(std::memory_order_acquire)&1) != 0) {
+        /* busy-wait */
+    }
+
+    for(ALsource *source : srchandles)
+    {
+#if ALSOFT_EAX
+        if(context->hasEax())
+            source->eaxCommit();
+#endif
+        if(Voice *voice{GetSourceVoice(source, context)})
+            UpdateSourceProps(source, voice, context);
+        else
+            source->mPropsDirty = true;
+    }
+}
+catch(al::base_exception&) {
+}
+catch(std::exception &e) {
+    ERR("Caught exception: {}", e.what());
+}
+
+AL_API DECL_FUNCEXT2(void, alPlayBufferOneShot,SOFT, ALuint,buffer, const ALoneShotPropsSOFT*,props)
+FORCE_ALIGN void AL_APIENTRY alPlayBufferOneShotDirectSOFT(ALCcontext *context, ALuint buffer,
+    const ALoneShotPropsSOFT *props) noexcept
+try {
+    if(!buffer)
+        context->throw_error(AL_INVALID_VALUE, "Playing a one-shot sound without a buffer");
+
+    static constexpr ALoneShotPropsSOFT DefaultProps{1.0f, 1.0f, {0.0f, 0.0f, 0.0f}, AL_FALSE,
+        0u};
+    const ALoneShotPropsSOFT &oneshot = props ? *props : DefaultProps;
+
+    std::lock_guard<std::mutex> proplock{context->mPropLock};
+    std::lock_guard<std::mutex> sourcelock{context->mSourceLock};
+    ALsource *source{GetOneShotSource(context)};
+    try {
+        const auto bufid = static_cast<ALint>(buffer);
+        SetProperty<ALint>(source, context, srcBuffer, {&bufid, 1u});
+        SetProperty<ALfloat>(source, context, srcGain, {&oneshot.gain, 1u});
+        SetProperty<ALfloat>(source, context, srcPitch, {&oneshot.pitch, 1u});
+        SetProperty<ALfloat>(source, context, srcPosition, {std::data(oneshot.position), 3u});
+        const ALint relative{oneshot.relative ? AL_TRUE : AL_FALSE};
+        SetProperty<ALint>(source, context, srcSourceRelative, {&relative, 1u});
+        const std::array<ALint,3> send{static_cast<ALint>(oneshot.slot), 0, AL_FILTER_NULL};
+        SetProperty<ALint>(source, context, srcAuxSendFilter, send);
+    }
+    catch(...) {
+        /* Put the source back to be reused if a property was invalid. */
+        context->mFreeOneShots.emplace_back(source->id);
+        throw;
+    }
+
+    StartSources(context, {&source, 1u});
+}
+catch(al::base_exception&) {
+}
+catch(std::exception &e) {
+    ERR("Caught exception: {}", e.what());
+}
+
 AL_API DECL_FUNCEXT3(void, alSourced,SOFT, ALuint,source, ALenum,param, ALdouble,value)
 FORCE_ALIGN void AL_APIENTRY alSourcedDirectSOFT(ALCcontext *context, ALuint source, ALenum param,
     ALdouble value) noexcept
@@ -3231,11 +3809,18 @@ catch(std::exception &e) {
 AL_API DECL_FUNC1(void, alSourcePlay, ALuint,source)
 FORCE_ALIGN void AL_APIENTRY alSourcePlayDirect(ALCcontext *context, ALuint source) noexcept
 try {
+    if(context->mAsyncSourceCommands.load(std::memory_order_acquire))
+    {
+        QueueSourceCommands(context, {&source, 1}, SourceCommandType::Play);
+        return;
+    }
+
     std::lock_guard<std::mutex> sourcelock{context->mSourceLock};
     ALsource *Source{LookupSource(context, source)};
     if(!Source)
         context->throw_error(AL_INVALID_NAME, "Invalid source ID {}", source);
 
+    ApplySourceCommands(context);
     StartSources(context, {&Source, 1});
 }
 catch(al::base_exception&) {
@@ -3256,6 +3841,7 @@ try {
     if(!Source)
         context->throw_error(AL_INVALID_NAME, "Invalid source ID {}", source);
 
+    ApplySourceCommands(context);
     StartSources(context, {&Source, 1}, nanoseconds{start_time});
 }
 catch(al::base_exception&) {
@@ -3273,6 +3859,12 @@ try {
     if(n <= 0) UNLIKELY return;
 
     al::span sids{sources, static_cast<ALuint>(n)};
+    if(context->mAsyncSourceCommands.load(std::memory_order_acquire))
+    {
+        QueueSourceCommands(context, sids, SourceCommandType::Play);
+        return;
+    }
+
     source_store_variant source_store;
     const auto srchandles = [&source_store](size_t count) -> al::span<ALsource*>
     {
@@ -3327,6 +3919,8 @@ try {
     };
     std::transform(sids.cbegin(), sids.cend(), srchandles.begin(), lookup_src);
 
+    /* Apply any queued commands first, so they aren't reordered with this. */
+    ApplySourceCommands(context);
     StartSources(context, srchandles, nanoseconds{start_time});
 }
 catch(al::base_exception&) {
@@ -3349,6 +3943,12 @@ try {
     if(n <= 0) UNLIKELY return;
 
     al::span sids{sources, static_cast<ALuint>(n)};
+    if(context->mAsyncSourceCommands.load(std::memory_order_acquire))
+    {
+        QueueSourceCommands(context, sids, SourceCommandType::Pause);
+        return;
+    }
+
     source_store_variant source_store;
     const auto srchandles = [&source_store](size_t count) -> al::span<ALsource*>
     {
@@ -3366,43 +3966,7 @@ try {
     };
     std::transform(sids.cbegin(), sids.cend(), srchandles.begin(), lookup_src);
 
-    /* Pausing has to be done in two steps. First, for each source that's
-     * detected to be playing, chamge the voice (asynchronously) to
-     * stopping/paused.
-     */
-    VoiceChange *tail{}, *cur{};
-    for(ALsource *source : srchandles)
-    {
-        Voice *voice{GetSourceVoice(source, context)};
-        if(GetSourceState(source, voice) == AL_PLAYING)
-        {
-            if(!cur)
-                cur = tail = GetVoiceChanger(context);
-            else
-            {
-                cur->mNext.store(GetVoiceChanger(context), std::memory_order_relaxed);
-                cur = cur->mNext.load(std::memory_order_relaxed);
-            }
-            cur->mVoice = voice;
-            cur->mSourceID = source->id;
-            cur->mState = VChangeState::Pause;
-        }
-    }
-    if(tail) LIKELY
-    {
-        SendVoiceChanges(context, tail);
-        /* Second, now that the voice changes have been sent, because it's
-         * possible that the voice stopped after it was detected playing and
-         * before the voice got paused, recheck that the source is still
-         * considered playing and set it to paused if so.
-         */
-        for(ALsource *source : srchandles)
-        {
-            Voice *voice{GetSourceVoice(source, context)};
-            if(GetSourceState(source, voice) == AL_PLAYING)
-                source->state = AL_PAUSED;
-        }
-    }
+    PauseSources(context, srchandles);
 }
 catch(al::base_exception&) {
 }
@@ -3423,6 +3987,55 @@ try {
         context->throw_error(AL_INVALID_VALUE, "Stopping {} sources", n);
     if(n <= 0) UNLIKELY return;
 
+    al::span sids{sources, static_cast<ALuint>(n)};
+    if(context->mAsyncSourceCommands.load(std::memory_order_acquire))
+    {
+        QueueSourceCommands(context, sids, SourceCommandType::Stop);
+        return;
+    }
+
+    source_store_variant source_store;
+    const auto srchandles = [&source_store](size_t count) -> al::span<ALsource*>
+    {
+        if(count > std::tuple_size_v<source_store_array>)
+            return al::span{source_store.emplace<source_store_vector>(count)};
+        return al::span{source_store.emplace<source_store_array>()}.first(count);
+    }(sids.size());
+
+    std::lock_guard<std::mutex> sourcelock{context->mSourceLock};
+    auto lookup_src = [context](const ALuint sid) -> ALsource*
+    {
+        if(ALsource *src{LookupSource(context, sid)})
+            return src;
+        context->throw_error(AL_INVALID_NAME, "Invalid source ID {}", sid);
+    };
+    std::transform(sids.cbegin(), sids.cend(), srchandles.begin(), lookup_src);
+
+    StopSources(context, srchandles);
+}
+catch(al::base_exception&) {
+}
+catch(std::exception &e) {
+    ERR("Caught exception: {}", e.what());
+}
+
+
+AL_API DECL_FUNCEXT2(void, alSourceStopAtTime,SOFT, ALuint,source, ALint64SOFT,stop_time)
+FORCE_ALIGN void AL_APIENTRY alSourceStopAtTimeDirectSOFT(ALCcontext *context, ALuint source,
+    ALint64SOFT stop_time) noexcept
+{ alSourceStopAtTimevDirectSOFT(context, 1, &source, stop_time); }
+
+AL_API DECL_FUNCEXT3(void, alSourceStopAtTimev,SOFT, ALsizei,n, const ALuint*,sources, ALint64SOFT,stop_time)
+FORCE_ALIGN void AL_APIENTRY alSourceStopAtTimevDirectSOFT(ALCcontext *context, ALsizei n,
+    const ALuint *sources, ALint64SOFT stop_time) noexcept
+try {
+    if(n < 0)
+        context->throw_error(AL_INVALID_VALUE, "Stopping {} sources", n);
+    if(n <= 0) UNLIKELY return;
+
+    if(stop_time < 0)
+        context->throw_error(AL_INVALID_VALUE, "Invalid time point {}", stop_time);
+
     al::span sids{sources, static_cast<ALuint>(n)};
     source_store_variant source_store;
     const auto srchandles = [&source_store](size_t count) -> al::span<ALsource*>
@@ -3441,30 +4054,58 @@ try {
     };
     std::transform(sids.cbegin(), sids.cend(), srchandles.begin(), lookup_src);
 
-    VoiceChange *tail{}, *cur{};
-    for(ALsource *source : srchandles)
+    /* Apply any queued commands first, so a queued play gets a voice to stop. */
+    ApplySourceCommands(context);
+    ScheduleSourceChanges(context, srchandles, VChangeState::StopAt, nanoseconds{stop_time},
+        nanoseconds{}, 0.0f);
+}
+catch(al::base_exception&) {
+}
+catch(std::exception &e) {
+    ERR("Caught exception: {}", e.what());
+}
+
+AL_API DECL_FUNCEXT4(void, alSourceGainRamp,SOFT, ALuint,source, ALfloat,gain, ALint64SOFT,start_time, ALint64SOFT,duration)
+FORCE_ALIGN void AL_APIENTRY alSourceGainRampDirectSOFT(ALCcontext *context, ALuint source,
+    ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) noexcept
+{ alSourceGainRampvDirectSOFT(context, 1, &source, gain, start_time, duration); }
+
+AL_API DECL_FUNCEXT5(void, alSourceGainRampv,SOFT, ALsizei,n, const ALuint*,sources, ALfloat,gain, ALint64SOFT,start_time, ALint64SOFT,duration)
+FORCE_ALIGN void AL_APIENTRY alSourceGainRampvDirectSOFT(ALCcontext *context, ALsizei n,
+    const ALuint *sources, ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) noexcept
+try {
+    if(n < 0)
+        context->throw_error(AL_INVALID_VALUE, "Ramping {} sources", n);
+    if(n <= 0) UNLIKELY return;
+
+    if(!(gain >= 0.0f && std::isfinite(gain)))
+        context->throw_error(AL_INVALID_VALUE, "Ramp gain {} out of range", gain);
+    if(start_time < 0)
+        context->throw_error(AL_INVALID_VALUE, "Invalid time point {}", start_time);
+    if(duration < 0 || duration > std::numeric_limits<ALint64SOFT>::max()-start_time)
+        context->throw_error(AL_INVALID_VALUE, "Invalid ramp duration {}", duration);
+
+    al::span sids{sources, static_cast<ALuint>(n)};
+    source_store_variant source_store;
+    const auto srchandles = [&source_store](size_t count) -> al::span<ALsource*>
     {
-        if(Voice *voice{GetSourceVoice(source, context)})
-        {
-            if(!cur)
-                cur = tail = GetVoiceChanger(context);
-            else
-            {
-                cur->mNext.store(GetVoiceChanger(context), std::memory_order_relaxed);
-                cur = cur->mNext.load(std::memory_order_relaxed);
-            }
-            voice->mPendingChange.store(true, std::memory_order_relaxed);
-            cur->mVoice = voice;
-            cur->mSourceID = source->id;
-            cur->mState = VChangeState::Stop;
-            source->state = AL_STOPPED;
-        }
-        source->Offset = 0.0;
-        source->OffsetType = AL_NONE;
-        source->VoiceIdx = InvalidVoiceIndex;
-    }
-    if(tail) LIKELY
-        SendVoiceChanges(context, tail);
+        if(count > std::tuple_size_v<source_store_array>)
+            return al::span{source_store.emplace<source_store_vector>(count)};
+        return al::span{source_store.emplace<source_store_array>()}.first(count);
+    }(sids.size());
+
+    std::lock_guard<std::mutex> sourcelock{context->mSourceLock};
+    auto lookup_src = [context](const ALuint sid) -> ALsource*
+    {
+        if(ALsource *src{LookupSource(context, sid)})
+            return src;
+        context->throw_error(AL_INVALID_NAME, "Invalid source ID {}", sid);
+    };
+    std::transform(sids.cbegin(), sids.cend(), srchandles.begin(), lookup_src);
+
+    ApplySourceCommands(context);
+    ScheduleSourceChanges(context, srchandles, VChangeState::GainRamp, nanoseconds{start_time},
+        nanoseconds{duration}, gain);
 }
 catch(al::base_exception&) {
 }
@@ -3503,6 +4144,7 @@ try {
     };
     std::transform(sids.cbegin(), sids.cend(), srchandles.begin(), lookup_src);
 
+    ApplySourceCommands(context);
     VoiceChange *tail{}, *cur{};
     for(ALsource *source : srchandles)
     {
@@ -3550,6 +4192,7 @@ try {
     if(!source)
         context->throw_error(AL_INVALID_NAME, "Invalid source ID {}", src);
 
+    ApplySourceCommands(context);
     /* Can't queue on a Static Source */
     if(source->SourceType == AL_STATIC)
         context->throw_error(AL_INVALID_OPERATION, "Queueing onto static source {}", src);
@@ -3590,6 +4233,11 @@ try {
                         "Queueing non-persistently mapped buffer {}", buffer->id);
             }
 
+            if(source->mQueue.full())
+                context->throw_error(AL_INVALID_OPERATION,
+                    "Queueing more than {} buffers on source {}", source->mQueue.capacity(),
+                    source->id);
+
             source->mQueue.emplace_back();
             if(!BufferList)
                 BufferList = &source->mQueue.back();
@@ -3635,13 +4283,12 @@ try {
         /* A buffer failed (invalid ID or format), or there was some other
          * unexpected error, so unlock and release each buffer we had.
          */
-        auto iter = source->mQueue.begin() + ptrdiff_t(NewListStart);
-        for(;iter != source->mQueue.end();++iter)
+        while(source->mQueue.size() > NewListStart)
         {
-            if(ALbuffer *buf{iter->mBuffer})
+            if(ALbuffer *buf{source->mQueue.back().mBuffer})
                 DecrementRef(buf->ref);
+            source->mQueue.pop_back();
         }
-        source->mQueue.resize(NewListStart);
         throw;
     }
     /* All buffers good. */
@@ -3675,6 +4322,7 @@ try {
     if(!source)
         context->throw_error(AL_INVALID_NAME, "Invalid source ID {}", src);
 
+    ApplySourceCommands(context);
     if(source->SourceType != AL_STREAMING)
         context->throw_error(AL_INVALID_VALUE, "Unqueueing from a non-streaming source {}", src);
     if(source->Looping)
@@ -3688,12 +4336,7 @@ try {
         VoiceBufferItem *Current{nullptr};
         if(Voice *voice{GetSourceVoice(source, context)})
             Current = voice->mCurrentBuffer.load(std::memory_order_relaxed);
-        for(auto &item : source->mQueue)
-        {
-            if(&item == Current)
-                break;
-            ++processed;
-        }
+        processed = source->mQueue.indexOf(Current);
     }
     if(processed < bids.size())
         context->throw_error(AL_INVALID_VALUE, "Unqueueing {} buffer{} (only {} processed)",
@@ -3746,6 +4389,71 @@ ALsource::ALsource() noexcept
     }
 }
 
+auto ALbufferQueue::emplace_back() -> ALbufferQueueItem&
+{
+    if(mRing.empty())
+    {
+        auto &item = mList.emplace_back();
+        item.mSequence = mNextSequence++;
+        return item;
+    }
+
+    assert(mCount < mRing.size());
+    auto &item = mRing[(mHead+mCount) % mRing.size()];
+    ++mCount;
+
+    item.mNext.store(nullptr, std::memory_order_relaxed);
+    item.mCallback = nullptr;
+    item.mUserData = nullptr;
+    item.mBlockAlign = 0u;
+    item.mSampleLen = 0u;
+    item.mLoopStart = 0u;
+    item.mLoopEnd = 0u;
+    item.mSamples = {};
+    item.mBuffer = nullptr;
+    item.mSequence = mNextSequence++;
+    return item;
+}
+
+void ALbufferQueue::pop_front() noexcept
+{
+    if(mRing.empty())
+        mList.pop_front();
+    else
+    {
+        mHead = (mHead+1) % mRing.size();
+        --mCount;
+    }
+}
+
+void ALbufferQueue::pop_back() noexcept
+{
+    if(mRing.empty())
+        mList.pop_back();
+    else
+        --mCount;
+}
+
+void ALbufferQueue::clear() noexcept
+{
+    mList.clear();
+    mHead = 0;
+    mCount = 0;
+}
+
+void ALbufferQueue::setCapacity(size_t capacity)
+{
+    assert(empty());
+    if(capacity == mRing.size())
+        return;
+
+    decltype(mList){}.swap(mList);
+    decltype(mRing)(capacity).swap(mRing);
+    mHead = 0;
+    mCount = 0;
+}
+
+
 ALsource::~ALsource()
 {
     for(auto &item : mQueue)
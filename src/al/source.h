@@ -7,9 +7,12 @@
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <iterator>
 #include <limits>
 #include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "AL/al.h"
 #include "AL/alc.h"
@@ -43,10 +46,130 @@ inline constexpr size_t DefaultSendCount{2};
 
 inline constexpr ALuint InvalidVoiceIndex{std::numeric_limits<ALuint>::max()};
 
+inline constexpr ALint MaxBufferQueueCapacity{65536};
+
 inline bool sBufferSubDataCompat{false};
 
 struct ALbufferQueueItem : public VoiceBufferItem {
     ALbuffer *mBuffer{nullptr};
+
+    /* Counts up with each item queued, so an item's place in the queue can be
+     * found relative to the front without searching for it.
+     */
+    size_t mSequence{0u};
+};
+
+/* A source's buffer queue. This is normally a list that grows as needed, but
+ * can be given a fixed capacity to preallocate a ring of items, so queueing
+ * and unqueueing buffers never allocates. Either way, an item doesn't move
+ * while queued since the mixer follows them through their mNext pointers.
+ */
+class ALbufferQueue {
+    std::deque<ALbufferQueueItem> mList;
+
+    std::vector<ALbufferQueueItem> mRing;
+    size_t mHead{0u};
+    size_t mCount{0u};
+
+    size_t mNextSequence{0u};
+
+    template<typename T>
+    class iter_base {
+        using queue_type = std::conditional_t<std::is_const_v<T>,const ALbufferQueue,
+            ALbufferQueue>;
+
+        queue_type *mQueue{nullptr};
+        size_t mIdx{0u};
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iter_base() noexcept = default;
+        iter_base(queue_type *queue, size_t idx) noexcept : mQueue{queue}, mIdx{idx} { }
+
+        auto operator*() const noexcept -> reference { return (*mQueue)[mIdx]; }
+        auto operator->() const noexcept -> pointer { return &(*mQueue)[mIdx]; }
+
+        auto operator++() noexcept -> iter_base& { ++mIdx; return *this; }
+        auto operator--() noexcept -> iter_base& { --mIdx; return *this; }
+        auto operator++(int) noexcept -> iter_base { auto ret = *this; ++mIdx; return ret; }
+        auto operator--(int) noexcept -> iter_base { auto ret = *this; --mIdx; return ret; }
+        auto operator+=(difference_type n) noexcept -> iter_base&
+        { mIdx = static_cast<size_t>(static_cast<difference_type>(mIdx) + n); return *this; }
+        auto operator-=(difference_type n) noexcept -> iter_base&
+        { mIdx = static_cast<size_t>(static_cast<difference_type>(mIdx) - n); return *this; }
+
+        friend auto operator+(iter_base iter, difference_type n) noexcept -> iter_base
+        { return iter += n; }
+        friend auto operator-(iter_base iter, difference_type n) noexcept -> iter_base
+        { return iter -= n; }
+        friend auto operator-(const iter_base &lhs, const iter_base &rhs) noexcept
+            -> difference_type
+        { return static_cast<difference_type>(lhs.mIdx - rhs.mIdx); }
+
+        friend auto operator==(const iter_base &lhs, const iter_base &rhs) noexcept -> bool
+        { return lhs.mIdx == rhs.mIdx; }
+        friend auto operator!=(const iter_base &lhs, const iter_base &rhs) noexcept -> bool
+        { return lhs.mIdx != rhs.mIdx; }
+    };
+
+public:
+    using iterator = iter_base<ALbufferQueueItem>;
+    using const_iterator = iter_base<const ALbufferQueueItem>;
+
+    /** The fixed capacity of the queue, or 0 if it grows as needed. */
+    [[nodiscard]] auto capacity() const noexcept -> size_t { return mRing.size(); }
+    [[nodiscard]] auto size() const noexcept -> size_t
+    { return mRing.empty() ? mList.size() : mCount; }
+    [[nodiscard]] auto empty() const noexcept -> bool { return size() == 0; }
+    [[nodiscard]] auto full() const noexcept -> bool
+    { return !mRing.empty() && mCount == mRing.size(); }
+
+    [[nodiscard]] auto operator[](size_t idx) noexcept -> ALbufferQueueItem&
+    { return mRing.empty() ? mList[idx] : mRing[(mHead+idx) % mRing.size()]; }
+    [[nodiscard]] auto operator[](size_t idx) const noexcept -> const ALbufferQueueItem&
+    { return mRing.empty() ? mList[idx] : mRing[(mHead+idx) % mRing.size()]; }
+
+    [[nodiscard]] auto front() noexcept -> ALbufferQueueItem& { return (*this)[0]; }
+    [[nodiscard]] auto front() const noexcept -> const ALbufferQueueItem& { return (*this)[0]; }
+    [[nodiscard]] auto back() noexcept -> ALbufferQueueItem& { return (*this)[size()-1]; }
+    [[nodiscard]] auto back() const noexcept -> const ALbufferQueueItem&
+    { return (*this)[size()-1]; }
+
+    [[nodiscard]] auto begin() noexcept -> iterator { return iterator{this, 0}; }
+    [[nodiscard]] auto end() noexcept -> iterator { return iterator{this, size()}; }
+    [[nodiscard]] auto begin() const noexcept -> const_iterator
+    { return const_iterator{this, 0}; }
+    [[nodiscard]] auto end() const noexcept -> const_iterator
+    { return const_iterator{this, size()}; }
+    [[nodiscard]] auto cbegin() const noexcept -> const_iterator { return begin(); }
+    [[nodiscard]] auto cend() const noexcept -> const_iterator { return end(); }
+
+    /**
+     * Returns the position of the given item in the queue, or the queue size
+     * for a null item. The item must otherwise be in the queue.
+     */
+    [[nodiscard]] auto indexOf(const VoiceBufferItem *item) const noexcept -> size_t
+    {
+        if(!item) return size();
+        return static_cast<const ALbufferQueueItem*>(item)->mSequence - front().mSequence;
+    }
+
+    /** Adds a cleared item to the end of the queue, which must not be full. */
+    auto emplace_back() -> ALbufferQueueItem&;
+    void pop_front() noexcept;
+    void pop_back() noexcept;
+    void clear() noexcept;
+
+    /**
+     * Sets a fixed capacity for the queue, or 0 to let it grow as needed. The
+     * queue must be empty.
+     */
+    void setCapacity(size_t capacity);
 };
 
 
@@ -87,6 +210,7 @@ struct ALsource {
     Resampler mResampler{ResamplerDefault};
     DirectMode DirectChannels{DirectMode::Off};
     SpatializeMode mSpatialize{SpatializeMode::Auto};
+    LowOrderMode mLowOrder{LowOrderMode::Auto};
     SourceStereo mStereoMode{SourceStereo::Normal};
     bool mPanningEnabled{false};
 
@@ -142,10 +266,13 @@ struct ALsource {
     ALenum state{AL_INITIAL};
 
     /** Source Buffer Queue head. */
-    std::deque<ALbufferQueueItem> mQueue;
+    ALbufferQueue mQueue;
 
     bool mPropsDirty{true};
 
+    /* Set for the internal sources used to play one-shot sounds. */
+    bool mOneShot{false};
+
     /* Index into the context's Voices array. Lazily updated, only checked and
      * reset when looking up the voice.
      */
@@ -1053,6 +1180,15 @@ private:
 
 void UpdateAllSourceProps(ALCcontext *context);
 
+/* Applies the play, pause, and stop commands queued for the context's sources
+ * while AL_ASYNC_SOURCE_COMMANDS_SOFT is enabled.
+ */
+void ProcessSourceCommands(ALCcontext *context);
+/* Releases the buffers of one-shot sounds that finished playing. */
+void ReclaimOneShotSources(ALCcontext *context);
+/* Allocates enough voices for all of the context's sources to play at once. */
+void ReserveSourceVoices(ALCcontext *context);
+
 struct SourceSubList {
     uint64_t FreeMask{~0_u64};
     gsl::owner<std::array<ALsource,64>*> Sources{nullptr};
@@ -26,6 +26,7 @@
 #include <atomic>
 #include <cmath>
 #include <deque>
+#include <exception>
 #include <mutex>
 #include <optional>
 #include <stdexcept>
@@ -38,6 +39,7 @@
 
 #include "al/debug.h"
 #include "al/listener.h"
+#include "al/source.h"
 #include "alc/alu.h"
 #include "alc/context.h"
 #include "alc/device.h"
@@ -47,6 +49,7 @@
 #include "core/context.h"
 #include "core/logging.h"
 #include "core/mixer/defs.h"
+#include "core/paramcache.h"
 #include "core/voice.h"
 #include "direct_defs.h"
 #include "intrusive_ptr.h"
@@ -160,6 +163,11 @@ enum PropertyValue : ALenum {
     MaxDebugGroupDepthProp = AL_MAX_DEBUG_GROUP_STACK_DEPTH_EXT,
     MaxLabelLengthProp = AL_MAX_LABEL_LENGTH_EXT,
     ContextFlagsProp = AL_CONTEXT_FLAGS_EXT,
+    SkippedVoiceUpdatesProp = AL_SKIPPED_VOICE_UPDATES_SOFT,
+    ResamplerCacheHitsProp = AL_RESAMPLER_CACHE_HITS_SOFT,
+    ResamplerCacheMissesProp = AL_RESAMPLER_CACHE_MISSES_SOFT,
+    FilterCacheHitsProp = AL_FILTER_CACHE_HITS_SOFT,
+    FilterCacheMissesProp = AL_FILTER_CACHE_MISSES_SOFT,
 #if ALSOFT_EAX
     EaxRamSizeProp = AL_EAX_RAM_SIZE,
     EaxRamFreeProp = AL_EAX_RAM_FREE,
@@ -260,6 +268,24 @@ void GetValue(ALCcontext *context, ALenum pname, T *values)
         *values = cast_value(context->mContextFlags.to_ulong());
         return;
 
+    case AL_SKIPPED_VOICE_UPDATES_SOFT:
+        *values = cast_value(context->mSkippedVoiceUpdates.load(std::memory_order_relaxed));
+        return;
+
+    case AL_RESAMPLER_CACHE_HITS_SOFT:
+        *values = cast_value(context->mParamCache->mResamplerHits.load(std::memory_order_relaxed));
+        return;
+    case AL_RESAMPLER_CACHE_MISSES_SOFT:
+        *values = cast_value(
+            context->mParamCache->mResamplerMisses.load(std::memory_order_relaxed));
+        return;
+    case AL_FILTER_CACHE_HITS_SOFT:
+        *values = cast_value(context->mParamCache->mFilterHits.load(std::memory_order_relaxed));
+        return;
+    case AL_FILTER_CACHE_MISSES_SOFT:
+        *values = cast_value(context->mParamCache->mFilterMisses.load(std::memory_order_relaxed));
+        return;
+
 #if ALSOFT_EAX
 #define EAX_ERROR "[alGetInteger] EAX not enabled"
 
@@ -331,6 +357,18 @@ FORCE_ALIGN void AL_APIENTRY alEnableDirect(ALCcontext *context, ALenum capabili
     case AL_STOP_SOURCES_ON_DISCONNECT_SOFT:
         context->setError(AL_INVALID_OPERATION, "Re-enabling AL_STOP_SOURCES_ON_DISCONNECT_SOFT not yet supported");
         return;
+
+    case AL_ASYNC_SOURCE_COMMANDS_SOFT:
+        try {
+            ReserveSourceVoices(context);
+        }
+        catch(std::exception &e) {
+            context->setError(AL_OUT_OF_MEMORY, "Failed to reserve source voices: {}",
+                e.what());
+            return;
+        }
+        context->mAsyncSourceCommands.store(true, std::memory_order_release);
+        return;
     }
     context->setError(AL_INVALID_VALUE, "Invalid enable property {:#04x}",
         as_unsigned(capability));
@@ -356,6 +394,19 @@ FORCE_ALIGN void AL_APIENTRY alDisableDirect(ALCcontext *context, ALenum capabil
     case AL_STOP_SOURCES_ON_DISCONNECT_SOFT:
         context->mStopVoicesOnDisconnect.store(false);
         return;
+
+    case AL_ASYNC_SOURCE_COMMANDS_SOFT:
+        /* Apply any commands still queued, so they aren't reordered with the
+         * commands that come after.
+         */
+        context->mAsyncSourceCommands.store(false, std::memory_order_release);
+        try {
+            ProcessSourceCommands(context);
+        }
+        catch(std::exception &e) {
+            ERR("Caught exception applying source commands: {}", e.what());
+        }
+        return;
     }
     context->setError(AL_INVALID_VALUE, "Invalid disable property {:#04x}",
         as_unsigned(capability));
@@ -371,6 +422,8 @@ FORCE_ALIGN ALboolean AL_APIENTRY alIsEnabledDirect(ALCcontext *context, ALenum
     case AL_DEBUG_OUTPUT_EXT: return context->mDebugEnabled ? AL_TRUE : AL_FALSE;
     case AL_STOP_SOURCES_ON_DISCONNECT_SOFT:
         return context->mStopVoicesOnDisconnect.load() ? AL_TRUE : AL_FALSE;
+    case AL_ASYNC_SOURCE_COMMANDS_SOFT:
+        return context->mAsyncSourceCommands.load() ? AL_TRUE : AL_FALSE;
     }
     context->setError(AL_INVALID_VALUE, "Invalid is enabled property {:#04x}",
         as_unsigned(capability));
@@ -627,6 +680,9 @@ void UpdateContextProps(ALCcontext *context)
     props->OrientUp = listener.OrientUp;
     props->Gain = listener.Gain;
     props->MetersPerUnit = listener.mMetersPerUnit;
+    props->LowOrderDistance = listener.mLowOrderDistance;
+    props->LowOrderGain = listener.mLowOrderGain;
+    props->UpdateTolerance = listener.mUpdateTolerance;
 
     props->AirAbsorptionGainHF = context->mAirAbsorptionGainHF;
     props->DopplerFactor = context->mDopplerFactor;
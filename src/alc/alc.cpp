@@ -97,6 +97,7 @@
 #include "core/uhjfilter.h"
 #include "core/voice.h"
 #include "core/voice_change.h"
+#include "core/workerpool.h"
 #include "device.h"
 #include "effects/base.h"
 #include "export_list.h"
@@ -456,6 +457,12 @@ void alc_initconfig()
 #elif HAVE_SSE
     capfilter |= CPU_CAP_SSE;
 #endif
+#if HAVE_AVX
+    capfilter |= CPU_CAP_AVX;
+#endif
+#if HAVE_AVX2
+    capfilter |= CPU_CAP_AVX2 | CPU_CAP_FMA3;
+#endif
 #if HAVE_NEON
     capfilter |= CPU_CAP_NEON;
 #endif
@@ -488,6 +495,12 @@ void alc_initconfig()
                 capfilter &= ~CPU_CAP_SSE3;
             else if(al::case_compare(entry, "sse4.1"sv) == 0)
                 capfilter &= ~CPU_CAP_SSE4_1;
+            else if(al::case_compare(entry, "avx"sv) == 0)
+                capfilter &= ~CPU_CAP_AVX;
+            else if(al::case_compare(entry, "avx2"sv) == 0)
+                capfilter &= ~CPU_CAP_AVX2;
+            else if(al::case_compare(entry, "fma3"sv) == 0)
+                capfilter &= ~CPU_CAP_FMA3;
             else if(al::case_compare(entry, "neon"sv) == 0)
                 capfilter &= ~CPU_CAP_NEON;
             else
@@ -502,11 +515,14 @@ void alc_initconfig()
             TRACE("Name: \"{}\"", cpuopt->mName);
         }
         const int caps{cpuopt->mCaps};
-        TRACE("Extensions:{}{}{}{}{}{}",
+        TRACE("Extensions:{}{}{}{}{}{}{}{}{}",
             ((capfilter&CPU_CAP_SSE)   ?(caps&CPU_CAP_SSE)   ?" +SSE"sv    : " -SSE"sv    : ""sv),
             ((capfilter&CPU_CAP_SSE2)  ?(caps&CPU_CAP_SSE2)  ?" +SSE2"sv   : " -SSE2"sv   : ""sv),
             ((capfilter&CPU_CAP_SSE3)  ?(caps&CPU_CAP_SSE3)  ?" +SSE3"sv   : " -SSE3"sv   : ""sv),
             ((capfilter&CPU_CAP_SSE4_1)?(caps&CPU_CAP_SSE4_1)?" +SSE4.1"sv : " -SSE4.1"sv : ""sv),
+            ((capfilter&CPU_CAP_AVX)   ?(caps&CPU_CAP_AVX)   ?" +AVX"sv    : " -AVX"sv    : ""sv),
+            ((capfilter&CPU_CAP_AVX2)  ?(caps&CPU_CAP_AVX2)  ?" +AVX2"sv   : " -AVX2"sv   : ""sv),
+            ((capfilter&CPU_CAP_FMA3)  ?(caps&CPU_CAP_FMA3)  ?" +FMA3"sv   : " -FMA3"sv   : ""sv),
             ((capfilter&CPU_CAP_NEON)  ?(caps&CPU_CAP_NEON)  ?" +NEON"sv   : " -NEON"sv   : ""sv),
             (!capfilter) ? " -none-"sv : ""sv);
         CPUCapFlags = caps & capfilter;
@@ -1440,11 +1456,14 @@ auto UpdateDeviceParams(al::Device *device, const al::span<const int> attrList)
     device->Limiter = nullptr;
     device->ChannelDelays = nullptr;
 
-    std::fill(std::begin(device->HrtfAccumData), std::end(device->HrtfAccumData), float2{});
+    std::fill(std::begin(device->mScratch.HrtfAccumData), std::end(device->mScratch.HrtfAccumData),
+        float2{});
 
     device->Dry.AmbiMap.fill(BFChannelConfig{});
     device->Dry.Buffer = {};
     std::fill(std::begin(device->NumChannelsPerOrder), std::end(device->NumChannelsPerOrder), 0u);
+    device->LowOrder.AmbiMap.fill(BFChannelConfig{});
+    device->LowOrder.Buffer = {};
     device->RealOut.RemixMap = {};
     device->RealOut.ChannelIndex.fill(InvalidChannelIndex);
     device->RealOut.Buffer = {};
@@ -1559,6 +1578,56 @@ auto UpdateDeviceParams(al::Device *device, const al::span<const int> attrList)
         }
     }
 
+    /* Set up worker threads for mixing, if requested. An existing pool is
+     * kept for the same request, even if not all of its threads could start.
+     */
+    const auto mixthreads = std::clamp(device->configValue<uint>({}, "mixer-threads"sv)
+        .value_or(1u), 1u, MixerGroupCount);
+    if(mixthreads > 1)
+    {
+        if(!device->mMixerPool || device->mMixerPool->requestedCount() != mixthreads)
+        {
+            device->mMixerPool = nullptr;
+            device->mMixerPool = std::make_unique<WorkerPool>(mixthreads);
+        }
+        TRACE("Mixing with {} threads", device->mMixerPool->threadCount());
+    }
+    else
+        device->mMixerPool = nullptr;
+
+    /* Voices and effects are split between mixing groups when mixing with
+     * worker threads. Without worker threads, the groups may still be used so
+     * the output is identical regardless of the number of threads. This needs
+     * to be set before the renderer is initialized, so the mixing buffers get
+     * allocated for the mixing groups.
+     */
+    const auto groupmixing = device->mMixerPool
+        || device->configValue<bool>({}, "mixer-groups"sv).value_or(false);
+    if(groupmixing)
+    {
+        device->mMixGroupCount = MixerGroupCount;
+        device->mGroupScratch.resize(MixerGroupCount);
+        for(auto &scratch : device->mGroupScratch)
+            std::fill(scratch.HrtfAccumData.begin(), scratch.HrtfAccumData.end(), float2{});
+    }
+    else
+    {
+        device->mMixGroupCount = 0;
+        device->mGroupScratch.clear();
+        device->mGroupScratch.shrink_to_fit();
+    }
+
+    device->mAsyncConvolution = device->configValue<bool>({}, "async-convolution"sv)
+        .value_or(false);
+    device->mMixProfile.reset();
+
+    device->mAdaptiveQuality = device->configValue<bool>({}, "adaptive-quality"sv)
+        .value_or(false);
+    device->mMixQuality = MixQuality::Full;
+    device->mHighLoadSamples = 0;
+    device->mLowLoadSamples = 0;
+    device->mOverrunSamples = 0;
+
     aluInitRenderer(device, hrtf_id, stereomode);
 
     /* Calculate the max number of sources, and split them between the mono and
@@ -1731,6 +1800,8 @@ auto UpdateDeviceParams(al::Device *device, const al::span<const int> attrList)
             {
                 slot.mWetBuffer.clear();
                 slot.mWetBuffer.shrink_to_fit();
+                slot.mOutputBuffer.clear();
+                slot.mOutputBuffer.shrink_to_fit();
                 slot.Wet.Buffer = {};
             };
             std::for_each(clusterptr->begin(), clusterptr->end(), clear_buffer);
@@ -2619,6 +2690,29 @@ ALC_API void ALC_APIENTRY alcGetInteger64vSOFT(ALCdevice *device, ALCenum pname,
         }
         break;
 
+    case ALC_MIXER_PROFILE_SIZE_SOFT:
+        valuespan[0] = MixStageCount*2 + 1;
+        break;
+
+    case ALC_MIXER_PROFILE_SOFT:
+        if(valuespan.size() < MixStageCount*2 + 1)
+            alcSetError(dev.get(), ALC_INVALID_VALUE);
+        else
+        {
+            const auto &profile = dev->mMixProfile;
+            auto dst = valuespan.begin();
+            *(dst++) = static_cast<ALCint64SOFT>(
+                profile.mMixCount.load(std::memory_order_relaxed));
+            for(const auto &stage : profile.mStages)
+            {
+                *(dst++) = static_cast<ALCint64SOFT>(
+                    stage.mTotalNSec.load(std::memory_order_relaxed));
+                *(dst++) = static_cast<ALCint64SOFT>(
+                    stage.mMaxNSec.load(std::memory_order_relaxed));
+            }
+        }
+        break;
+
     default:
         auto ivals = std::vector<int>(valuespan.size());
         if(size_t got{GetIntegerv(dev.get(), pname, ivals)})
@@ -2772,6 +2866,11 @@ ALC_API ALCcontext* ALC_APIENTRY alcCreateContext(ALCdevice *device, const ALCin
             TRACE("volume-adjust gain: {:f}", context->mGainBoost);
         }
     }
+    if(auto voicesopt = dev->configValue<uint>({}, "max-audible-voices"sv))
+    {
+        context->mAudibleVoiceLimit = *voicesopt;
+        TRACE("Max audible voices: {}", context->mAudibleVoiceLimit);
+    }
 
     {
         using ContextArray = al::FlexArray<ContextBase*>;
@@ -3660,6 +3759,9 @@ FORCE_ALIGN ALCenum ALC_APIENTRY alcEventIsSupportedSOFT(ALCenum eventType, ALCe
     switch(deviceType)
     {
     case ALC_PLAYBACK_DEVICE_SOFT:
+        /* Mixer overruns are detected by the mixer, not the backend. */
+        if(*etype == alc::EventType::MixerOverrun)
+            return al::to_underlying(alc::EventSupport::FullSupport);
         if(PlaybackFactory)
             supported = PlaybackFactory->queryEventSupport(*etype, BackendType::Playback);
         return al::to_underlying(supported);
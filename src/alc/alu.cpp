@@ -33,15 +33,24 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <variant>
 
+#if HAVE_SSE_INTRINSICS
+#include <xmmintrin.h>
+#endif
+
 #include "almalloc.h"
 #include "alnumbers.h"
 #include "alnumeric.h"
@@ -72,11 +81,13 @@
 #include "core/mixer.h"
 #include "core/mixer/defs.h"
 #include "core/mixer/hrtfdefs.h"
+#include "core/paramcache.h"
 #include "core/resampler_limits.h"
 #include "core/storage_formats.h"
 #include "core/uhjfilter.h"
 #include "core/voice.h"
 #include "core/voice_change.h"
+#include "core/workerpool.h"
 #include "intrusive_ptr.h"
 #include "opthelpers.h"
 #include "ringbuffer.h"
@@ -93,6 +104,12 @@ struct SSE2Tag;
 #if HAVE_SSE4_1
 struct SSE4Tag;
 #endif
+#if HAVE_AVX
+struct AVXTag;
+#endif
+#if HAVE_AVX2
+struct AVX2Tag;
+#endif
 #if HAVE_NEON
 struct NEONTag;
 #endif
@@ -150,6 +167,14 @@ inline HrtfDirectMixerFunc SelectHrtfMixer()
     if((CPUCapFlags&CPU_CAP_NEON))
         return MixDirectHrtf_<NEONTag>;
 #endif
+#if HAVE_AVX2
+    if((CPUCapFlags&CPU_CAP_AVX2) && (CPUCapFlags&CPU_CAP_FMA3))
+        return MixDirectHrtf_<AVX2Tag>;
+#endif
+#if HAVE_AVX
+    if((CPUCapFlags&CPU_CAP_AVX))
+        return MixDirectHrtf_<AVXTag>;
+#endif
 #if HAVE_SSE
     if((CPUCapFlags&CPU_CAP_SSE))
         return MixDirectHrtf_<SSETag>;
@@ -208,6 +233,14 @@ inline ResamplerFunc SelectResampler(Resampler resampler, uint increment)
         if((CPUCapFlags&CPU_CAP_NEON))
             return Resample_<CubicTag,NEONTag>;
 #endif
+#if HAVE_AVX2
+        if((CPUCapFlags&CPU_CAP_AVX2) && (CPUCapFlags&CPU_CAP_FMA3))
+            return Resample_<CubicTag,AVX2Tag>;
+#endif
+#if HAVE_AVX
+        if((CPUCapFlags&CPU_CAP_AVX))
+            return Resample_<CubicTag,AVXTag>;
+#endif
 #if HAVE_SSE4_1
         if((CPUCapFlags&CPU_CAP_SSE4_1))
             return Resample_<CubicTag,SSE4Tag>;
@@ -229,6 +262,14 @@ inline ResamplerFunc SelectResampler(Resampler resampler, uint increment)
             if((CPUCapFlags&CPU_CAP_NEON))
                 return Resample_<BSincTag,NEONTag>;
 #endif
+#if HAVE_AVX2
+            if((CPUCapFlags&CPU_CAP_AVX2) && (CPUCapFlags&CPU_CAP_FMA3))
+                return Resample_<BSincTag,AVX2Tag>;
+#endif
+#if HAVE_AVX
+            if((CPUCapFlags&CPU_CAP_AVX))
+                return Resample_<BSincTag,AVXTag>;
+#endif
 #if HAVE_SSE
             if((CPUCapFlags&CPU_CAP_SSE))
                 return Resample_<BSincTag,SSETag>;
@@ -242,6 +283,14 @@ inline ResamplerFunc SelectResampler(Resampler resampler, uint increment)
         if((CPUCapFlags&CPU_CAP_NEON))
             return Resample_<FastBSincTag,NEONTag>;
 #endif
+#if HAVE_AVX2
+        if((CPUCapFlags&CPU_CAP_AVX2) && (CPUCapFlags&CPU_CAP_FMA3))
+            return Resample_<FastBSincTag,AVX2Tag>;
+#endif
+#if HAVE_AVX
+        if((CPUCapFlags&CPU_CAP_AVX))
+            return Resample_<FastBSincTag,AVXTag>;
+#endif
 #if HAVE_SSE
         if((CPUCapFlags&CPU_CAP_SSE))
             return Resample_<FastBSincTag,SSETag>;
@@ -297,8 +346,8 @@ void DeviceBase::ProcessHrtf(const size_t SamplesToDo)
     const size_t lidx{RealOut.ChannelIndex[FrontLeft]};
     const size_t ridx{RealOut.ChannelIndex[FrontRight]};
 
-    MixDirectHrtf(RealOut.Buffer[lidx], RealOut.Buffer[ridx], Dry.Buffer, HrtfAccumData,
-        mHrtfState->mTemp, mHrtfState->mChannels, mHrtfState->mIrSize, SamplesToDo);
+    MixDirectHrtf(RealOut.Buffer[lidx], RealOut.Buffer[ridx], Dry.Buffer, mScratch.HrtfAccumData,
+        mHrtfState->mTemp, mHrtfState->mChannels, getMixIrSize(mHrtfState->mIrSize), SamplesToDo);
 }
 
 void DeviceBase::ProcessAmbiDec(const size_t SamplesToDo)
@@ -409,10 +458,33 @@ constexpr auto GetAmbi2DLayout(AmbiLayout layouttype) noexcept
 }
 
 
-bool CalcContextParams(ContextBase *ctx)
+/* What a context update changed, for which voices need to be recalculated. */
+enum class ContextChange : std::uint8_t {
+    None,
+    /* Only the listener position and orientation changed. */
+    ListenerPosition,
+    /* The listener velocity changed, along with any position or orientation
+     * change.
+     */
+    ListenerVelocity,
+    /* Properties that affect every voice changed. */
+    All
+};
+
+ContextChange CalcContextParams(ContextBase *ctx)
 {
     ContextProps *props{ctx->mParams.ContextUpdate.exchange(nullptr, std::memory_order_acq_rel)};
-    if(!props) return false;
+    if(!props) return ContextChange::None;
+
+    /* Keep the old non-listener properties and velocity to see what changed. */
+    auto get_props = [&params=std::as_const(ctx->mParams)]
+    {
+        return std::make_tuple(params.Gain, params.MetersPerUnit, params.AirAbsorptionGainHF,
+            params.LowOrderDistance, params.LowOrderGain, params.DopplerFactor,
+            params.SpeedOfSound, params.SourceDistanceModel, params.mDistanceModel);
+    };
+    const auto oldprops = get_props();
+    const alu::Vector oldvel{ctx->mParams.Velocity};
 
     const alu::Vector pos{props->Position[0], props->Position[1], props->Position[2], 1.0f};
     ctx->mParams.Position = pos;
@@ -443,6 +515,9 @@ bool CalcContextParams(ContextBase *ctx)
 #endif
         ;
     ctx->mParams.AirAbsorptionGainHF = props->AirAbsorptionGainHF;
+    ctx->mParams.LowOrderDistance = props->LowOrderDistance;
+    ctx->mParams.LowOrderGain = props->LowOrderGain;
+    ctx->mParams.UpdateTolerance = props->UpdateTolerance;
 
     ctx->mParams.DopplerFactor = props->DopplerFactor;
     ctx->mParams.SpeedOfSound = props->SpeedOfSound * props->DopplerVelocity
@@ -455,11 +530,41 @@ bool CalcContextParams(ContextBase *ctx)
     ctx->mParams.mDistanceModel = props->mDistanceModel;
 
     AtomicReplaceHead(ctx->mFreeContextProps, props);
-    return true;
+
+    if(get_props() != oldprops)
+        return ContextChange::All;
+    const alu::Vector &newvel = ctx->mParams.Velocity;
+    if(newvel[0] != oldvel[0] || newvel[1] != oldvel[1] || newvel[2] != oldvel[2])
+        return ContextChange::ListenerVelocity;
+    return ContextChange::ListenerPosition;
+}
+
+/* Lowers the given resampler as needed for the mixing quality. */
+Resampler LimitResampler(const Resampler resampler, const MixQuality quality) noexcept
+{
+    if(quality >= MixQuality::LinearResampler)
+        return std::min(resampler, Resampler::Linear);
+    if(quality >= MixQuality::CubicResampler)
+        return std::min(resampler, Resampler::Spline);
+    return resampler;
 }
 
+/* Applies any pending property update for the effect slot, returning true if
+ * the voices sending to it need to be recalculated.
+ */
 bool CalcEffectSlotParams(EffectSlot *slot, EffectSlot **sorted_slots, ContextBase *context)
 {
+    /* When the mixer is lowering its load, leave pending reverb property
+     * changes for when it can afford the reverb's update.
+     */
+    if(context->mDevice->mMixQuality >= MixQuality::DeferReverb) UNLIKELY
+    {
+        const EffectSlotProps *props{slot->Update.load(std::memory_order_acquire)};
+        if(props && slot->EffectType == EffectSlotType::Reverb
+            && props->Type == EffectSlotType::Reverb)
+            return false;
+    }
+
     EffectSlotProps *props{slot->Update.exchange(nullptr, std::memory_order_acq_rel)};
     if(!props) return false;
 
@@ -468,6 +573,19 @@ bool CalcEffectSlotParams(EffectSlot *slot, EffectSlot **sorted_slots, ContextBa
      */
     if(slot->Target != props->Target)
         *sorted_slots = nullptr;
+
+    /* Keep the old values voices use for sending to this slot, to see if any
+     * changed. The slot's gain, target, and effect properties don't affect
+     * the voices.
+     */
+    auto get_send_params = [slot]
+    {
+        return std::make_tuple(slot->EffectType, slot->RoomRolloff, slot->DecayTime,
+            slot->DecayLFRatio, slot->DecayHFRatio, slot->DecayHFLimit,
+            slot->AirAbsorptionGainHF);
+    };
+    const auto oldsendparams = get_send_params();
+
     slot->Gain = props->Gain;
     slot->AuxSendAuto = props->AuxSendAuto;
     slot->Target = props->Target;
@@ -535,7 +653,9 @@ bool CalcEffectSlotParams(EffectSlot *slot, EffectSlot **sorted_slots, ContextBa
         return EffectTarget{&device->Dry, &device->RealOut};
     }();
     state->update(context, slot, &slot->mEffectProps, output);
-    return true;
+
+    slot->mSendParamsChanged = get_send_params() != oldsendparams;
+    return slot->mSendParamsChanged;
 }
 
 
@@ -799,12 +919,144 @@ struct ChanPosMap {
 
 struct GainTriplet { float Base, HF, LF; };
 
+/* Checks if the voice should be panned to the first-order mix. Voices already
+ * using it have to get 10% closer or louder than the thresholds to go back to
+ * full order, so ones hovering around a threshold don't keep switching.
+ */
+bool UseLowOrderPanning(const Voice *voice, const VoiceProps *props,
+    const ContextParams &Context, const float Distance, const float DryGain) noexcept
+{
+    switch(props->mLowOrderMode)
+    {
+    case LowOrderMode::Off: return false;
+    case LowOrderMode::On: return true;
+    case LowOrderMode::Auto: break;
+    }
+    const float hyst{voice->mFlags.test(VoiceIsLowOrder) ? 0.9f : 1.0f};
+    return Distance >= Context.LowOrderDistance*hyst || DryGain*hyst < Context.LowOrderGain;
+}
+
+/* Updates the voice's target gains for new base gains without re-panning it,
+ * by scaling the gains last panned, which are all proportional to their base
+ * gain. Returns false if the voice needs to be re-panned instead, when a send
+ * target changed, an old base gain was 0 so there's nothing to scale, or the
+ * new gain moves the voice between the full- and low-order mixes.
+ */
+bool RescalePanGains(Voice *voice, const float Distance, const GainTriplet &DryGain,
+    const al::span<const GainTriplet,MaxSendCount> WetGain,
+    const al::span<EffectSlot*,MaxSendCount> SendSlots, const VoiceProps *props,
+    const ContextParams &Context, const DeviceBase *Device) noexcept
+{
+    const uint NumSends{Device->NumAuxSends};
+    for(uint i{0};i < NumSends;i++)
+    {
+        const auto target = SendSlots[i] ? SendSlots[i]->Wet.Buffer : al::span<FloatBufferLine>{};
+        if(target.data() != voice->mSend[i].Buffer.data())
+            return false;
+        if(SendSlots[i] && voice->mSend[i].BaseGain == 0.0f && WetGain[i].Base != 0.0f)
+            return false;
+    }
+    if(voice->mDirect.BaseGain == 0.0f && DryGain.Base != 0.0f)
+        return false;
+    if(!voice->mFlags.test(VoiceHasHrtf) && !IsAmbisonic(voice->mFmtChannels)
+        && !Device->LowOrder.Buffer.empty()
+        && UseLowOrderPanning(voice, props, Context, Distance, DryGain.Base)
+            != voice->mFlags.test(VoiceIsLowOrder))
+        return false;
+
+    auto scale_gains = [](const al::span<float> gains, const float scale) noexcept
+    {
+        std::transform(gains.begin(), gains.end(), gains.begin(),
+            [scale](const float gain) noexcept { return gain * scale; });
+    };
+    if(DryGain.Base != voice->mDirect.BaseGain)
+    {
+        const float scale{DryGain.Base / voice->mDirect.BaseGain};
+        for(auto &chandata : voice->mChans)
+        {
+            chandata.mDryParams.Hrtf.Target.Gain *= scale;
+            scale_gains(chandata.mDryParams.Gains.Target, scale);
+        }
+        voice->mDirect.BaseGain = DryGain.Base;
+    }
+    for(uint i{0};i < NumSends;i++)
+    {
+        if(!SendSlots[i] || WetGain[i].Base == voice->mSend[i].BaseGain)
+            continue;
+        const float scale{WetGain[i].Base / voice->mSend[i].BaseGain};
+        for(auto &chandata : voice->mChans)
+            scale_gains(chandata.mWetParams[i].Gains.Target, scale);
+        voice->mSend[i].BaseGain = WetGain[i].Base;
+    }
+    return true;
+}
+
+/* Sets up the voice's direct and send filters. Unless forced, only outputs
+ * whose filter gains or reference frequencies changed are updated.
+ */
+void CalcVoiceFilters(Voice *voice, const GainTriplet &DryGain,
+    const al::span<const GainTriplet,MaxSendCount> WetGain, const VoiceProps *props,
+    const DeviceBase *Device, ParamCache &Cache, const bool force)
+{
+    const auto Frequency = static_cast<float>(Device->Frequency);
+    const size_t num_channels{voice->mChans.size()};
+
+    auto set_filters = [voice,Frequency,num_channels,&Cache,force](Voice::TargetData &target,
+        const GainTriplet &gain, const float hfRef, const float lfRef, auto get_params)
+    {
+        if(!force && target.GainHF == gain.HF && target.HFReference == hfRef
+            && target.GainLF == gain.LF && target.LFReference == lfRef)
+            return;
+        target.GainHF = gain.HF;
+        target.HFReference = hfRef;
+        target.GainLF = gain.LF;
+        target.LFReference = lfRef;
+
+        const float hfNorm{hfRef / Frequency};
+        const float lfNorm{lfRef / Frequency};
+
+        target.FilterType = AF_None;
+        if(gain.HF != 1.0f) target.FilterType |= AF_LowPass;
+        if(gain.LF != 1.0f) target.FilterType |= AF_HighPass;
+
+        auto &lowpass = get_params(voice->mChans[0]).LowPass;
+        auto &highpass = get_params(voice->mChans[0]).HighPass;
+        Cache.setShelfParams(lowpass, BiquadType::HighShelf, hfNorm, gain.HF);
+        Cache.setShelfParams(highpass, BiquadType::LowShelf, lfNorm, gain.LF);
+        for(size_t c{1};c < num_channels;c++)
+        {
+            get_params(voice->mChans[c]).LowPass.copyParamsFrom(lowpass);
+            get_params(voice->mChans[c]).HighPass.copyParamsFrom(highpass);
+        }
+    };
+
+    set_filters(voice->mDirect, DryGain, props->Direct.HFReference, props->Direct.LFReference,
+        [](Voice::ChannelData &chandata) noexcept -> DirectParams&
+        { return chandata.mDryParams; });
+    for(uint i{0};i < Device->NumAuxSends;i++)
+    {
+        set_filters(voice->mSend[i], WetGain[i], props->Send[i].HFReference,
+            props->Send[i].LFReference, [i](Voice::ChannelData &chandata) noexcept -> SendParams&
+            { return chandata.mWetParams[i]; });
+    }
+}
+
 void CalcPanningAndFilters(Voice *voice, const float xpos, const float ypos, const float zpos,
     const float Distance, const float Spread, const GainTriplet &DryGain,
     const al::span<const GainTriplet,MaxSendCount> WetGain,
     const al::span<EffectSlot*,MaxSendCount> SendSlots, const VoiceProps *props,
-    const ContextParams &Context, DeviceBase *Device)
+    const ContextParams &Context, DeviceBase *Device, ParamCache &Cache, const bool repan)
 {
+    /* When the panning inputs didn't change, only the gains and filters need
+     * updating.
+     */
+    if(!repan && RescalePanGains(voice, Distance, DryGain, WetGain, SendSlots, props, Context,
+        Device))
+    {
+        CalcVoiceFilters(voice, DryGain, WetGain, props, Device, Cache, false);
+        return;
+    }
+
     static constexpr std::array MonoMap{
         ChanPosMap{FrontCenter, std::array{0.0f, 0.0f, -1.0f}}
     };
@@ -857,6 +1109,15 @@ void CalcPanningAndFilters(Voice *voice, const float xpos, const float ypos, con
     const size_t num_channels{voice->mChans.size()};
     ASSUME(num_channels > 0);
 
+    voice->mDirect.Buffer = Device->Dry.Buffer;
+    voice->mDirect.BaseGain = DryGain.Base;
+    for(uint i{0};i < NumSends;i++)
+    {
+        voice->mSend[i].Buffer = SendSlots[i] ? SendSlots[i]->Wet.Buffer
+            : al::span<FloatBufferLine>{};
+        voice->mSend[i].BaseGain = WetGain[i].Base;
+    }
+
     for(auto &chandata : voice->mChans)
     {
         chandata.mDryParams.Hrtf.Target = HrtfFilter{};
@@ -1283,7 +1544,13 @@ void CalcPanningAndFilters(Voice *voice, const float xpos, const float ypos, con
     }
     else
     {
-        /* Non-HRTF rendering. Use normal panning to the output. */
+        /* Non-HRTF rendering. Use normal panning to the output, or to the
+         * first-order mix for low-order voices.
+         */
+        const bool loworder{!Device->LowOrder.Buffer.empty()
+            && UseLowOrderPanning(voice, props, Context, Distance, DryGain.Base)};
+        MixParams *DryMix{loworder ? &Device->LowOrder : &Device->Dry};
+        voice->mDirect.Buffer = DryMix->Buffer;
 
         if(Distance > std::numeric_limits<float>::epsilon())
         {
@@ -1314,7 +1581,7 @@ void CalcPanningAndFilters(Voice *voice, const float xpos, const float ypos, con
                 };
                 const auto coeffs = calc_coeffs(Device->mRenderMode);
 
-                ComputePanGains(&Device->Dry, coeffs, DryGain.Base,
+                ComputePanGains(DryMix, coeffs, DryGain.Base,
                     voice->mChans[0].mDryParams.Gains.Target);
                 for(uint i{0};i < NumSends;i++)
                 {
@@ -1330,7 +1597,7 @@ void CalcPanningAndFilters(Voice *voice, const float xpos, const float ypos, con
                 /* Special-case LFE */
                 if(chans[c].channel == LFE)
                 {
-                    if(Device->Dry.Buffer.data() == Device->RealOut.Buffer.data())
+                    if(DryMix->Buffer.data() == Device->RealOut.Buffer.data())
                     {
                         const auto idx = uint{Device->channelIdxByName(chans[c].channel)};
                         if(idx != InvalidChannelIndex)
@@ -1361,7 +1628,7 @@ void CalcPanningAndFilters(Voice *voice, const float xpos, const float ypos, con
                     pos = ScaleAzimuthFront3(pos);
                 const auto coeffs = CalcDirectionCoeffs(pos, 0.0f);
 
-                ComputePanGains(&Device->Dry, coeffs, DryGain.Base * pangain,
+                ComputePanGains(DryMix, coeffs, DryGain.Base * pangain,
                     voice->mChans[c].mDryParams.Gains.Target);
                 for(uint i{0};i < NumSends;i++)
                 {
@@ -1397,7 +1664,7 @@ void CalcPanningAndFilters(Voice *voice, const float xpos, const float ypos, con
                 /* Special-case LFE */
                 if(chans[c].channel == LFE)
                 {
-                    if(Device->Dry.Buffer.data() == Device->RealOut.Buffer.data())
+                    if(DryMix->Buffer.data() == Device->RealOut.Buffer.data())
                     {
                         const uint idx{Device->channelIdxByName(chans[c].channel)};
                         if(idx != InvalidChannelIndex)
@@ -1409,7 +1676,7 @@ void CalcPanningAndFilters(Voice *voice, const float xpos, const float ypos, con
                 const auto coeffs = CalcDirectionCoeffs((Device->mRenderMode==RenderMode::Pairwise)
                     ? ScaleAzimuthFront3(chans[c].pos) : chans[c].pos, spread);
 
-                ComputePanGains(&Device->Dry, coeffs, DryGain.Base * pangain,
+                ComputePanGains(DryMix, coeffs, DryGain.Base * pangain,
                     voice->mChans[c].mDryParams.Gains.Target);
                 for(uint i{0};i < NumSends;i++)
                 {
@@ -1419,63 +1686,32 @@ void CalcPanningAndFilters(Voice *voice, const float xpos, const float ypos, con
                 }
             }
         }
-    }
-
-    {
-        const float hfNorm{props->Direct.HFReference / Frequency};
-        const float lfNorm{props->Direct.LFReference / Frequency};
-
-        voice->mDirect.FilterType = AF_None;
-        if(DryGain.HF != 1.0f) voice->mDirect.FilterType |= AF_LowPass;
-        if(DryGain.LF != 1.0f) voice->mDirect.FilterType |= AF_HighPass;
 
-        auto &lowpass = voice->mChans[0].mDryParams.LowPass;
-        auto &highpass = voice->mChans[0].mDryParams.HighPass;
-        lowpass.setParamsFromSlope(BiquadType::HighShelf, hfNorm, DryGain.HF, 1.0f);
-        highpass.setParamsFromSlope(BiquadType::LowShelf, lfNorm, DryGain.LF, 1.0f);
-        for(size_t c{1};c < num_channels;c++)
+        /* The gains can't fade between the full- and low-order mixes, so jump
+         * straight to the new ones when switching.
+         */
+        if(loworder != voice->mFlags.test(VoiceIsLowOrder))
         {
-            voice->mChans[c].mDryParams.LowPass.copyParamsFrom(lowpass);
-            voice->mChans[c].mDryParams.HighPass.copyParamsFrom(highpass);
+            for(auto &chandata : voice->mChans)
+                chandata.mDryParams.Gains.Current = chandata.mDryParams.Gains.Target;
+            voice->mFlags.set(VoiceIsLowOrder, loworder);
         }
     }
-    for(uint i{0};i < NumSends;i++)
-    {
-        const float hfNorm{props->Send[i].HFReference / Frequency};
-        const float lfNorm{props->Send[i].LFReference / Frequency};
-
-        voice->mSend[i].FilterType = AF_None;
-        if(WetGain[i].HF != 1.0f) voice->mSend[i].FilterType |= AF_LowPass;
-        if(WetGain[i].LF != 1.0f) voice->mSend[i].FilterType |= AF_HighPass;
 
-        auto &lowpass = voice->mChans[0].mWetParams[i].LowPass;
-        auto &highpass = voice->mChans[0].mWetParams[i].HighPass;
-        lowpass.setParamsFromSlope(BiquadType::HighShelf, hfNorm, WetGain[i].HF, 1.0f);
-        highpass.setParamsFromSlope(BiquadType::LowShelf, lfNorm, WetGain[i].LF, 1.0f);
-        for(size_t c{1};c < num_channels;c++)
-        {
-            voice->mChans[c].mWetParams[i].LowPass.copyParamsFrom(lowpass);
-            voice->mChans[c].mWetParams[i].HighPass.copyParamsFrom(highpass);
-        }
-    }
+    CalcVoiceFilters(voice, DryGain, WetGain, props, Device, Cache, true);
 }
 
-void CalcNonAttnSourceParams(Voice *voice, const VoiceProps *props, const ContextBase *context)
+void CalcNonAttnSourceParams(Voice *voice, const VoiceProps *props, const ContextBase *context,
+    const bool repan)
 {
     DeviceBase *Device{context->mDevice};
     std::array<EffectSlot*,MaxSendCount> SendSlots{};
 
-    voice->mDirect.Buffer = Device->Dry.Buffer;
     for(uint i{0};i < Device->NumAuxSends;i++)
     {
         SendSlots[i] = props->Send[i].Slot;
         if(!SendSlots[i] || SendSlots[i]->EffectType == EffectSlotType::None)
-        {
             SendSlots[i] = nullptr;
-            voice->mSend[i].Buffer = {};
-        }
-        else
-            voice->mSend[i].Buffer = SendSlots[i]->Wet.Buffer;
     }
 
     /* Calculate the stepping value */
@@ -1485,7 +1721,9 @@ void CalcNonAttnSourceParams(Voice *voice, const VoiceProps *props, const Contex
         voice->mStep = MaxPitch<<MixerFracBits;
     else
         voice->mStep = std::max(fastf2u(Pitch * MixerFracOne), 1u);
-    voice->mResampler = PrepareResampler(props->mResampler, voice->mStep, &voice->mResampleState);
+    voice->mResampler = context->mParamCache->prepareResampler(
+        LimitResampler(props->mResampler, Device->mMixQuality), voice->mStep,
+        &voice->mResampleState);
 
     /* Calculate gains */
     GainTriplet DryGain{};
@@ -1504,26 +1742,201 @@ void CalcNonAttnSourceParams(Voice *voice, const VoiceProps *props, const Contex
     }
 
     CalcPanningAndFilters(voice, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, DryGain, WetGain, SendSlots, props,
-        context->mParams, Device);
+        context->mParams, Device, *context->mParamCache, repan);
+}
+
+/* Holds the source vectors of a batch of attenuated voices, with each vector
+ * component in its own array so multiple voices can be processed at once.
+ * The calculated geometry is written back to the same arrays, with the
+ * position becoming the normalized ToSource vector, and the velocity becoming
+ * the ToSource velocities.
+ */
+struct VoiceGeometryBatch {
+    static constexpr size_t BatchSize{64};
+
+    alignas(16) std::array<float,BatchSize> PosX{}, PosY{}, PosZ{};
+    alignas(16) std::array<float,BatchSize> VelX{}, VelY{}, VelZ{};
+    alignas(16) std::array<float,BatchSize> DirX{}, DirY{}, DirZ{};
+    /* Non-0 for head-relative sources, which don't get transformed. */
+    alignas(16) std::array<float,BatchSize> HeadRel{};
+    alignas(16) std::array<float,BatchSize> Distance{};
+    alignas(16) std::array<float,BatchSize> DirLength{};
+
+    std::array<Voice*,BatchSize> Voices{};
+    /* Set for voices that only need to be recalculated if their geometry
+     * changed by more than the context's update tolerance.
+     */
+    std::array<bool,BatchSize> CheckGeometry{};
+    size_t Count{0};
+
+    void add(Voice *voice, const ContextParams &params, const bool checkGeometry) noexcept
+    {
+        const VoiceProps &props = voice->mProps;
+        const size_t idx{Count++};
+        Voices[idx] = voice;
+        CheckGeometry[idx] = checkGeometry;
+        if(!props.HeadRelative)
+        {
+            /* The listener-relative offset gets transformed with the velocity
+             * and direction.
+             */
+            PosX[idx] = props.Position[0] - params.Position[0];
+            PosY[idx] = props.Position[1] - params.Position[1];
+            PosZ[idx] = props.Position[2] - params.Position[2];
+            VelX[idx] = props.Velocity[0];
+            VelY[idx] = props.Velocity[1];
+            VelZ[idx] = props.Velocity[2];
+            HeadRel[idx] = 0.0f;
+        }
+        else
+        {
+            /* Offset the source velocity to be relative of the listener
+             * velocity.
+             */
+            PosX[idx] = props.Position[0];
+            PosY[idx] = props.Position[1];
+            PosZ[idx] = props.Position[2];
+            VelX[idx] = props.Velocity[0] + params.Velocity[0];
+            VelY[idx] = props.Velocity[1] + params.Velocity[1];
+            VelZ[idx] = props.Velocity[2] + params.Velocity[2];
+            HeadRel[idx] = 1.0f;
+        }
+        DirX[idx] = props.Direction[0];
+        DirY[idx] = props.Direction[1];
+        DirZ[idx] = props.Direction[2];
+    }
+
+    [[nodiscard]]
+    auto get(const size_t idx) const noexcept -> VoiceGeometry
+    {
+        return VoiceGeometry{alu::Vector{PosX[idx], PosY[idx], PosZ[idx], 0.0f},
+            alu::Vector{DirX[idx], DirY[idx], DirZ[idx], 0.0f}, Distance[idx],
+            DirLength[idx] > 0.0f, VelX[idx], VelY[idx]};
+    }
+};
+
+/* Transforms the batch's source vectors into listener space, and normalizes
+ * the position and direction vectors, four voices at a time when possible.
+ */
+void CalcVoiceGeometry(VoiceGeometryBatch &batch, const ContextParams &params) noexcept
+{
+    const alu::Matrix &mtx = params.Matrix;
+    const alu::Vector &lvel = params.Velocity;
+    static constexpr float Epsilon{std::numeric_limits<float>::epsilon()};
+
+#if HAVE_SSE_INTRINSICS
+    const auto count = (batch.Count+3_uz) & ~3_uz;
+    for(size_t i{0};i < count;i+=4)
+    {
+        const __m128 headrel{_mm_cmpneq_ps(_mm_load_ps(&batch.HeadRel[i]), _mm_setzero_ps())};
+        auto transform = [&mtx,headrel](const al::span<float,VoiceGeometryBatch::BatchSize> x,
+            const al::span<float,VoiceGeometryBatch::BatchSize> y,
+            const al::span<float,VoiceGeometryBatch::BatchSize> z, const size_t idx) noexcept
+        {
+            const __m128 x4{_mm_load_ps(&x[idx])};
+            const __m128 y4{_mm_load_ps(&y[idx])};
+            const __m128 z4{_mm_load_ps(&z[idx])};
+            auto row = [x4,y4,z4,&mtx](const size_t c) noexcept -> __m128
+            {
+                return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x4, _mm_set1_ps(mtx[0][c])),
+                    _mm_mul_ps(y4, _mm_set1_ps(mtx[1][c]))),
+                    _mm_mul_ps(z4, _mm_set1_ps(mtx[2][c])));
+            };
+            const __m128 rx{row(0)}, ry{row(1)}, rz{row(2)};
+            _mm_store_ps(&x[idx], _mm_or_ps(_mm_and_ps(headrel, x4), _mm_andnot_ps(headrel, rx)));
+            _mm_store_ps(&y[idx], _mm_or_ps(_mm_and_ps(headrel, y4), _mm_andnot_ps(headrel, ry)));
+            _mm_store_ps(&z[idx], _mm_or_ps(_mm_and_ps(headrel, z4), _mm_andnot_ps(headrel, rz)));
+        };
+        transform(batch.PosX, batch.PosY, batch.PosZ, i);
+        transform(batch.VelX, batch.VelY, batch.VelZ, i);
+        transform(batch.DirX, batch.DirY, batch.DirZ, i);
+
+        /* Normalizes the given vector components, returning the length (or 0
+         * if it's too short to normalize).
+         */
+        auto normalize = [](__m128 &x4, __m128 &y4, __m128 &z4) noexcept -> __m128
+        {
+            const __m128 len2{_mm_add_ps(_mm_add_ps(_mm_mul_ps(x4, x4), _mm_mul_ps(y4, y4)),
+                _mm_mul_ps(z4, z4))};
+            const __m128 valid{_mm_cmpgt_ps(len2, _mm_set1_ps(Epsilon))};
+            const __m128 len{_mm_sqrt_ps(len2)};
+            const __m128 invlen{_mm_div_ps(_mm_set1_ps(1.0f), len)};
+            x4 = _mm_and_ps(_mm_mul_ps(x4, invlen), valid);
+            y4 = _mm_and_ps(_mm_mul_ps(y4, invlen), valid);
+            z4 = _mm_and_ps(_mm_mul_ps(z4, invlen), valid);
+            return _mm_and_ps(len, valid);
+        };
+        __m128 dx{_mm_load_ps(&batch.DirX[i])};
+        __m128 dy{_mm_load_ps(&batch.DirY[i])};
+        __m128 dz{_mm_load_ps(&batch.DirZ[i])};
+        _mm_store_ps(&batch.DirLength[i], normalize(dx, dy, dz));
+        _mm_store_ps(&batch.DirX[i], dx);
+        _mm_store_ps(&batch.DirY[i], dy);
+        _mm_store_ps(&batch.DirZ[i], dz);
+
+        __m128 px{_mm_load_ps(&batch.PosX[i])};
+        __m128 py{_mm_load_ps(&batch.PosY[i])};
+        __m128 pz{_mm_load_ps(&batch.PosZ[i])};
+        _mm_store_ps(&batch.Distance[i], normalize(px, py, pz));
+        _mm_store_ps(&batch.PosX[i], px);
+        _mm_store_ps(&batch.PosY[i], py);
+        _mm_store_ps(&batch.PosZ[i], pz);
+
+        const __m128 vss{_mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(_mm_load_ps(&batch.VelX[i]), px),
+            _mm_mul_ps(_mm_load_ps(&batch.VelY[i]), py)),
+            _mm_mul_ps(_mm_load_ps(&batch.VelZ[i]), pz))};
+        const __m128 vls{_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(lvel[0]), px),
+            _mm_mul_ps(_mm_set1_ps(lvel[1]), py)), _mm_mul_ps(_mm_set1_ps(lvel[2]), pz))};
+        _mm_store_ps(&batch.VelX[i], vss);
+        _mm_store_ps(&batch.VelY[i], vls);
+    }
+
+#else
+
+    for(size_t i{0};i < batch.Count;++i)
+    {
+        alu::Vector Position{batch.PosX[i], batch.PosY[i], batch.PosZ[i], 0.0f};
+        alu::Vector Velocity{batch.VelX[i], batch.VelY[i], batch.VelZ[i], 0.0f};
+        alu::Vector Direction{batch.DirX[i], batch.DirY[i], batch.DirZ[i], 0.0f};
+        if(batch.HeadRel[i] == 0.0f)
+        {
+            Position = mtx * Position;
+            Velocity = mtx * Velocity;
+            Direction = mtx * Direction;
+        }
+
+        batch.DirLength[i] = Direction.normalize();
+        batch.DirX[i] = Direction[0];
+        batch.DirY[i] = Direction[1];
+        batch.DirZ[i] = Direction[2];
+
+        batch.Distance[i] = Position.normalize();
+        batch.PosX[i] = Position[0];
+        batch.PosY[i] = Position[1];
+        batch.PosZ[i] = Position[2];
+
+        batch.VelX[i] = Velocity.dot_product(Position);
+        batch.VelY[i] = lvel.dot_product(Position);
+    }
+#endif
 }
 
-void CalcAttnSourceParams(Voice *voice, const VoiceProps *props, const ContextBase *context)
+
+void CalcAttnSourceParams(Voice *voice, const VoiceProps *props, const ContextBase *context,
+    const VoiceGeometry &geom, const bool repan)
 {
     DeviceBase *Device{context->mDevice};
     const uint NumSends{Device->NumAuxSends};
 
-    /* Set mixing buffers and get send parameters. */
-    voice->mDirect.Buffer = Device->Dry.Buffer;
+    /* Get send parameters. */
     std::array<EffectSlot*,MaxSendCount> SendSlots{};
     std::array<float,MaxSendCount> RoomRolloff{};
     for(uint i{0};i < NumSends;i++)
     {
         SendSlots[i] = props->Send[i].Slot;
         if(!SendSlots[i] || SendSlots[i]->EffectType == EffectSlotType::None)
-        {
             SendSlots[i] = nullptr;
-            voice->mSend[i].Buffer = {};
-        }
         else
         {
             /* NOTE: Contrary to the EFX docs, the effect's room rolloff factor
@@ -1531,31 +1944,16 @@ void CalcAttnSourceParams(Voice *voice, const VoiceProps *props, const ContextBa
              * room rolloff factor, not necessarily the inverse distance model.
              */
             RoomRolloff[i] = props->RoomRolloffFactor + SendSlots[i]->RoomRolloff;
-
-            voice->mSend[i].Buffer = SendSlots[i]->Wet.Buffer;
         }
     }
 
-    /* Transform source to listener space (convert to head relative) */
-    alu::Vector Position{props->Position[0], props->Position[1], props->Position[2], 1.0f};
-    alu::Vector Velocity{props->Velocity[0], props->Velocity[1], props->Velocity[2], 0.0f};
-    alu::Vector Direction{props->Direction[0], props->Direction[1], props->Direction[2], 0.0f};
-    if(!props->HeadRelative)
-    {
-        /* Transform source vectors */
-        Position = context->mParams.Matrix * (Position - context->mParams.Position);
-        Velocity = context->mParams.Matrix * Velocity;
-        Direction = context->mParams.Matrix * Direction;
-    }
-    else
-    {
-        /* Offset the source velocity to be relative of the listener velocity */
-        Velocity += context->mParams.Velocity;
-    }
-
-    const bool directional{Direction.normalize() > 0.0f};
-    alu::Vector ToSource{Position[0], Position[1], Position[2], 0.0f};
-    const float Distance{ToSource.normalize()};
+    /* The source vectors were already transformed to listener space (head
+     * relative) and normalized.
+     */
+    const alu::Vector &Direction = geom.Direction;
+    const alu::Vector &ToSource = geom.ToSource;
+    const bool directional{geom.Directional};
+    const float Distance{geom.Distance};
 
     /* Calculate distance attenuation */
     float ClampedDist{Distance};
@@ -1735,9 +2133,8 @@ void CalcAttnSourceParams(Voice *voice, const VoiceProps *props, const ContextBa
     float DopplerFactor{props->DopplerFactor * context->mParams.DopplerFactor};
     if(DopplerFactor > 0.0f)
     {
-        const alu::Vector &lvelocity = context->mParams.Velocity;
-        float vss{Velocity.dot_product(ToSource) * -DopplerFactor};
-        float vls{lvelocity.dot_product(ToSource) * -DopplerFactor};
+        const float vss{geom.SourceVel * -DopplerFactor};
+        const float vls{geom.ListenerVel * -DopplerFactor};
 
         const float SpeedOfSound{context->mParams.SpeedOfSound};
         if(!(vls < SpeedOfSound))
@@ -1771,7 +2168,9 @@ void CalcAttnSourceParams(Voice *voice, const VoiceProps *props, const ContextBa
         voice->mStep = MaxPitch<<MixerFracBits;
     else
         voice->mStep = std::max(fastf2u(Pitch * MixerFracOne), 1u);
-    voice->mResampler = PrepareResampler(props->mResampler, voice->mStep, &voice->mResampleState);
+    voice->mResampler = context->mParamCache->prepareResampler(
+        LimitResampler(props->mResampler, Device->mMixQuality), voice->mStep,
+        &voice->mResampleState);
 
     float spread{0.0f};
     if(props->Radius > Distance)
@@ -1780,28 +2179,199 @@ void CalcAttnSourceParams(Voice *voice, const VoiceProps *props, const ContextBa
         spread = std::asin(props->Radius/Distance) * 2.0f;
 
     CalcPanningAndFilters(voice, ToSource[0]*XScale, ToSource[1]*YScale, ToSource[2]*ZScale,
-        Distance, spread, DryGain, WetGain, SendSlots, props, context->mParams, Device);
+        Distance, spread, DryGain, WetGain, SendSlots, props, context->mParams, Device,
+        *context->mParamCache, repan);
 }
 
-void CalcSourceParams(Voice *voice, ContextBase *context, bool force)
+/* Finds the loudest target gain the voice will be mixed with. */
+float CalcAudibleGain(const Voice *voice, const uint numsends)
 {
-    VoicePropsItem *props{voice->mUpdate.exchange(nullptr, std::memory_order_acq_rel)};
-    if(!props && !force) return;
+    auto max_gain = [](const float gain, const al::span<const float> gains) noexcept -> float
+    {
+        return std::accumulate(gains.begin(), gains.end(), gain,
+            [](const float cur, const float val) noexcept { return std::max(cur, std::abs(val)); });
+    };
 
-    if(props)
+    float gain{0.0f};
+    for(const Voice::ChannelData &chandata : voice->mChans)
     {
-        voice->mProps = static_cast<VoiceProps&>(*props);
+        const DirectParams &dryparams = chandata.mDryParams;
+        if(voice->mFlags.test(VoiceHasHrtf))
+            gain = std::max(gain, dryparams.Hrtf.Target.Gain);
+        else
+            gain = max_gain(gain, al::span{dryparams.Gains.Target}.first(
+                voice->mDirect.Buffer.size()));
 
-        AtomicReplaceHead(context->mFreeVoiceProps, props);
+        for(uint send{0};send < numsends;++send)
+        {
+            const size_t wetchans{voice->mSend[send].Buffer.size()};
+            gain = max_gain(gain, al::span{chandata.mWetParams[send].Gains.Target}.first(
+                wetchans));
+        }
     }
+    return gain;
+}
 
-    if((voice->mProps.DirectChannels != DirectMode::Off && voice->mFmtChannels != FmtMono
+/* The inputs of a voice's parameters that changed since they were last
+ * calculated. Only changes to the voice's properties or the listener need the
+ * voice's listener-relative geometry to be recalculated.
+ */
+enum VoiceDirty : uint {
+    /* The voice's own properties, other than its gains and filters. */
+    VoiceDirtyProps = 1u<<0,
+    /* The listener position, orientation, or velocity. */
+    VoiceDirtyListener = 1u<<1,
+    /* Context properties or the mixing quality, which apply to every voice. */
+    VoiceDirtyContext = 1u<<2,
+    /* The send parameters of an effect slot the voice sends to. */
+    VoiceDirtySends = 1u<<3,
+    /* The voice's pitch, or its direct or send gains. */
+    VoiceDirtyGain = 1u<<4,
+    /* The voice's direct or send filter gains or reference frequencies. */
+    VoiceDirtyFilter = 1u<<5,
+
+    VoiceDirtyGeometry = VoiceDirtyProps | VoiceDirtyListener,
+    /* Changes that need the voice to be re-panned. Gain, filter, and effect
+     * slot send changes just rescale the panned gains and set up the filters
+     * of the outputs they affect.
+     */
+    VoiceDirtyPanning = VoiceDirtyGeometry | VoiceDirtyContext
+};
+
+/* Finds which kinds of the voice's properties changed. Anything other than
+ * the gain and filter properties changing, or an update without any change,
+ * is a full property change.
+ */
+uint GetVoicePropChanges(const VoiceProps &oldprops, const VoiceProps &newprops) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<VoiceProps>);
+
+    /* Put the old gain and filter properties in a copy of the new ones, noting
+     * which of them changed.
+     */
+    VoiceProps test{newprops};
+    uint changes{0u};
+    auto restore = [&changes](float &newval, const float oldval, const uint change) noexcept
+    {
+        if(newval == oldval) return;
+        newval = oldval;
+        changes |= change;
+    };
+    restore(test.Pitch, oldprops.Pitch, VoiceDirtyGain);
+    restore(test.Gain, oldprops.Gain, VoiceDirtyGain);
+    restore(test.MinGain, oldprops.MinGain, VoiceDirtyGain);
+    restore(test.MaxGain, oldprops.MaxGain, VoiceDirtyGain);
+    restore(test.Direct.Gain, oldprops.Direct.Gain, VoiceDirtyGain);
+    restore(test.Direct.GainHF, oldprops.Direct.GainHF, VoiceDirtyFilter);
+    restore(test.Direct.HFReference, oldprops.Direct.HFReference, VoiceDirtyFilter);
+    restore(test.Direct.GainLF, oldprops.Direct.GainLF, VoiceDirtyFilter);
+    restore(test.Direct.LFReference, oldprops.Direct.LFReference, VoiceDirtyFilter);
+    for(size_t i{0};i < MaxSendCount;++i)
+    {
+        restore(test.Send[i].Gain, oldprops.Send[i].Gain, VoiceDirtyGain);
+        restore(test.Send[i].GainHF, oldprops.Send[i].GainHF, VoiceDirtyFilter);
+        restore(test.Send[i].HFReference, oldprops.Send[i].HFReference, VoiceDirtyFilter);
+        restore(test.Send[i].GainLF, oldprops.Send[i].GainLF, VoiceDirtyFilter);
+        restore(test.Send[i].LFReference, oldprops.Send[i].LFReference, VoiceDirtyFilter);
+    }
+
+    /* Anything else that changed needs the voice re-panned. Comparing bytes
+     * can only mistake equal values as different (e.g. 0 and -0, or padding),
+     * which just recalculates more than needed.
+     */
+    if(!changes || std::memcmp(&test, &oldprops, sizeof(VoiceProps)) != 0)
+        return VoiceDirtyProps;
+    return changes;
+}
+
+/* Picks up any pending property update for the voice, returning which of its
+ * properties changed (0 if there was no update).
+ */
+uint UpdateVoiceProps(Voice *voice, ContextBase *context)
+{
+    VoicePropsItem *props{voice->mUpdate.exchange(nullptr, std::memory_order_acq_rel)};
+    if(!props) return 0u;
+
+    const uint changes{GetVoicePropChanges(voice->mProps, *props)};
+    voice->mProps = static_cast<VoiceProps&>(*props);
+
+    AtomicReplaceHead(context->mFreeVoiceProps, props);
+    return changes;
+}
+
+/* Checks if any of the voice's sends go to an effect slot whose send
+ * parameters changed.
+ */
+bool SendsToChangedSlot(const Voice *voice, const uint numsends) noexcept
+{
+    const auto sends = al::span{voice->mProps.Send}.first(numsends);
+    return std::any_of(sends.begin(), sends.end(), [](const VoiceProps::SendData &send) noexcept
+        { return send.Slot && send.Slot->mSendParamsChanged; });
+}
+
+bool IsAttenuatedVoice(const Voice *voice) noexcept
+{
+    return !((voice->mProps.DirectChannels != DirectMode::Off && voice->mFmtChannels != FmtMono
             && !IsAmbisonic(voice->mFmtChannels))
         || voice->mProps.mSpatializeMode == SpatializeMode::Off
-        || (voice->mProps.mSpatializeMode==SpatializeMode::Auto && voice->mFmtChannels != FmtMono))
-        CalcNonAttnSourceParams(voice, &voice->mProps, context);
-    else
-        CalcAttnSourceParams(voice, &voice->mProps, context);
+        || (voice->mProps.mSpatializeMode==SpatializeMode::Auto && voice->mFmtChannels != FmtMono));
+}
+
+/* Checks if the new geometry is within the tolerance of the old. Directions
+ * are compared as unit vectors, the distance relative to the old distance, and
+ * the velocities relative to the speed of sound (as they affect the doppler
+ * shift).
+ */
+bool IsWithinTolerance(const VoiceGeometry &oldgeom, const VoiceGeometry &newgeom,
+    const float tolerance, const float speedOfSound) noexcept
+{
+    auto diff2 = [](const alu::Vector &lhs, const alu::Vector &rhs) noexcept -> float
+    {
+        const alu::Vector diff{lhs - rhs};
+        return diff.dot_product(diff);
+    };
+
+    if(oldgeom.Directional != newgeom.Directional)
+        return false;
+    const float tolerance2{tolerance * tolerance};
+    if(diff2(oldgeom.ToSource, newgeom.ToSource) > tolerance2)
+        return false;
+    if(newgeom.Directional && diff2(oldgeom.Direction, newgeom.Direction) > tolerance2)
+        return false;
+    if(std::abs(newgeom.Distance - oldgeom.Distance) > oldgeom.Distance*tolerance)
+        return false;
+    const float veltolerance{speedOfSound * tolerance};
+    return std::abs(newgeom.SourceVel - oldgeom.SourceVel) <= veltolerance
+        && std::abs(newgeom.ListenerVel - oldgeom.ListenerVel) <= veltolerance;
+}
+
+/* Calculates the parameters for the batch's voices, returning the number of
+ * voices skipped for being within the update tolerance.
+ */
+uint CalcSourceBatchParams(VoiceGeometryBatch &batch, ContextBase *context)
+{
+    CalcVoiceGeometry(batch, context->mParams);
+
+    const uint numsends{context->mDevice->NumAuxSends};
+    const float tolerance{context->mParams.UpdateTolerance};
+    uint skipped{0};
+    for(size_t i{0};i < batch.Count;++i)
+    {
+        Voice *voice{batch.Voices[i]};
+        const VoiceGeometry geom{batch.get(i)};
+        if(batch.CheckGeometry[i]
+            && IsWithinTolerance(voice->mGeometry, geom, tolerance, context->mParams.SpeedOfSound))
+        {
+            ++skipped;
+            continue;
+        }
+
+        voice->mGeometry = geom;
+        CalcAttnSourceParams(voice, &voice->mProps, context, geom, true);
+        voice->mAudibleGain = CalcAudibleGain(voice, numsends);
+    }
+    batch.Count = 0;
+    return skipped;
 }
 
 
@@ -1829,13 +2399,15 @@ void SendSourceStateEvent(ContextBase *context, uint id, VChangeState state)
         break;
     /* Shouldn't happen. */
     case VChangeState::Restart:
+    case VChangeState::StopAt:
+    case VChangeState::GainRamp:
         al::unreachable();
     }
 
     ring->writeAdvance(1);
 }
 
-void ProcessVoiceChanges(ContextBase *ctx)
+void ProcessVoiceChanges(ContextBase *ctx, const nanoseconds curtime)
 {
     VoiceChange *cur{ctx->mCurrentVoiceChange.load(std::memory_order_acquire)};
     VoiceChange *next{cur->mNext.load(std::memory_order_acquire)};
@@ -1917,11 +2489,43 @@ void ProcessVoiceChanges(ContextBase *ctx)
                     std::memory_order_relaxed, std::memory_order_acquire);
 
                 Voice *voice{cur->mVoice};
+                voice->mStopTime = oldvoice->mStopTime;
+                voice->mGainRamp = oldvoice->mGainRamp;
                 voice->mPlayState.store((oldvstate == Voice::Playing) ? Voice::Playing
                     : Voice::Stopped, std::memory_order_release);
             }
             oldvoice->mPendingChange.store(false, std::memory_order_release);
         }
+        else if(cur->mState == VChangeState::StopAt)
+        {
+            /* Scheduled changes only apply if the voice is still playing the
+             * source they were made for. A time that's already passed takes
+             * effect with this update.
+             */
+            Voice *voice{cur->mVoice};
+            if(voice->mSourceID.load(std::memory_order_relaxed) == cur->mSourceID)
+                voice->mStopTime = std::max(cur->mTime, curtime);
+            voice->mPendingChange.store(false, std::memory_order_release);
+        }
+        else if(cur->mState == VChangeState::GainRamp)
+        {
+            /* A new ramp replaces the old one, starting from the gain the old
+             * one has at that time. If the start time already passed, the
+             * ramp starts with this update and still ends at its end time.
+             */
+            Voice *voice{cur->mVoice};
+            if(voice->mSourceID.load(std::memory_order_relaxed) == cur->mSourceID)
+            {
+                const auto start = std::max(cur->mTime, curtime);
+                const auto end = std::max(cur->mTime+cur->mDuration, start);
+                voice->mGainRamp = VoiceGainRamp{start, end, voice->mGainRamp.at(start),
+                    cur->mGain};
+            }
+            voice->mPendingChange.store(false, std::memory_order_release);
+        }
+        /* One-shot sounds don't send state change events to the app. */
+        if(sendevt && cur->mVoice && cur->mVoice->mFlags.test(VoiceIsOneShot))
+            sendevt = false;
         if(sendevt && enabledevt.test(al::to_underlying(AsyncEnableBits::SourceState)))
             SendSourceStateEvent(ctx, cur->mSourceID, cur->mState);
 
@@ -1931,43 +2535,357 @@ void ProcessVoiceChanges(ContextBase *ctx)
 }
 
 void ProcessParamUpdates(ContextBase *ctx, const al::span<EffectSlot*> slots,
-    const al::span<EffectSlot*> sorted_slots, const al::span<Voice*> voices)
+    const al::span<EffectSlot*> sorted_slots, const al::span<Voice*> voices,
+    const nanoseconds curtime)
 {
-    ProcessVoiceChanges(ctx);
+    ProcessVoiceChanges(ctx, curtime);
 
     IncrementRef(ctx->mUpdateCount);
     if(!ctx->mHoldUpdates.load(std::memory_order_acquire)) LIKELY
     {
-        bool force{CalcContextParams(ctx)};
+        /* Find what changed for all voices. Context property changes may also
+         * include listener changes.
+         */
+        const ContextChange change{CalcContextParams(ctx)};
+        uint allchanges{0u};
+        if(change == ContextChange::All)
+            allchanges = VoiceDirtyContext | VoiceDirtyListener;
+        const bool listenerChanged{change == ContextChange::ListenerPosition
+            || change == ContextChange::ListenerVelocity};
+
+        /* Recalculate all voices when the mixing quality changes, so they get
+         * a suitable resampler.
+         */
+        if(ctx->mMixQuality != ctx->mDevice->mMixQuality) UNLIKELY
+        {
+            ctx->mMixQuality = ctx->mDevice->mMixQuality;
+            allchanges |= VoiceDirtyContext;
+        }
+
         auto sorted_slot_base = al::to_address(sorted_slots.begin());
+        bool slotsChanged{false};
         for(EffectSlot *slot : slots)
-            force |= CalcEffectSlotParams(slot, sorted_slot_base, ctx);
+            slotsChanged |= CalcEffectSlotParams(slot, sorted_slot_base, ctx);
 
+        /* Attenuated voices needing their listener-relative geometry are
+         * gathered into batches, to calculate it together.
+         */
+        VoiceGeometryBatch batch;
+        const uint numsends{ctx->mDevice->NumAuxSends};
+        const bool hasTolerance{ctx->mParams.UpdateTolerance > 0.0f};
+        uint skipped{0};
         for(Voice *voice : voices)
         {
             /* Only update voices that have a source. */
-            if(voice->mSourceID.load(std::memory_order_relaxed) != 0)
-                CalcSourceParams(voice, ctx, force);
+            if(voice->mSourceID.load(std::memory_order_relaxed) == 0)
+                continue;
+
+            uint changes{allchanges | UpdateVoiceProps(voice, ctx)};
+            if(slotsChanged && SendsToChangedSlot(voice, numsends))
+                changes |= VoiceDirtySends;
+
+            /* A listener change only affects attenuated voices. Head-relative
+             * voices are also unaffected unless the listener velocity changed.
+             */
+            const bool attenuated{IsAttenuatedVoice(voice)};
+            if(listenerChanged)
+            {
+                if(attenuated && (!voice->mProps.HeadRelative
+                    || change == ContextChange::ListenerVelocity))
+                    changes |= VoiceDirtyListener;
+                else if(!changes)
+                    ++skipped;
+            }
+            if(!changes)
+                continue;
+
+            /* A newly started or reset voice has no previous parameters to
+             * reuse, so any change recalculates it fully.
+             */
+            if(voice->mFlags.test(VoiceNeedsFullUpdate))
+            {
+                changes |= VoiceDirtyProps;
+                voice->mFlags.reset(VoiceNeedsFullUpdate);
+            }
+
+            const bool repan{(changes&VoiceDirtyPanning) != 0};
+            if(!attenuated)
+            {
+                CalcNonAttnSourceParams(voice, &voice->mProps, ctx, repan);
+                voice->mAudibleGain = CalcAudibleGain(voice, numsends);
+                continue;
+            }
+
+            /* Without a change to its properties or the listener, the voice's
+             * previous geometry is still valid.
+             */
+            if(!(changes&VoiceDirtyGeometry))
+            {
+                CalcAttnSourceParams(voice, &voice->mProps, ctx, voice->mGeometry, repan);
+                voice->mAudibleGain = CalcAudibleGain(voice, numsends);
+                continue;
+            }
+
+            /* With an update tolerance, a voice that only has a listener change
+             * is only recalculated if its geometry changed enough.
+             */
+            batch.add(voice, ctx->mParams, hasTolerance && changes == VoiceDirtyListener);
+            if(batch.Count == batch.BatchSize)
+                skipped += CalcSourceBatchParams(batch, ctx);
+        }
+        if(batch.Count > 0)
+            skipped += CalcSourceBatchParams(batch, ctx);
+
+        if(slotsChanged)
+        {
+            for(EffectSlot *slot : slots)
+                slot->mSendParamsChanged = false;
         }
+
+        if(skipped > 0)
+            ctx->mSkippedVoiceUpdates.store(ctx->mSkippedVoiceUpdates.load(
+                std::memory_order_relaxed) + skipped, std::memory_order_relaxed);
     }
     IncrementRef(ctx->mUpdateCount);
 }
 
+/* Marks voices as virtual when they're inaudible, or quieter than the
+ * context's audible voice limit allows. Virtual voices keep playing, but
+ * aren't mixed until they become audible again.
+ */
+void UpdateVirtualVoices(ContextBase *ctx, const al::span<Voice*> voices)
+{
+    /* Callback voices need their data read as it plays, and decoders need to
+     * keep their state, so those are never made virtual.
+     */
+    auto can_virtualize = [](const Voice *voice) noexcept -> bool
+    {
+        return voice->mPlayState.load(std::memory_order_acquire) == Voice::Playing
+            && !voice->mFlags.test(VoiceIsCallback) && !voice->mDecoder;
+    };
+
+    const auto ranked = ctx->getVoiceRankSpanAcquired();
+    auto rank_end = ranked.begin();
+    for(Voice *voice : voices)
+    {
+        if(!can_virtualize(voice))
+            voice->mFlags.reset(VoiceIsVirtual);
+        else if(!(voice->mAudibleGain > GainSilenceThreshold))
+            voice->mFlags.set(VoiceIsVirtual);
+        else
+            *(rank_end++) = voice;
+    }
+
+    const size_t limit{ctx->mAudibleVoiceLimit};
+    const auto numranked = static_cast<size_t>(std::distance(ranked.begin(), rank_end));
+    if(limit == 0 || numranked <= limit)
+    {
+        std::for_each(ranked.begin(), rank_end,
+            [](Voice *voice) noexcept { voice->mFlags.reset(VoiceIsVirtual); });
+        return;
+    }
+
+    /* Favor voices that are already being mixed by +6dB, so voices near the
+     * limit don't keep swapping.
+     */
+    auto rank_gain = [](const Voice *voice) noexcept -> float
+    { return voice->mAudibleGain * (voice->mFlags.test(VoiceIsVirtual) ? 1.0f : 2.0f); };
+    const auto limit_iter = ranked.begin() + static_cast<ptrdiff_t>(limit);
+    std::nth_element(ranked.begin(), limit_iter, rank_end,
+        [rank_gain](const Voice *lhs, const Voice *rhs) noexcept -> bool
+        { return rank_gain(lhs) > rank_gain(rhs); });
+
+    std::for_each(ranked.begin(), limit_iter,
+        [](Voice *voice) noexcept { voice->mFlags.reset(VoiceIsVirtual); });
+    std::for_each(limit_iter, rank_end,
+        [](Voice *voice) noexcept { voice->mFlags.set(VoiceIsVirtual); });
+}
+
+/* Mixes the voices split between the device's mixing groups, then sums the
+ * partial mixes into the main mix in group order. The groups are mixed on the
+ * worker threads if there are any, or otherwise in turn, so the output is the
+ * same either way.
+ */
+void ProcessVoiceGroups(DeviceBase *device, ContextBase *ctx, const al::span<Voice*> voices,
+    const al::span<EffectSlot*> auxslots, const nanoseconds curtime, const uint SamplesToDo)
+{
+    const uint numgroups{device->mMixGroupCount};
+
+    /* Callback voices call into the app, so only mix them on the mixer thread,
+     * directly to the main mix.
+     */
+    for(Voice *voice : voices)
+    {
+        const Voice::State vstate{voice->mPlayState.load(std::memory_order_acquire)};
+        if(vstate != Voice::Stopped && vstate != Voice::Pending
+            && voice->mFlags.test(VoiceIsCallback))
+            voice->mix(vstate, ctx, curtime, SamplesToDo, device->mScratch, 0);
+    }
+    FlushFilterLanes(device->mScratch, device);
+
+    /* Voices are assigned to groups by their index, independent of the number
+     * of threads.
+     */
+    auto mix_group = [device,ctx,voices,curtime,SamplesToDo,numgroups](const size_t groupidx)
+    {
+        MixerScratch &scratch = device->mGroupScratch[groupidx];
+        const auto group = static_cast<uint>(groupidx + 1);
+        for(size_t i{groupidx};i < voices.size();i += numgroups)
+        {
+            Voice *voice{voices[i]};
+            const Voice::State vstate{voice->mPlayState.load(std::memory_order_acquire)};
+            if(vstate != Voice::Stopped && vstate != Voice::Pending
+                && !voice->mFlags.test(VoiceIsCallback))
+                voice->mix(vstate, ctx, curtime, SamplesToDo, scratch, group);
+        }
+        FlushFilterLanes(scratch, device);
+    };
+    if(device->mMixerPool)
+        device->mMixerPool->run(numgroups, mix_group);
+    else
+    {
+        for(size_t group{0};group < numgroups;++group)
+            mix_group(group);
+    }
+
+    /* Add each partial mix to the main mix, leaving the partial mix cleared
+     * for next time.
+     */
+    auto sum_partial = [SamplesToDo](const al::span<FloatBufferLine> dst,
+        const al::span<FloatBufferLine> src)
+    {
+        auto srcchan = src.begin();
+        for(FloatBufferLine &dstchan : dst)
+        {
+            const auto input = al::span{*srcchan}.first(SamplesToDo);
+            std::transform(input.cbegin(), input.cend(), dstchan.cbegin(), dstchan.begin(),
+                std::plus<float>{});
+            std::fill(input.begin(), input.end(), 0.0f);
+            ++srcchan;
+        }
+    };
+    const size_t numchans{device->mMixChannels};
+    const auto mixbuffer = al::span{device->MixBuffer};
+    for(size_t group{1};group <= numgroups;++group)
+        sum_partial(mixbuffer.first(numchans), mixbuffer.subspan(numchans*group, numchans));
+
+    for(EffectSlot *slot : auxslots)
+    {
+        const auto wetbuffer = slot->Wet.Buffer;
+        const size_t wetchans{wetbuffer.size()};
+        for(size_t group{1};group <= numgroups;++group)
+            sum_partial(wetbuffer, al::span{wetbuffer.data() + wetchans*group, wetchans});
+    }
+
+    if(device->mRenderMode == RenderMode::Hrtf)
+    {
+        const auto accum = al::span{device->mScratch.HrtfAccumData}.first(SamplesToDo+HrirLength);
+        for(MixerScratch &scratch : device->mGroupScratch)
+        {
+            const auto input = al::span{scratch.HrtfAccumData}.first(accum.size());
+            std::transform(input.cbegin(), input.cend(), accum.cbegin(), accum.begin(),
+                [](const float2 &src, const float2 &dst) noexcept -> float2
+                { return float2{{src[0]+dst[0], src[1]+dst[1]}}; });
+            std::fill(input.begin(), input.end(), float2{});
+        }
+    }
+
+    /* Send the events held while mixing on the workers, in voice order. */
+    std::for_each(voices.begin(), voices.end(),
+        [ctx](Voice *voice) { voice->sendPendingEvents(ctx); });
+}
+
+/* Processes the sorted effect slots one depth level at a time, spreading the
+ * slots of each level over the worker threads if there are any. Each slot of
+ * a level writes to its own output buffer, which gets added to the effect's
+ * output target in sorted order once the level is done.
+ */
+void ProcessEffectSlotGroups(DeviceBase *device, const al::span<EffectSlot*> sorted_slots,
+    const uint SamplesToDo)
+{
+    auto proc_slot = [SamplesToDo](const EffectSlot *slot)
+    {
+        EffectState *state{slot->mEffectState.get()};
+        state->process(SamplesToDo, slot->Wet.Buffer, state->mOutTarget);
+    };
+    auto can_split = [](const EffectSlot *slot) noexcept -> bool
+    {
+        const EffectState *state{slot->mEffectState.get()};
+        return slot->mOutputBuffer.size() >= state->mOutTarget.size();
+    };
+
+    auto remaining = sorted_slots;
+    while(!remaining.empty())
+    {
+        const uint depth{remaining.front()->mTargetDepth};
+        const auto level_end = std::find_if(remaining.begin()+1, remaining.end(),
+            [depth](const EffectSlot *slot) noexcept { return slot->mTargetDepth != depth; });
+        const auto level = remaining.first(static_cast<size_t>(level_end - remaining.begin()));
+        remaining = remaining.subspan(level.size());
+
+        if(level.size() == 1)
+        {
+            proc_slot(level.front());
+            continue;
+        }
+
+        auto proc_split = [level,SamplesToDo,can_split](const size_t idx)
+        {
+            EffectSlot *slot{level[idx]};
+            if(!can_split(slot)) return;
+
+            EffectState *state{slot->mEffectState.get()};
+            const auto output = al::span{slot->mOutputBuffer}.first(state->mOutTarget.size());
+            state->process(SamplesToDo, slot->Wet.Buffer, output);
+        };
+        if(device->mMixerPool)
+            device->mMixerPool->run(level.size(), proc_split);
+        else
+        {
+            for(size_t idx{0};idx < level.size();++idx)
+                proc_split(idx);
+        }
+
+        for(EffectSlot *slot : level)
+        {
+            if(!can_split(slot))
+            {
+                proc_slot(slot);
+                continue;
+            }
+
+            const EffectState *state{slot->mEffectState.get()};
+            auto srcchan = slot->mOutputBuffer.begin();
+            for(FloatBufferLine &dstchan : state->mOutTarget)
+            {
+                const auto input = al::span{*srcchan}.first(SamplesToDo);
+                std::transform(input.cbegin(), input.cend(), dstchan.cbegin(), dstchan.begin(),
+                    std::plus<float>{});
+                std::fill(input.begin(), input.end(), 0.0f);
+                ++srcchan;
+            }
+        }
+    }
+}
+
 void ProcessContexts(DeviceBase *device, const uint SamplesToDo)
 {
     ASSUME(SamplesToDo > 0);
 
     const auto curtime = device->getClockTime();
 
-    auto proc_context = [SamplesToDo,curtime](ContextBase *ctx)
+    auto proc_context = [device,SamplesToDo,curtime](ContextBase *ctx)
     {
         const auto auxslotspan = al::span{*ctx->mActiveAuxSlots.load(std::memory_order_acquire)};
         const auto auxslots = auxslotspan.first(auxslotspan.size()>>1);
         const auto sorted_slots = auxslotspan.last(auxslotspan.size()>>1);
         const auto voices = ctx->getVoicesSpanAcquired();
+        auto &profile = device->mMixProfile;
 
         /* Process pending property updates for objects on the context. */
-        ProcessParamUpdates(ctx, auxslots, sorted_slots, voices);
+        auto stagetime = MixProfile::clock::now();
+        ProcessParamUpdates(ctx, auxslots, sorted_slots, voices, curtime);
+        stagetime = profile.mark(MixStage::ParamUpdates, stagetime);
 
         /* Clear auxiliary effect slot mixing buffers. */
         auto clear_wetbuffers = [](EffectSlot *slot)
@@ -1978,14 +2896,23 @@ void ProcessContexts(DeviceBase *device, const uint SamplesToDo)
         };
         std::for_each(auxslots.begin(), auxslots.end(), clear_wetbuffers);
 
+        UpdateVirtualVoices(ctx, voices);
+
         /* Process voices that have a playing source. */
-        auto proc_voice = [ctx,curtime,SamplesToDo](Voice *voice)
+        if(device->mMixGroupCount > 0)
+            ProcessVoiceGroups(device, ctx, voices, auxslots, curtime, SamplesToDo);
+        else
         {
-            const Voice::State vstate{voice->mPlayState.load(std::memory_order_acquire)};
-            if(vstate != Voice::Stopped && vstate != Voice::Pending)
-                voice->mix(vstate, ctx, curtime, SamplesToDo);
-        };
-        std::for_each(voices.begin(), voices.end(), proc_voice);
+            auto proc_voice = [device,ctx,curtime,SamplesToDo](Voice *voice)
+            {
+                const Voice::State vstate{voice->mPlayState.load(std::memory_order_acquire)};
+                if(vstate != Voice::Stopped && vstate != Voice::Pending)
+                    voice->mix(vstate, ctx, curtime, SamplesToDo, device->mScratch, 0);
+            };
+            std::for_each(voices.begin(), voices.end(), proc_voice);
+            FlushFilterLanes(device->mScratch, device);
+        }
+        stagetime = profile.mark(MixStage::Voices, stagetime);
 
         /* Process effects. */
         if(!auxslots.empty())
@@ -2028,14 +2955,39 @@ void ProcessContexts(DeviceBase *device, const uint SamplesToDo)
                     { return slot->Target != *next_target; };
                     split_point = std::partition(sorted_slots.begin(), split_point, not_next);
                 }
+
+                /* Record how deep in the target chain each slot is, then
+                 * order the slots deepest first. This still has each slot
+                 * come before its target, while grouping together slots that
+                 * can be processed independently of each other.
+                 */
+                const auto maxdepth = static_cast<uint>(sorted_slots.size());
+                std::for_each(sorted_slots.begin(), sorted_slots.end(),
+                    [maxdepth](EffectSlot *slot) noexcept
+                    {
+                        uint depth{0u};
+                        for(auto *target = slot->Target;target && depth < maxdepth;
+                            target = target->Target)
+                            ++depth;
+                        slot->mTargetDepth = depth;
+                    });
+                std::sort(sorted_slots.begin(), sorted_slots.end(),
+                    [](const EffectSlot *lhs, const EffectSlot *rhs) noexcept -> bool
+                    { return lhs->mTargetDepth > rhs->mTargetDepth; });
             }
 
-            auto proc_slot = [SamplesToDo](const EffectSlot *slot)
+            if(device->mMixGroupCount > 0)
+                ProcessEffectSlotGroups(device, sorted_slots, SamplesToDo);
+            else
             {
-                EffectState *state{slot->mEffectState.get()};
-                state->process(SamplesToDo, slot->Wet.Buffer, state->mOutTarget);
-            };
-            std::for_each(sorted_slots.begin(), sorted_slots.end(), proc_slot);
+                auto proc_slot = [SamplesToDo](const EffectSlot *slot)
+                {
+                    EffectState *state{slot->mEffectState.get()};
+                    state->process(SamplesToDo, slot->Wet.Buffer, state->mOutTarget);
+                };
+                std::for_each(sorted_slots.begin(), sorted_slots.end(), proc_slot);
+            }
+            profile.mark(MixStage::Effects, stagetime);
         }
 
         /* Signal the event handler if there are any events to read. */
@@ -2046,6 +2998,24 @@ void ProcessContexts(DeviceBase *device, const uint SamplesToDo)
     std::for_each(contexts.begin(), contexts.end(), proc_context);
 }
 
+/* Applies the HF scaling to the first-order mix of low-order voices, and adds
+ * it to the dry mix with the up-converting gains. The first-order mix gets
+ * cleared with the dry mix for the next update.
+ */
+void MixLowOrder(DeviceBase *device, const uint SamplesToDo)
+{
+    auto splitter = device->mLowOrderSplitters.begin();
+    auto hfscale = device->mLowOrderHFScales.cbegin();
+    auto gains = device->mLowOrderGains.begin();
+    for(FloatBufferLine &buffer : device->LowOrder.Buffer)
+    {
+        const auto samples = al::span{buffer}.first(SamplesToDo);
+        (splitter++)->processHfScale(samples, *(hfscale++));
+        MixSamples(samples, device->Dry.Buffer, *gains, *gains, 0, 0);
+        ++gains;
+    }
+}
+
 
 void ApplyDistanceComp(const al::span<FloatBufferLine> Samples, const size_t SamplesToDo,
     const al::span<const DistanceComp::ChanData,MaxOutputChannels> chandata)
@@ -2189,15 +3159,22 @@ uint DeviceBase::renderSamples(const uint numSamples)
 {
     const uint samplesToDo{std::min(numSamples, uint{BufferLineSize})};
 
-    /* Clear main mixing buffers. */
-    for(FloatBufferLine &buffer : MixBuffer)
+    /* Clear main mixing buffers. Any partial mixes following them are left
+     * cleared after being summed.
+     */
+    for(FloatBufferLine &buffer : al::span{MixBuffer}.first(mMixChannels))
         buffer.fill(0.0f);
 
     {
         const auto mixLock = getWriteMixLock();
 
+        if(mOverrunSamples > 0) UNLIKELY
+            reportOverrun();
+
         /* Process and mix each context's sources and effects. */
         ProcessContexts(this, samplesToDo);
+        if(!LowOrder.Buffer.empty())
+            MixLowOrder(this, samplesToDo);
 
         /* Every second's worth of samples is converted and added to clock base
          * so that large sample counts don't overflow during conversion. This
@@ -2213,32 +3190,123 @@ uint DeviceBase::renderSamples(const uint numSamples)
     /* Apply any needed post-process for finalizing the Dry mix to the RealOut
      * (Ambisonic decode, UHJ encode, etc).
      */
+    auto stagetime = MixProfile::clock::now();
     postProcess(samplesToDo);
+    stagetime = mMixProfile.mark(MixStage::PostProcess, stagetime);
 
     /* Apply compression, limiting sample amplitude if needed or desired. */
-    if(Limiter) Limiter->process(samplesToDo, RealOut.Buffer);
+    if(Limiter)
+    {
+        Limiter->process(samplesToDo, RealOut.Buffer);
+        stagetime = mMixProfile.mark(MixStage::Limiter, stagetime);
+    }
 
     /* Apply delays and attenuation for mismatched speaker distances. */
     if(ChannelDelays)
+    {
         ApplyDistanceComp(RealOut.Buffer, samplesToDo, ChannelDelays->mChannels);
+        stagetime = mMixProfile.mark(MixStage::DistanceComp, stagetime);
+    }
 
     /* Apply dithering. The compressor should have left enough headroom for the
      * dither noise to not saturate.
      */
     if(DitherDepth > 0.0f)
+    {
         ApplyDither(RealOut.Buffer, &DitherSeed, DitherDepth, samplesToDo);
+        mMixProfile.mark(MixStage::Dither, stagetime);
+    }
 
     return samplesToDo;
 }
 
+void DeviceBase::reportOverrun()
+{
+    /* Report the overrun through the first context, which has the event
+     * thread to pass it on.
+     */
+    auto *contexts = mContexts.load(std::memory_order_acquire);
+    if(!contexts->empty())
+    {
+        RingBuffer *ring{contexts->front()->mAsyncEvents.get()};
+        auto evt_vec = ring->getWriteVector();
+        if(evt_vec[0].len > 0)
+        {
+            auto &evt = InitAsyncEvent<AsyncMixerOverrunEvent>(evt_vec[0].buf);
+            evt.mSamples = mOverrunSamples;
+            evt.mMixTime = mOverrunTime;
+            evt.mBudget = mOverrunBudget;
+            ring->writeAdvance(1);
+            contexts->front()->mEventSem.post();
+        }
+    }
+    mOverrunSamples = 0;
+}
+
+void DeviceBase::updateMixLoad(const uint numSamples, const nanoseconds mixTime)
+{
+    /* A mix is considered to be under a high load when it takes more than 80%
+     * of its real-time duration, and a low load when under 50%. The quality is
+     * lowered after 100ms of high load (or immediately with an overrun), and
+     * raised back after 2 seconds of low load.
+     */
+    static constexpr auto HighLoadScale = 4.0/5.0;
+    static constexpr auto LowLoadScale = 1.0/2.0;
+
+    /* Without a real-time clock, there's no deadline to track the load for. */
+    if(mOfflineRender)
+        return;
+
+    const auto budget = nanoseconds{seconds{numSamples}} / Frequency;
+    const bool overrun{mixTime > budget};
+    if(overrun) UNLIKELY
+    {
+        /* Report it with the next mix, when the contexts can be accessed. */
+        mOverrunSamples = numSamples;
+        mOverrunTime = mixTime;
+        mOverrunBudget = budget;
+    }
+
+    if(!mAdaptiveQuality)
+        return;
+
+    if(overrun || static_cast<double>(mixTime.count()) > budget.count()*HighLoadScale)
+    {
+        mLowLoadSamples = 0;
+        mHighLoadSamples += numSamples;
+        if((overrun || mHighLoadSamples >= Frequency/10) && mMixQuality < MixQuality::Lowest)
+        {
+            mMixQuality = static_cast<MixQuality>(al::to_underlying(mMixQuality) + 1);
+            mHighLoadSamples = 0;
+        }
+    }
+    else if(static_cast<double>(mixTime.count()) < budget.count()*LowLoadScale)
+    {
+        mHighLoadSamples = 0;
+        mLowLoadSamples += numSamples;
+        if(mLowLoadSamples >= Frequency*2 && mMixQuality > MixQuality::Full)
+        {
+            mMixQuality = static_cast<MixQuality>(al::to_underlying(mMixQuality) - 1);
+            mLowLoadSamples = 0;
+        }
+    }
+    else
+    {
+        mHighLoadSamples = 0;
+        mLowLoadSamples = 0;
+    }
+}
+
 void DeviceBase::renderSamples(const al::span<void*> outBuffers, const uint numSamples)
 {
     FPUCtl mixer_mode{};
     uint total{0};
     while(const uint todo{numSamples - total})
     {
+        const auto mixstart = MixProfile::clock::now();
         const uint samplesToDo{renderSamples(todo)};
 
+        const auto writestart = MixProfile::clock::now();
         switch(FmtType)
         {
 #define HANDLE_WRITE(T) case T:                                               \
@@ -2252,6 +3320,8 @@ void DeviceBase::renderSamples(const al::span<void*> outBuffers, const uint numS
         HANDLE_WRITE(DevFmtFloat)
         }
 #undef HANDLE_WRITE
+        updateMixLoad(samplesToDo, mMixProfile.mark(MixStage::Write, writestart) - mixstart);
+        mMixProfile.commit();
 
         total += samplesToDo;
     }
@@ -2263,10 +3333,12 @@ void DeviceBase::renderSamples(void *outBuffer, const uint numSamples, const siz
     uint total{0};
     while(const uint todo{numSamples - total})
     {
+        const auto mixstart = MixProfile::clock::now();
         const uint samplesToDo{renderSamples(todo)};
 
         if(outBuffer) LIKELY
         {
+            const auto writestart = MixProfile::clock::now();
             /* Finally, interleave and convert samples, writing to the device's
              * output buffer.
              */
@@ -2283,7 +3355,10 @@ void DeviceBase::renderSamples(void *outBuffer, const uint numSamples, const siz
             HANDLE_WRITE(DevFmtFloat)
 #undef HANDLE_WRITE
             }
+            mMixProfile.mark(MixStage::Write, writestart);
         }
+        updateMixLoad(samplesToDo, MixProfile::clock::now() - mixstart);
+        mMixProfile.commit();
 
         total += samplesToDo;
     }
@@ -2312,7 +3387,7 @@ void DeviceBase::doDisconnect(std::string msg)
 
             if(!ctx->mStopVoicesOnDisconnect.load())
             {
-                ProcessVoiceChanges(ctx);
+                ProcessVoiceChanges(ctx, getClockTime());
                 continue;
             }
 
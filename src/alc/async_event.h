@@ -2,6 +2,7 @@
 #define CORE_EVENT_H
 
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <variant>
@@ -17,6 +18,7 @@ enum class AsyncEnableBits : std::uint8_t {
     SourceState,
     BufferCompleted,
     Disconnected,
+    EffectSlotBufferReady,
     Count
 };
 
@@ -44,6 +46,12 @@ struct AsyncDisconnectEvent {
     std::string msg;
 };
 
+struct AsyncMixerOverrunEvent {
+    uint mSamples;
+    std::chrono::nanoseconds mMixTime;
+    std::chrono::nanoseconds mBudget;
+};
+
 struct AsyncEffectReleaseEvent {
     EffectState *mEffectState;
 };
@@ -52,6 +60,7 @@ using AsyncEvent = std::variant<AsyncKillThread,
         AsyncSourceStateEvent,
         AsyncBufferCompleteEvent,
         AsyncEffectReleaseEvent,
+        AsyncMixerOverrunEvent,
         AsyncDisconnectEvent>;
 
 template<typename T, typename ...Args>
@@ -1088,6 +1088,7 @@ alc::EventSupport CoreAudioBackendFactory::queryEventSupport(alc::EventType even
 
     case alc::EventType::DeviceAdded:
     case alc::EventType::DeviceRemoved:
+    case alc::EventType::MixerOverrun:
     case alc::EventType::Count:
         break;
     }
@@ -2306,6 +2306,7 @@ alc::EventSupport PipeWireBackendFactory::queryEventSupport(alc::EventType event
     case alc::EventType::DeviceRemoved:
         return alc::EventSupport::FullSupport;
 
+    case alc::EventType::MixerOverrun:
     case alc::EventType::Count:
         break;
     }
@@ -1506,6 +1506,7 @@ alc::EventSupport PulseBackendFactory::queryEventSupport(alc::EventType eventTyp
         return alc::EventSupport::FullSupport;
 
     case alc::EventType::DefaultDeviceChanged:
+    case alc::EventType::MixerOverrun:
     case alc::EventType::Count:
         break;
     }
@@ -2855,6 +2855,7 @@ alc::EventSupport WasapiBackendFactory::queryEventSupport(alc::EventType eventTy
         return alc::EventSupport::FullSupport;
 #endif
 
+    case alc::EventType::MixerOverrun:
     case alc::EventType::Count:
         break;
     }
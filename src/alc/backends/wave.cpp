@@ -23,6 +23,7 @@
 #include "wave.h"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cerrno>
 #include <chrono>
@@ -30,6 +31,7 @@
 #include <cstdio>
 #include <cstring>
 #include <exception>
+#include <memory>
 #include <system_error>
 #include <thread>
 #include <vector>
@@ -38,6 +40,8 @@
 #include "alc/alconfig.h"
 #include "almalloc.h"
 #include "alnumeric.h"
+#include "alsem.h"
+#include "alspan.h"
 #include "althrd_setname.h"
 #include "core/device.h"
 #include "core/logging.h"
@@ -60,6 +64,11 @@ struct FileDeleter {
 using FilePtr = std::unique_ptr<FILE,FileDeleter>;
 
 [[nodiscard]] constexpr auto GetDeviceName() noexcept { return "Wave File Writer"sv; }
+[[nodiscard]] constexpr auto GetOfflineDeviceName() noexcept
+{ return "Wave File Writer (Offline)"sv; }
+
+/* The length of each block rendered in offline mode, in milliseconds. */
+constexpr uint OfflineBlockMSec{250u};
 
 constexpr std::array<ubyte,16> SUBTYPE_PCM{{
     0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa,
@@ -93,12 +102,37 @@ void fwrite32le(uint val, FILE *f)
     fwrite(data.data(), 1, data.size(), f);
 }
 
+/* Converts the native-endian samples in the buffer to little-endian. */
+void SwapToLittleEndian(al::span<std::byte> buffer, const uint bytesize)
+{
+    if constexpr(al::endian::native != al::endian::little)
+    {
+        if(bytesize == 2)
+        {
+            const size_t len{buffer.size() & ~1_uz};
+            for(size_t i{0};i < len;i+=2)
+                std::swap(buffer[i], buffer[i+1]);
+        }
+        else if(bytesize == 4)
+        {
+            const size_t len{buffer.size() & ~3_uz};
+            for(size_t i{0};i < len;i+=4)
+            {
+                std::swap(buffer[i  ], buffer[i+3]);
+                std::swap(buffer[i+1], buffer[i+2]);
+            }
+        }
+    }
+}
+
 
 struct WaveBackend final : public BackendBase {
     WaveBackend(DeviceBase *device) noexcept : BackendBase{device} { }
     ~WaveBackend() override;
 
     int mixerProc();
+    int offlineProc();
+    void writerProc();
 
     void open(std::string_view name) override;
     bool reset() override;
@@ -110,6 +144,22 @@ struct WaveBackend final : public BackendBase {
 
     std::vector<std::byte> mBuffer;
 
+    /* In offline mode, the mixer renders as fast as it can without pacing to
+     * a real-time clock. Rendered blocks are double-buffered and handed to a
+     * writer thread, so the mixer can render the next block while the last is
+     * being written out.
+     */
+    bool mOffline{false};
+    uint mBlockSize{0u};
+    struct WriteBlock {
+        std::vector<std::byte> mData;
+        uint mFrames{0u};
+    };
+    std::array<WriteBlock,2> mBlocks;
+    al::semaphore mBlockFree{static_cast<uint>(std::tuple_size_v<decltype(mBlocks)>)};
+    al::semaphore mBlockReady;
+    std::atomic<bool> mWriteFailed{false};
+
     std::atomic<bool> mKillNow{true};
     std::thread mThread;
 };
@@ -145,26 +195,7 @@ int WaveBackend::mixerProc()
             mDevice->renderSamples(mBuffer.data(), mDevice->UpdateSize, frameStep);
             done += mDevice->UpdateSize;
 
-            if(al::endian::native != al::endian::little)
-            {
-                const uint bytesize{mDevice->bytesFromFmt()};
-
-                if(bytesize == 2)
-                {
-                    const size_t len{mBuffer.size() & ~1_uz};
-                    for(size_t i{0};i < len;i+=2)
-                        std::swap(mBuffer[i], mBuffer[i+1]);
-                }
-                else if(bytesize == 4)
-                {
-                    const size_t len{mBuffer.size() & ~3_uz};
-                    for(size_t i{0};i < len;i+=4)
-                    {
-                        std::swap(mBuffer[i  ], mBuffer[i+3]);
-                        std::swap(mBuffer[i+1], mBuffer[i+2]);
-                    }
-                }
-            }
+            SwapToLittleEndian(mBuffer, mDevice->bytesFromFmt());
 
             const size_t fs{fwrite(mBuffer.data(), frameSize, mDevice->UpdateSize, mFile.get())};
             if(fs < mDevice->UpdateSize || ferror(mFile.get()))
@@ -191,14 +222,95 @@ int WaveBackend::mixerProc()
     return 0;
 }
 
+int WaveBackend::offlineProc()
+{
+    althrd_setname(GetMixerThreadName());
+
+    std::thread writer;
+    try {
+        writer = std::thread{&WaveBackend::writerProc, this};
+    }
+    catch(std::exception &e) {
+        ERR("Failed to start writer thread: {}", e.what());
+        mDevice->handleDisconnect("Failed to start writer thread: {}", e.what());
+        return 1;
+    }
+
+    const size_t frameStep{mDevice->channelsFromFmt()};
+    const uint bytesize{mDevice->bytesFromFmt()};
+
+    size_t idx{0};
+    while(true)
+    {
+        mBlockFree.wait();
+        auto &block = mBlocks[idx];
+        idx = (idx+1) % mBlocks.size();
+
+        /* An empty block tells the writer to stop, once the preceding blocks
+         * are written.
+         */
+        if(mKillNow.load(std::memory_order_acquire)
+            || !mDevice->Connected.load(std::memory_order_acquire))
+        {
+            block.mFrames = 0;
+            mBlockReady.post();
+            break;
+        }
+        if(mWriteFailed.load(std::memory_order_acquire))
+        {
+            ERR("Error writing to file");
+            mDevice->handleDisconnect("Failed to write playback samples");
+            block.mFrames = 0;
+            mBlockReady.post();
+            break;
+        }
+
+        mDevice->renderSamples(block.mData.data(), mBlockSize, frameStep);
+        SwapToLittleEndian(block.mData, bytesize);
+        block.mFrames = mBlockSize;
+        mBlockReady.post();
+    }
+    writer.join();
+
+    return 0;
+}
+
+void WaveBackend::writerProc()
+{
+    const size_t frameSize{mDevice->frameSizeFromFmt()};
+
+    size_t idx{0};
+    while(true)
+    {
+        mBlockReady.wait();
+        auto &block = mBlocks[idx];
+        idx = (idx+1) % mBlocks.size();
+
+        const uint frames{block.mFrames};
+        if(frames > 0 && !mWriteFailed.load(std::memory_order_relaxed))
+        {
+            const size_t fs{fwrite(block.mData.data(), frameSize, frames, mFile.get())};
+            if(fs < frames || ferror(mFile.get()))
+                mWriteFailed.store(true, std::memory_order_release);
+        }
+        mBlockFree.post();
+
+        if(frames == 0)
+            break;
+    }
+}
+
 void WaveBackend::open(std::string_view name)
 {
     auto fname = ConfigValueStr({}, "wave", "file");
     if(!fname) throw al::backend_exception{al::backend_error::NoDevice,
         "No wave output filename"};
 
+    bool offline{GetConfigValueBool({}, "wave", "offline", false)};
     if(name.empty())
-        name = GetDeviceName();
+        name = offline ? GetOfflineDeviceName() : GetDeviceName();
+    else if(name == GetOfflineDeviceName())
+        offline = true;
     else if(name != GetDeviceName())
         throw al::backend_exception{al::backend_error::NoDevice, "Device name \"{}\" not found",
             name};
@@ -219,6 +331,10 @@ void WaveBackend::open(std::string_view name)
             *fname, std::generic_category().message(errno)};
 
     mDeviceName = name;
+    mOffline = offline;
+    mDevice->mOfflineRender = offline;
+    if(offline)
+        TRACE("Rendering to '{}' offline", *fname);
 }
 
 bool WaveBackend::reset()
@@ -331,8 +447,22 @@ bool WaveBackend::reset()
 
     setDefaultWFXChannelOrder();
 
-    const uint bufsize{mDevice->frameSizeFromFmt() * mDevice->UpdateSize};
-    mBuffer.resize(bufsize);
+    if(!mOffline)
+    {
+        const uint bufsize{mDevice->frameSizeFromFmt() * mDevice->UpdateSize};
+        mBuffer.resize(bufsize);
+    }
+    else
+    {
+        /* Render offline in much larger blocks than the update size, to cut
+         * down on the per-block overhead and the number of file writes.
+         */
+        const uint updates{std::max(mDevice->Frequency*OfflineBlockMSec/1000u
+            / mDevice->UpdateSize, 1u)};
+        mBlockSize = mDevice->UpdateSize * updates;
+        for(auto &block : mBlocks)
+            block.mData.resize(size_t{mDevice->frameSizeFromFmt()} * mBlockSize);
+    }
 
     return true;
 }
@@ -343,7 +473,9 @@ void WaveBackend::start()
         WARN("Failed to seek on output file");
     try {
         mKillNow.store(false, std::memory_order_release);
-        mThread = std::thread{&WaveBackend::mixerProc, this};
+        mWriteFailed.store(false, std::memory_order_relaxed);
+        mThread = std::thread{mOffline ? &WaveBackend::offlineProc : &WaveBackend::mixerProc,
+            this};
     }
     catch(std::exception& e) {
         throw al::backend_exception{al::backend_error::DeviceError,
@@ -385,7 +517,7 @@ auto WaveBackendFactory::enumerate(BackendType type) -> std::vector<std::string>
     switch(type)
     {
     case BackendType::Playback:
-        return std::vector{std::string{GetDeviceName()}};
+        return std::vector{std::string{GetDeviceName()}, std::string{GetOfflineDeviceName()}};
     case BackendType::Capture:
         break;
     }
@@ -3,3 +3,14 @@
 
 #include "buffer_storage.h"
 
+#include <atomic>
+
+
+namespace {
+
+std::atomic<std::uint64_t> NextGeneration{1u};
+
+} // namespace
+
+void BufferStorage::newGeneration() noexcept
+{ mGeneration = NextGeneration.fetch_add(1u, std::memory_order_relaxed); }
@@ -2,6 +2,7 @@
 #define CORE_BUFFER_STORAGE_H
 
 #include <cstddef>
+#include <cstdint>
 
 #include "alspan.h"
 #include "ambidefs.h"
@@ -50,6 +51,14 @@ struct BufferStorage {
     AmbiScaling mAmbiScaling{AmbiScaling::FuMa};
     uint mAmbiOrder{0u};
 
+    /* Identifies the current sample data, so anything prepared from it can
+     * tell when it's out of date. It's unique across all buffers, and gets a
+     * new value from newGeneration whenever the data may have changed.
+     */
+    std::uint64_t mGeneration{0u};
+
+    void newGeneration() noexcept;
+
     [[nodiscard]] auto bytesFromFmt() const noexcept -> uint { return BytesFromFmt(mType); }
     [[nodiscard]] auto channelsFromFmt() const noexcept -> uint
     { return ChannelsFromFmt(mChannels, mAmbiOrder); }
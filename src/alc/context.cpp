@@ -13,6 +13,7 @@
 #include "device.h"
 #include "effectslot.h"
 #include "logging.h"
+#include "paramcache.h"
 #include "ringbuffer.h"
 #include "voice.h"
 #include "voice_change.h"
@@ -23,6 +24,7 @@ static_assert(std::atomic<ContextBase::AsyncEventBitset>::is_always_lock_free, "
 #endif
 
 ContextBase::ContextBase(DeviceBase *device) : mDevice{device}
+    , mParamCache{std::make_unique<ParamCache>()}
 { assert(mEnabledEvts.is_lock_free()); }
 
 ContextBase::~ContextBase()
@@ -30,6 +32,17 @@ ContextBase::~ContextBase()
     mActiveAuxSlots.store(nullptr, std::memory_order_relaxed);
     mVoices.store(nullptr, std::memory_order_relaxed);
 
+    if(mParamCache)
+    {
+        const auto rhits = mParamCache->mResamplerHits.load(std::memory_order_relaxed);
+        const auto rmisses = mParamCache->mResamplerMisses.load(std::memory_order_relaxed);
+        const auto fhits = mParamCache->mFilterHits.load(std::memory_order_relaxed);
+        const auto fmisses = mParamCache->mFilterMisses.load(std::memory_order_relaxed);
+        if(rhits+rmisses > 0 || fhits+fmisses > 0)
+            TRACE("Parameter cache hits: resampler {}/{}, filter {}/{}", rhits, rhits+rmisses,
+                fhits, fhits+fmisses);
+    }
+
     if(mAsyncEvents)
     {
         size_t count{0};
@@ -107,7 +120,7 @@ void ContextBase::allocVoices(size_t addcount)
         --addcount;
     }
 
-    auto newarray = VoiceArray::Create(totalcount);
+    auto newarray = VoiceArray::Create(totalcount*2);
     auto voice_iter = newarray->begin();
     for(VoiceCluster &cluster : mVoiceClusters)
         voice_iter = std::transform(cluster->begin(), cluster->end(), voice_iter,
@@ -7,6 +7,8 @@
 #include <atomic>
 #include <bitset>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -17,15 +19,18 @@
 #include "atomic.h"
 #include "flexarray.h"
 #include "opthelpers.h"
+#include "source_command.h"
 #include "vecmat.h"
 
 struct DeviceBase;
 struct EffectSlot;
 struct EffectSlotProps;
+class ParamCache;
 struct RingBuffer;
 struct Voice;
 struct VoiceChange;
 struct VoicePropsItem;
+enum class MixQuality : std::uint8_t;
 
 
 inline constexpr float SpeedOfSoundMetersPerSec{343.3f};
@@ -50,6 +55,9 @@ struct ContextProps {
     float Gain;
     float MetersPerUnit;
     float AirAbsorptionGainHF;
+    float LowOrderDistance;
+    float LowOrderGain;
+    float UpdateTolerance;
 
     float DopplerFactor;
     float DopplerVelocity;
@@ -75,6 +83,17 @@ struct ContextParams {
     float MetersPerUnit{1.0f};
     float AirAbsorptionGainHF{AirAbsorbGainHF};
 
+    /* Sources at least this far from the listener, or quieter than this gain,
+     * get panned at first order by default.
+     */
+    float LowOrderDistance{std::numeric_limits<float>::max()};
+    float LowOrderGain{0.0f};
+
+    /* When non-0, listener updates only recalculate voices whose listener-
+     * relative geometry changed by more than this.
+     */
+    float UpdateTolerance{0.0f};
+
     float DopplerFactor{1.0f};
     float SpeedOfSound{SpeedOfSoundMetersPerSec}; /* in units per sec! */
 
@@ -117,10 +136,37 @@ struct ContextBase {
     ContextParams mParams;
 
     using VoiceArray = al::FlexArray<Voice*>;
+    /* This array is split in half. The front half is the list of allocated
+     * voices, and the back half is scratch space for the mixer to rank the
+     * active voices by loudness.
+     */
     al::atomic_unique_ptr<VoiceArray> mVoices;
     std::atomic<size_t> mActiveVoiceCount{};
 
+    /* The maximum number of voices to mix, or 0 for no limit. Voices past
+     * this, ranked by loudness, are made virtual.
+     */
+    unsigned int mAudibleVoiceLimit{0u};
+
+    /* Recently prepared resampler and filter parameters, for voices to reuse
+     * when calculating their parameters.
+     */
+    std::unique_ptr<ParamCache> mParamCache;
+
+    /* The device mixing quality the voice parameters were last calculated
+     * with. Only accessed by the mixer.
+     */
+    MixQuality mMixQuality{};
+
+    /* The number of voice parameter recalculations skipped for listener
+     * updates that didn't change the voice's geometry enough. Only written by
+     * the mixer, but atomic so it can be read by other threads.
+     */
+    std::atomic<std::uint64_t> mSkippedVoiceUpdates{0u};
+
     void allocVoices(size_t addcount);
+    [[nodiscard]] auto getVoiceCapacity() const noexcept -> size_t
+    { return mVoices.load(std::memory_order_relaxed)->size() >> 1; }
     [[nodiscard]] auto getVoicesSpan() const noexcept -> al::span<Voice*>
     {
         return {mVoices.load(std::memory_order_relaxed)->data(),
@@ -131,6 +177,11 @@ struct ContextBase {
         return {mVoices.load(std::memory_order_acquire)->data(),
             mActiveVoiceCount.load(std::memory_order_acquire)};
     }
+    [[nodiscard]] auto getVoiceRankSpanAcquired() const noexcept -> al::span<Voice*>
+    {
+        auto &voices = *mVoices.load(std::memory_order_acquire);
+        return al::span{voices}.last(voices.size()>>1);
+    }
 
 
     using EffectSlotArray = al::FlexArray<EffectSlot*>;
@@ -146,6 +197,28 @@ struct ContextBase {
     using AsyncEventBitset = std::bitset<al::to_underlying(AsyncEnableBits::Count)>;
     std::atomic<AsyncEventBitset> mEnabledEvts{0u};
 
+    /* When enabled, source play, pause, and stop commands from the app are
+     * queued without locking, to be applied in batches by the event thread.
+     * The pending flag is set when the event thread needs to be woken up to
+     * apply them. Source IDs are only checked when the commands are applied,
+     * and an invalid one is flagged for the app's next error query.
+     */
+    std::atomic<bool> mAsyncSourceCommands{false};
+    std::atomic<bool> mSourceCommandsPending{false};
+    std::atomic<bool> mSourceCommandInvalid{false};
+    SourceCommandQueue mSourceCommands;
+
+    /* One-shot sounds play on a pool of internal sources that aren't exposed
+     * to the app. The mixer passes back the IDs of finished one-shots through
+     * mOneShotsDone, and a limited number are kept in mFreeOneShots until
+     * reused. The ID lists are only accessed with the source lock held, while
+     * mNumOneShotSources mirrors the pool size for checking without it.
+     */
+    std::unique_ptr<RingBuffer> mOneShotsDone;
+    std::vector<unsigned int> mOneShotSources;
+    std::vector<unsigned int> mFreeOneShots;
+    std::atomic<std::size_t> mNumOneShotSources{0u};
+
     /* Asynchronous voice change actions are processed as a linked list of
      * VoiceChange objects by the mixer, which is atomically appended to.
      * However, to avoid allocating each object individually, they're allocated
@@ -35,6 +35,18 @@ inline std::array<reg_type,4> get_cpuid(unsigned int f)
     __get_cpuid(f, ret.data(), &ret[1], &ret[2], &ret[3]);
     return ret;
 }
+inline std::array<reg_type,4> get_cpuid_count(unsigned int f, unsigned int subf)
+{
+    std::array<reg_type,4> ret{};
+    __get_cpuid_count(f, subf, ret.data(), &ret[1], &ret[2], &ret[3]);
+    return ret;
+}
+inline unsigned long long get_xcr0()
+{
+    reg_type lo{}, hi{};
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0u));
+    return (static_cast<unsigned long long>(hi)<<32) | lo;
+}
 #define CAN_GET_CPUID
 #elif defined(HAVE_CPUID_INTRINSIC) \
     && (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
@@ -45,6 +57,14 @@ inline std::array<reg_type,4> get_cpuid(unsigned int f)
     (__cpuid)(ret.data(), f);
     return ret;
 }
+inline std::array<reg_type,4> get_cpuid_count(unsigned int f, unsigned int subf)
+{
+    std::array<reg_type,4> ret{};
+    (__cpuidex)(ret.data(), static_cast<int>(f), static_cast<int>(subf));
+    return ret;
+}
+inline unsigned long long get_xcr0()
+{ return _xgetbv(0); }
 #define CAN_GET_CPUID
 #endif
 
@@ -105,6 +125,20 @@ std::optional<CPUInfo> GetCPUInfo()
             ret.mCaps |= CPU_CAP_SSE3;
         if((ret.mCaps&CPU_CAP_SSE3) && (cpuregs[2]&(1<<19)))
             ret.mCaps |= CPU_CAP_SSE4_1;
+        /* AVX also needs the OS to preserve the upper halves of the YMM
+         * registers, which is indicated by OSXSAVE and the XCR0 register.
+         */
+        if((ret.mCaps&CPU_CAP_SSE4_1) && (cpuregs[2]&(1<<27)) && (cpuregs[2]&(1<<28))
+            && (get_xcr0()&0x6) == 0x6)
+            ret.mCaps |= CPU_CAP_AVX;
+        if((ret.mCaps&CPU_CAP_AVX) && (cpuregs[2]&(1<<12)))
+            ret.mCaps |= CPU_CAP_FMA3;
+    }
+    if(maxfunc >= 7 && (ret.mCaps&CPU_CAP_AVX))
+    {
+        cpuregs = get_cpuid_count(7, 0);
+        if((cpuregs[1]&(1<<5)))
+            ret.mCaps |= CPU_CAP_AVX2;
     }
 
 #else
@@ -122,6 +156,13 @@ std::optional<CPUInfo> GetCPUInfo()
 #elif HAVE_SSE
 #warning "Assuming SSE run-time support!"
     ret.mCaps |= CPU_CAP_SSE;
+#endif
+    /* Only assume AVX support if the compiler is already targeting it. */
+#if HAVE_AVX && defined(__AVX__)
+    ret.mCaps |= CPU_CAP_AVX;
+#endif
+#if HAVE_AVX2 && defined(__AVX2__) && defined(__FMA__)
+    ret.mCaps |= CPU_CAP_AVX2 | CPU_CAP_FMA3;
 #endif
 #endif /* CAN_GET_CPUID */
 
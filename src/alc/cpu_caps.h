@@ -12,6 +12,9 @@ enum {
     CPU_CAP_SSE3   = 1<<2,
     CPU_CAP_SSE4_1 = 1<<3,
     CPU_CAP_NEON   = 1<<4,
+    CPU_CAP_AVX    = 1<<5,
+    CPU_CAP_AVX2   = 1<<6,
+    CPU_CAP_FMA3   = 1<<7,
 };
 
 struct CPUInfo {
@@ -7,10 +7,12 @@
 #include "front_stablizer.h"
 #include "hrtf.h"
 #include "mastering.h"
+#include "workerpool.h"
 
 
 DeviceBase::DeviceBase(DeviceType type)
-    : Type{type}, mContexts{al::FlexArray<ContextBase*>::Create(0)}
+    : Type{type}, mOfflineRender{type == DeviceType::Loopback}
+    , mContexts{al::FlexArray<ContextBase*>::Create(0)}
 {
 }
 
@@ -1,6 +1,7 @@
 #ifndef CORE_DEVICE_H
 #define CORE_DEVICE_H
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <bitset>
@@ -17,9 +18,11 @@
 #include "bufferline.h"
 #include "devformat.h"
 #include "filters/nfc.h"
+#include "filters/splitter.h"
 #include "flexarray.h"
 #include "fmt/core.h"
 #include "intrusive_ptr.h"
+#include "mixer/defs.h"
 #include "mixer/hrtfdefs.h"
 #include "opthelpers.h"
 #include "resampler_limits.h"
@@ -34,6 +37,8 @@ class Compressor;
 struct ContextBase;
 struct DirectHrtfState;
 struct HrtfStore;
+struct Voice;
+class WorkerPool;
 
 using uint = unsigned int;
 
@@ -45,6 +50,13 @@ inline constexpr std::size_t DefaultOutputRate{48000};
 inline constexpr std::size_t DefaultUpdateSize{960}; /* 20ms */
 inline constexpr std::size_t DefaultNumUpdates{3};
 
+/* Number of partial mixes the voices are split between when mixing with
+ * worker threads. This is fixed regardless of the thread count, so the order
+ * the partial mixes are summed in, and thus the output, doesn't depend on the
+ * number of threads.
+ */
+inline constexpr uint MixerGroupCount{8};
+
 
 enum class DeviceType : std::uint8_t {
     Playback,
@@ -97,6 +109,97 @@ struct DistanceComp {
 };
 
 
+/* The stages of a mix the mixer keeps timing statistics for. */
+enum class MixStage : std::uint8_t {
+    ParamUpdates,
+    Voices,
+    Effects,
+    PostProcess,
+    Limiter,
+    DistanceComp,
+    Dither,
+    Write,
+};
+inline constexpr std::size_t MixStageCount{8};
+
+/* Timing statistics for each mixer stage, as the total and the longest time
+ * spent in it for a single mix. Only the mixer thread updates these, so they
+ * can use plain relaxed loads and stores to stay lock-free and cheap while
+ * still being safe to read from other threads.
+ */
+struct MixProfile {
+    using clock = std::chrono::steady_clock;
+
+    struct StageTimes {
+        std::atomic<std::uint64_t> mTotalNSec{0u};
+        std::atomic<std::uint64_t> mMaxNSec{0u};
+    };
+    std::array<StageTimes,MixStageCount> mStages{};
+    std::atomic<std::uint64_t> mMixCount{0u};
+
+    /* Time spent in each stage for the current mix. Only accessed by the
+     * mixer thread.
+     */
+    std::array<std::chrono::nanoseconds,MixStageCount> mCurrent{};
+
+    /**
+     * Adds the time since start to the given stage for the current mix, and
+     * returns the current time for timing the next stage.
+     */
+    auto mark(MixStage stage, const clock::time_point start) noexcept -> clock::time_point
+    {
+        const auto now = clock::now();
+        mCurrent[static_cast<std::size_t>(stage)] += now - start;
+        return now;
+    }
+
+    /* Adds the current mix's stage times to the statistics. */
+    void commit() noexcept
+    {
+        for(std::size_t i{0};i < MixStageCount;++i)
+        {
+            const auto nsec = static_cast<std::uint64_t>(mCurrent[i].count());
+            mCurrent[i] = std::chrono::nanoseconds{};
+
+            auto &stage = mStages[i];
+            stage.mTotalNSec.store(stage.mTotalNSec.load(std::memory_order_relaxed) + nsec,
+                std::memory_order_relaxed);
+            if(nsec > stage.mMaxNSec.load(std::memory_order_relaxed))
+                stage.mMaxNSec.store(nsec, std::memory_order_relaxed);
+        }
+        mMixCount.store(mMixCount.load(std::memory_order_relaxed) + 1u,
+            std::memory_order_relaxed);
+    }
+
+    /* Clears the statistics. The mixer must not be running. */
+    void reset() noexcept
+    {
+        for(auto &stage : mStages)
+        {
+            stage.mTotalNSec.store(0u, std::memory_order_relaxed);
+            stage.mMaxNSec.store(0u, std::memory_order_relaxed);
+        }
+        mMixCount.store(0u, std::memory_order_relaxed);
+        mCurrent.fill(std::chrono::nanoseconds{});
+    }
+};
+
+
+/* Reductions to the mixing quality the mixer can make to lower its processing
+ * load, in the order they get applied. Each level includes the reductions of
+ * the previous levels.
+ */
+enum class MixQuality : std::uint8_t {
+    Full,
+    CubicResampler,
+    LinearResampler,
+    ShortHrir,
+    DeferReverb,
+
+    Lowest = DeferReverb
+};
+
+
 constexpr auto InvalidChannelIndex = static_cast<std::uint8_t>(~0u);
 
 struct BFChannelConfig {
@@ -151,6 +254,47 @@ struct RealMixParams {
 
 using AmbiRotateMatrix = std::array<std::array<float,MaxAmbiChannels>,MaxAmbiChannels>;
 
+/* A voice's filtered stream (the direct path or a send of one channel) that's
+ * waiting to be filtered with other streams, along with what the voice needs
+ * to mix it afterward.
+ */
+struct PendingLaneMix {
+    Voice *mVoice;
+    uint mChannel;
+    uint mPath;
+    uint mCounter;
+    uint mOutPos;
+    uint mGroup;
+    bool mAudible;
+    bool mIsPlaying;
+};
+
+/* Temp storage used for mixing voices. Each thread mixing voices at the same
+ * time needs its own.
+ */
+struct MixerScratch {
+    static constexpr std::size_t MixerLineSize{BufferLineSize + DecoderBase::sMaxPadding};
+    static constexpr std::size_t MixerChannelsMax{16};
+
+    alignas(16) std::array<float,MixerLineSize*MixerChannelsMax> mSampleData{};
+    alignas(16) std::array<float,MixerLineSize+MaxResamplerPadding> mResampleData{};
+
+    /* Streams queued for the lane filters, which can come from different
+     * voices. Each stream's input is copied to its line of FilteredData to be
+     * filtered in place, so it outlives the voice's mix. All queued streams
+     * have mLaneSamples samples.
+     */
+    alignas(16) std::array<std::array<float,BufferLineSize>,FilterLaneCount> FilteredData{};
+    std::array<FilterLane,FilterLaneCount> mLanes{};
+    std::array<PendingLaneMix,FilterLaneCount> mLaneMixes{};
+    std::size_t mNumLanes{0};
+    uint mLaneSamples{0};
+    alignas(16) std::array<float,BufferLineSize+HrtfHistoryLength> ExtraSampleData{};
+
+    /* Persistent storage for HRTF mixing. */
+    alignas(16) std::array<float2,BufferLineSize+HrirLength> HrtfAccumData{};
+};
+
 enum {
     // Frequency was requested by the app or config file
     FrequencyRequest,
@@ -234,24 +378,76 @@ struct SIMDALIGN DeviceBase {
     AmbiRotateMatrix mAmbiRotateMatrix2{};
 
     /* Temp storage used for mixer processing. */
-    static constexpr std::size_t MixerLineSize{BufferLineSize + DecoderBase::sMaxPadding};
-    static constexpr std::size_t MixerChannelsMax{16};
-    alignas(16) std::array<float,MixerLineSize*MixerChannelsMax> mSampleData{};
-    alignas(16) std::array<float,MixerLineSize+MaxResamplerPadding> mResampleData{};
+    static constexpr std::size_t MixerLineSize{MixerScratch::MixerLineSize};
+    static constexpr std::size_t MixerChannelsMax{MixerScratch::MixerChannelsMax};
+    MixerScratch mScratch;
 
-    alignas(16) std::array<float,BufferLineSize> FilteredData{};
-    alignas(16) std::array<float,BufferLineSize+HrtfHistoryLength> ExtraSampleData{};
+    /* Mixing buffer used by the Dry mix and Real output. When mixing in
+     * groups, this is followed by mMixGroupCount copies that hold the partial
+     * mixes of each group.
+     */
+    al::vector<FloatBufferLine, 16> MixBuffer;
+    uint mMixChannels{0};
 
-    /* Persistent storage for HRTF mixing. */
-    alignas(16) std::array<float2,BufferLineSize+HrirLength> HrtfAccumData{};
+    /* Worker threads for mixing (null if mixing only on the mixer thread),
+     * and the number of groups the voices are split between (0 if mixing
+     * directly to the main mix). The groups are the same regardless of the
+     * number of threads. Each group has its own scratch storage, which
+     * includes its HRTF accumulation.
+     */
+    std::unique_ptr<WorkerPool> mMixerPool;
+    uint mMixGroupCount{0};
+    al::vector<MixerScratch, 16> mGroupScratch;
 
-    /* Mixing buffer used by the Dry mix and Real output. */
-    al::vector<FloatBufferLine, 16> MixBuffer;
+    /* Whether convolution effects should process the later parts of long
+     * impulse responses on background threads.
+     */
+    bool mAsyncConvolution{false};
+
+    /* Timing statistics for the mixer stages. */
+    MixProfile mMixProfile;
+
+    /* Whether to lower the mixing quality when the mixer has trouble keeping
+     * up in real-time, and restore it once the load drops.
+     */
+    bool mAdaptiveQuality{false};
+
+    /* Set for devices that aren't paced by a real-time clock (loopback devices
+     * and offline file output), which have no mixing deadline to overrun or to
+     * adapt the quality to.
+     */
+    bool mOfflineRender{false};
+
+    /* The current mixing quality, and how many samples have been mixed under a
+     * high or low load since the last change. Only accessed by the mixer
+     * thread.
+     */
+    MixQuality mMixQuality{MixQuality::Full};
+    uint mHighLoadSamples{0u};
+    uint mLowLoadSamples{0u};
+
+    /* The last overrun found after a mix, waiting to be reported at the start
+     * of the next mix (0 samples if none). The contexts may only be accessed
+     * with the mix lock held, so it can't be reported right away.
+     */
+    uint mOverrunSamples{0u};
+    std::chrono::nanoseconds mOverrunTime{};
+    std::chrono::nanoseconds mOverrunBudget{};
 
     /* The "dry" path corresponds to the main output. */
     MixParams Dry;
     std::array<uint,MaxAmbiOrder+1> NumChannelsPerOrder{};
 
+    /* First-order mix for voices panned at a lower order than the dry mix. It
+     * gets its HF scaled for the dry mix's order and is up-converted into it
+     * once per update. Empty when the dry mix isn't higher-order, or with HRTF
+     * where voices don't pan to it.
+     */
+    MixParams LowOrder;
+    std::array<std::array<float,MaxAmbiChannels>,4> mLowOrderGains{};
+    std::array<float,4> mLowOrderHFScales{};
+    std::array<BandSplitter,4> mLowOrderSplitters{};
+
     /* "Real" output, which will be written to the device buffer. May alias the
      * dry buffer.
      */
@@ -351,6 +547,14 @@ struct SIMDALIGN DeviceBase {
     void postProcess(const std::size_t SamplesToDo)
     { if(PostProcess) LIKELY (this->*PostProcess)(SamplesToDo); }
 
+    /** Returns the HRIR length to mix with, given the current mixing quality. */
+    [[nodiscard]] auto getMixIrSize(const uint irsize) const noexcept -> uint
+    {
+        if(mMixQuality < MixQuality::ShortHrir) LIKELY
+            return irsize;
+        return std::max((irsize/2u)&~3u, MinIrLength);
+    }
+
     void renderSamples(const al::span<void*> outBuffers, const uint numSamples);
     void renderSamples(void *outBuffer, const uint numSamples, const std::size_t frameStep);
 
@@ -371,6 +575,14 @@ struct SIMDALIGN DeviceBase {
 private:
     uint renderSamples(const uint numSamples);
 
+    /* Checks the time it took to mix the given number of samples against
+     * their real-time duration, reporting overruns and adjusting the mixing
+     * quality as needed.
+     */
+    void updateMixLoad(const uint numSamples, const std::chrono::nanoseconds mixTime);
+    /* Reports a pending overrun. Must be called with the mix lock held. */
+    void reportOverrun();
+
 protected:
     DeviceBase(DeviceType type);
     ~DeviceBase();
@@ -388,4 +600,7 @@ auto GetMixerThreadName() noexcept -> const char* { return "alsoft-mixer"; }
 [[nodiscard]] constexpr
 auto GetRecordThreadName() noexcept -> const char* { return "alsoft-record"; }
 
+[[nodiscard]] constexpr
+auto GetMixerWorkerThreadName() noexcept -> const char* { return "alsoft-mixwork"; }
+
 #endif /* CORE_DEVICE_H */
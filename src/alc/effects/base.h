@@ -1,8 +1,12 @@
 #ifndef EFFECTS_BASE_H
 #define EFFECTS_BASE_H
 
+#include <memory>
+
 #include "core/effects/base.h"
 
+struct BufferStorage;
+
 
 /* This is a user config option for modifying the overall output of the reverb
  * effect.
@@ -27,4 +31,11 @@ EffectStateFactory *DedicatedStateFactory_getFactory();
 
 EffectStateFactory *ConvolutionStateFactory_getFactory();
 
+/* Prepares the convolution filter for the buffer at the given device sample
+ * rate, without needing the device. A convolution state updated for the same
+ * buffer and rate while the returned pointer is held reuses it, instead of
+ * preparing it again.
+ */
+std::shared_ptr<void> PrepareConvolutionBuffer(const uint devrate, const BufferStorage *buffer);
+
 #endif /* EFFECTS_BASE_H */
@@ -4,13 +4,19 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <complex>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #if HAVE_SSE_INTRINSICS
@@ -23,7 +29,9 @@
 #include "almalloc.h"
 #include "alnumbers.h"
 #include "alnumeric.h"
+#include "alsem.h"
 #include "alspan.h"
+#include "althrd_setname.h"
 #include "base.h"
 #include "core/ambidefs.h"
 #include "core/bufferline.h"
@@ -35,6 +43,9 @@
 #include "core/effectslot.h"
 #include "core/filters/splitter.h"
 #include "core/fmt_traits.h"
+#include "core/fpu_ctrl.h"
+#include "core/helpers.h"
+#include "core/logging.h"
 #include "core/mixer.h"
 #include "core/uhjfilter.h"
 #include "intrusive_ptr.h"
@@ -79,6 +90,17 @@ namespace {
  * segment is applied directly in the time-domain as the samples come in. Once
  * enough have been retrieved, the FFT is applied on the input and it's paired
  * with the remaining (FFT'd) filter segments for processing.
+ *
+ * Long impulse responses would need a great many 128-sample segments, making
+ * the cost of each update grow with the length of the response. To avoid that,
+ * only the start of the response uses 128-sample segments. The rest is split
+ * into progressively larger segments, each size processed by a separate tail
+ * stage with its own FFT and input history that only updates once a whole
+ * block of its size has been collected. A stage with an N-sample block starts
+ * at 2*N samples into the response, so its output for a block isn't needed
+ * until N samples after the block is complete. This allows the stages to be
+ * processed on a background thread, which has until the stage's next block is
+ * ready to finish.
  */
 
 
@@ -167,6 +189,13 @@ using complex_f = std::complex<float>;
 constexpr size_t ConvolveUpdateSize{256};
 constexpr size_t ConvolveUpdateSamples{ConvolveUpdateSize / 2};
 
+/* The block sizes used for the tail stages. Each stage starts at twice its
+ * block size into the impulse response.
+ */
+constexpr std::array ConvolveTailSizes{1024_uz, 8192_uz};
+
+constexpr uint MaxConvolveAmbiOrder{1u};
+
 
 void apply_fir(al::span<float> dst, const al::span<const float> input, const al::span<const float,ConvolveUpdateSamples> filter)
 {
@@ -216,6 +245,537 @@ void apply_fir(al::span<float> dst, const al::span<const float> input, const al:
 }
 
 
+/* Applies a double-precision forward FFT to an impulse response segment, for
+ * more precise frequency measurements, and stores it for use with
+ * pffft_zconvolve_accumulate. The segment is silence-padded to the FFT length.
+ */
+void PrepareSegment(const PFFFTSetup &fft, const al::span<const double> segment,
+    const al::span<std::complex<double>> fftbuffer, const al::span<float> ffttmp, float *dst)
+{
+    const size_t fftsize{fftbuffer.size()};
+    const size_t halfsize{fftsize / 2};
+
+    auto iter = std::copy(segment.begin(), segment.end(), fftbuffer.begin());
+    std::fill(iter, fftbuffer.end(), std::complex<double>{});
+    forward_fft(fftbuffer);
+
+    /* Convert to, and pack in, a float buffer for PFFFT. Note that the first
+     * bin stores the real component of the half-frequency bin in the imaginary
+     * component. Also scale the FFT by its length so the iFFT'd output will be
+     * normalized.
+     */
+    const float fftscale{1.0f / static_cast<float>(fftsize)};
+    for(size_t i{0};i < halfsize;++i)
+    {
+        ffttmp[i*2    ] = static_cast<float>(fftbuffer[i].real()) * fftscale;
+        ffttmp[i*2 + 1] = static_cast<float>((i == 0) ? fftbuffer[halfsize].real()
+            : fftbuffer[i].imag()) * fftscale;
+    }
+    /* Reorder backward to make it suitable for pffft_zconvolve and the
+     * subsequent pffft_transform(..., PFFFT_BACKWARD).
+     */
+    fft.zreorder(ffttmp.data(), dst, PFFFT_BACKWARD);
+}
+
+
+/* An impulse response prepared for convolution at a given device sample rate.
+ * Preparing a response is fairly expensive, so they're cached and shared
+ * between the convolution effects using the same buffer data. The filter data
+ * is read-only once prepared.
+ */
+struct ConvolutionFilter {
+    std::atomic<uint> mRef{1u};
+
+    /* The buffer data and device properties this filter was prepared for. */
+    const BufferStorage *mBuffer{};
+    std::uint64_t mGeneration{};
+    FmtChannels mChannels{};
+    FmtType mType{};
+    uint mSampleRate{};
+    uint mSampleLen{};
+    uint mAmbiOrder{};
+    uint mDeviceRate{};
+
+    /* Set once the filter data below is prepared, or preparing it failed
+     * (leaving mNumChans as 0). Protected by LoadedFiltersLock.
+     */
+    bool mPrepared{false};
+
+    size_t mNumChans{};
+    /* The first segment of each channel's response, stored in reverse to
+     * apply as a time-domain FIR filter.
+     */
+    al::vector<std::array<float,ConvolveUpdateSamples>,16> mFir;
+    /* Each channel's FFT'd segments for the rest of the response's start. */
+    size_t mNumHeadSegs{};
+    al::vector<float,16> mHeadSegs;
+
+    /* Each channel's FFT'd segments for a tail stage. */
+    struct TailSegments {
+        size_t mBlockSize{};
+        size_t mNumSegs{};
+        al::vector<float,16> mSegments;
+    };
+    std::vector<TailSegments> mTails;
+
+    void add_ref() noexcept;
+    void dec_ref() noexcept;
+};
+using ConvolutionFilterPtr = al::intrusive_ptr<ConvolutionFilter>;
+
+/* The lock only guards the list and the filters' prepared state, and isn't
+ * held while preparing a filter. Users of a filter still being prepared wait
+ * on the condition variable.
+ */
+std::mutex LoadedFiltersLock;
+std::condition_variable LoadedFiltersCond;
+std::vector<std::unique_ptr<ConvolutionFilter>> LoadedFilters;
+
+void ConvolutionFilter::add_ref() noexcept
+{ IncrementRef(mRef); }
+
+void ConvolutionFilter::dec_ref() noexcept
+{
+    if(DecrementRef(mRef) == 0)
+    {
+        std::lock_guard<std::mutex> loadlock{LoadedFiltersLock};
+
+        /* Go through and remove all unused filters. */
+        auto remove_unused = [](const std::unique_ptr<ConvolutionFilter> &filter) -> bool
+        { return filter->mRef.load() == 0; };
+        auto iter = std::remove_if(LoadedFilters.begin(), LoadedFilters.end(), remove_unused);
+        LoadedFilters.erase(iter, LoadedFilters.end());
+    }
+}
+
+/* Prepares the filter data from the buffer's samples, for the device rate. */
+void PrepareFilter(ConvolutionFilter *filter, const uint devrate, const BufferStorage *buffer)
+{
+    using UhjDecoderType = UhjDecoder<512>;
+    static constexpr auto DecoderPadding = UhjDecoderType::sInputPadding;
+
+    const auto ambiOrder = std::min(buffer->mAmbiOrder, MaxConvolveAmbiOrder);
+    const auto realChannels = buffer->channelsFromFmt();
+    const auto numChannels = (buffer->mChannels == FmtUHJ2) ? 3u
+        : ChannelsFromFmt(buffer->mChannels, ambiOrder);
+
+    /* The impulse response needs to have the same sample rate as the input and
+     * output. The bsinc24 resampler is decent, but there is high-frequency
+     * attenuation that some people may be able to pick up on. Since this is
+     * called very infrequently, go ahead and use the polyphase resampler.
+     */
+    PPhaseResampler resampler;
+    if(devrate != buffer->mSampleRate)
+        resampler.init(buffer->mSampleRate, devrate);
+    const auto resampledCount = static_cast<uint>(
+        (uint64_t{buffer->mSampleLen}*devrate+(buffer->mSampleRate-1)) /
+        buffer->mSampleRate);
+
+    filter->mFir.resize(numChannels, {});
+
+    /* Calculate the number of segments needed to hold the start of the impulse
+     * response (rounded up), and allocate them. Exclude one segment which gets
+     * applied as a time-domain FIR filter. Make sure at least one segment is
+     * allocated to simplify handling.
+     */
+    const size_t headLength{std::min(size_t{resampledCount}, ConvolveTailSizes[0]*2)};
+    filter->mNumHeadSegs = (headLength+(ConvolveUpdateSamples-1)) / ConvolveUpdateSamples;
+    filter->mNumHeadSegs = std::max(filter->mNumHeadSegs, 2_uz) - 1_uz;
+    filter->mHeadSegs.resize(filter->mNumHeadSegs * ConvolveUpdateSize * numChannels, 0.0f);
+
+    /* The remainder of the impulse response is split between the tail stages,
+     * each one covering up to where the next one starts.
+     */
+    for(size_t i{0};i < ConvolveTailSizes.size();++i)
+    {
+        const size_t blocksize{ConvolveTailSizes[i]};
+        const size_t start{blocksize * 2};
+        if(resampledCount <= start)
+            break;
+
+        const size_t end{(i+1 < ConvolveTailSizes.size())
+            ? std::min(size_t{resampledCount}, ConvolveTailSizes[i+1]*2)
+            : size_t{resampledCount}};
+        auto &tail = filter->mTails.emplace_back();
+        tail.mBlockSize = blocksize;
+        tail.mNumSegs = (end-start + (blocksize-1)) / blocksize;
+        tail.mSegments.resize(tail.mNumSegs * blocksize*2 * numChannels, 0.0f);
+    }
+
+    /* Load the samples from the buffer. */
+    const size_t srclinelength{RoundUp(buffer->mSampleLen+DecoderPadding, 16)};
+    auto srcsamples = std::vector<float>(srclinelength * numChannels);
+    std::fill(srcsamples.begin(), srcsamples.end(), 0.0f);
+    for(size_t c{0};c < numChannels && c < realChannels;++c)
+        LoadSamples(al::span{srcsamples}.subspan(srclinelength*c, buffer->mSampleLen),
+            buffer->mData.data(), c, realChannels, buffer->mType);
+
+    if(IsUHJ(buffer->mChannels))
+    {
+        auto decoder = std::make_unique<UhjDecoderType>();
+        std::array<float*,4> samples{};
+        for(size_t c{0};c < numChannels;++c)
+            samples[c] = al::to_address(srcsamples.begin() + ptrdiff_t(srclinelength*c));
+        decoder->decode({samples.data(), numChannels}, buffer->mSampleLen, buffer->mSampleLen);
+    }
+
+    auto ressamples = std::vector<double>(buffer->mSampleLen + (resampler ? resampledCount : 0));
+    const size_t maxFftSize{filter->mTails.empty() ? ConvolveUpdateSize
+        : (filter->mTails.back().mBlockSize*2)};
+    auto ffttmp = al::vector<float,16>(maxFftSize);
+    auto fftbuffer = std::vector<std::complex<double>>(maxFftSize);
+
+    const PFFFTSetup headfft{ConvolveUpdateSize, PFFFT_REAL};
+    auto tailffts = std::vector<PFFFTSetup>{};
+    tailffts.reserve(filter->mTails.size());
+    for(auto &tail : filter->mTails)
+        tailffts.emplace_back(static_cast<uint>(tail.mBlockSize*2), PFFFT_REAL);
+
+    auto filteriter = filter->mHeadSegs.begin();
+    for(size_t c{0};c < numChannels;++c)
+    {
+        auto bufsamples = al::span{srcsamples}.subspan(srclinelength*c, buffer->mSampleLen);
+        /* Resample to match the device. */
+        if(resampler)
+        {
+            auto restmp = al::span{ressamples}.subspan(resampledCount, buffer->mSampleLen);
+            std::copy(bufsamples.cbegin(), bufsamples.cend(), restmp.begin());
+            resampler.process(restmp, al::span{ressamples}.first(resampledCount));
+        }
+        else
+            std::copy(bufsamples.cbegin(), bufsamples.cend(), ressamples.begin());
+        const auto irsamples = al::span{std::as_const(ressamples)}.first(resampledCount);
+
+        /* Store the first segment's samples in reverse in the time-domain, to
+         * apply as a FIR filter.
+         */
+        const size_t first_size{std::min(size_t{resampledCount}, ConvolveUpdateSamples)};
+        auto sampleseg = irsamples.first(first_size);
+        std::transform(sampleseg.begin(), sampleseg.end(), filter->mFir[c].rbegin(),
+            [](const double d) noexcept -> float { return static_cast<float>(d); });
+
+        size_t done{first_size};
+        for(size_t s{0};s < filter->mNumHeadSegs;++s)
+        {
+            const size_t todo{std::min(headLength-done, ConvolveUpdateSamples)};
+            PrepareSegment(headfft, irsamples.subspan(done, todo),
+                al::span{fftbuffer}.first(ConvolveUpdateSize),
+                al::span{ffttmp}.first(ConvolveUpdateSize), al::to_address(filteriter));
+            done += todo;
+            filteriter += ConvolveUpdateSize;
+        }
+
+        for(size_t i{0};i < filter->mTails.size();++i)
+        {
+            auto &tail = filter->mTails[i];
+            const size_t blocksize{tail.mBlockSize};
+            const size_t fftsize{blocksize * 2};
+            auto tailiter = tail.mSegments.begin() + ptrdiff_t(c*tail.mNumSegs*fftsize);
+            done = blocksize * 2;
+            for(size_t s{0};s < tail.mNumSegs;++s)
+            {
+                const size_t todo{std::min(resampledCount-done, blocksize)};
+                PrepareSegment(tailffts[i], irsamples.subspan(done, todo),
+                    al::span{fftbuffer}.first(fftsize), al::span{ffttmp}.first(fftsize),
+                    al::to_address(tailiter));
+                done += todo;
+                tailiter += ptrdiff_t(fftsize);
+            }
+        }
+    }
+
+    /* Only mark it usable once everything else is prepared. */
+    filter->mNumChans = numChannels;
+}
+
+/**
+ * Returns the prepared filter for the given buffer at the device sample rate,
+ * preparing it if a matching one isn't already loaded. The filter is prepared
+ * without holding the lock, so different filters can be prepared at the same
+ * time. A filter that failed to prepare has no channels.
+ */
+ConvolutionFilterPtr GetConvolutionFilter(const uint devrate, const BufferStorage *buffer)
+{
+
+    std::unique_lock<std::mutex> loadlock{LoadedFiltersLock};
+    auto matches = [devrate,buffer](const std::unique_ptr<ConvolutionFilter> &filter)
+    {
+        return filter->mBuffer == buffer && filter->mGeneration == buffer->mGeneration
+            && filter->mDeviceRate == devrate && filter->mChannels == buffer->mChannels
+            && filter->mType == buffer->mType && filter->mSampleRate == buffer->mSampleRate
+            && filter->mSampleLen == buffer->mSampleLen
+            && filter->mAmbiOrder == buffer->mAmbiOrder;
+    };
+    auto iter = std::find_if(LoadedFilters.begin(), LoadedFilters.end(), matches);
+    if(iter != LoadedFilters.end())
+    {
+        ConvolutionFilter *filter{iter->get()};
+        filter->add_ref();
+        LoadedFiltersCond.wait(loadlock, [filter]() noexcept { return filter->mPrepared; });
+        return ConvolutionFilterPtr{filter};
+    }
+
+    /* Add a pending entry for others to find, and prepare it unlocked. */
+    ConvolutionFilter *filter{LoadedFilters.emplace_back(
+        std::make_unique<ConvolutionFilter>()).get()};
+    filter->mBuffer = buffer;
+    filter->mGeneration = buffer->mGeneration;
+    filter->mChannels = buffer->mChannels;
+    filter->mType = buffer->mType;
+    filter->mSampleRate = buffer->mSampleRate;
+    filter->mSampleLen = buffer->mSampleLen;
+    filter->mAmbiOrder = buffer->mAmbiOrder;
+    filter->mDeviceRate = devrate;
+    loadlock.unlock();
+
+    try {
+        PrepareFilter(filter, devrate, buffer);
+        TRACE("Prepared {}-channel convolution filter for {}hz, {} head segment{}, {} tail "
+            "stage{}", filter->mNumChans, devrate, filter->mNumHeadSegs,
+            (filter->mNumHeadSegs==1)?"":"s", filter->mTails.size(),
+            (filter->mTails.size()==1)?"":"s");
+    }
+    catch(std::exception &e) {
+        ERR("Failed to prepare convolution filter: {}", e.what());
+    }
+
+    loadlock.lock();
+    /* Don't let a failed filter be found again. */
+    if(filter->mNumChans == 0)
+        filter->mBuffer = nullptr;
+    filter->mPrepared = true;
+    loadlock.unlock();
+    LoadedFiltersCond.notify_all();
+
+    return ConvolutionFilterPtr{filter};
+}
+
+
+/* A uniformly segmented convolver for a later part of the impulse response,
+ * using segments of mBlockSize samples. It takes input in 128-sample updates,
+ * and processes a block once enough have been collected, either on its own
+ * thread or spread over the updates until the next block is collected. The
+ * output is written to a ring buffer that holds three blocks, where the
+ * response to the block just collected is written to the two blocks after the
+ * one currently being read.
+ */
+struct ConvolveTail {
+    const size_t mBlockSize;
+    const size_t mNumSegs;
+    const size_t mNumChans;
+
+    /* Processing a block is split into steps: the forward FFT, then for each
+     * channel, one step per filter segment and one for the inverse FFT.
+     */
+    const size_t mNumSteps;
+    const size_t mStepsPerUpdate;
+    size_t mStep{0};
+
+    size_t mCurrentSegment{0};
+    size_t mInputPos{0};
+    /* The first output is read after the first update's input, so start the
+     * read position there to keep the ring buffer aligned with the blocks.
+     */
+    size_t mOutputPos{ConvolveUpdateSamples};
+    size_t mWritePos{0};
+
+    PFFFTSetup mFft;
+    al::vector<float,16> mInput;
+    /* The input block being processed, followed by silence. */
+    al::vector<float,16> mBlock;
+    al::vector<float,16> mFftBuffer;
+    al::vector<float,16> mFftWorkBuffer;
+    /* The FFT'd input history. */
+    al::vector<float,16> mComplexData;
+    /* Each channel's filter segments, from the shared filter. */
+    al::span<const float> mFilter;
+    /* Each channel's output ring buffer. */
+    al::vector<float,16> mOutput;
+
+    std::thread mThread;
+    al::semaphore mStartSem;
+    al::semaphore mDoneSem;
+    std::atomic<bool> mQuit{false};
+    bool mPending{false};
+
+    ConvolveTail(const ConvolutionFilter::TailSegments &filter, const size_t numchans)
+        : mBlockSize{filter.mBlockSize}, mNumSegs{filter.mNumSegs}, mNumChans{numchans}
+        , mNumSteps{1 + mNumChans*(mNumSegs+1)}
+        , mStepsPerUpdate{(mNumSteps*ConvolveUpdateSamples + mBlockSize-1) / mBlockSize}
+        , mFft{static_cast<uint>(mBlockSize*2), PFFFT_REAL}, mInput(mBlockSize, 0.0f)
+        , mBlock(mBlockSize*2, 0.0f), mFftBuffer(mBlockSize*2, 0.0f)
+        , mFftWorkBuffer(mBlockSize*2, 0.0f), mComplexData(mNumSegs*mBlockSize*2, 0.0f)
+        , mFilter{filter.mSegments}, mOutput(numchans*mBlockSize*3, 0.0f)
+    { }
+    ConvolveTail(const ConvolveTail&) = delete;
+    ~ConvolveTail();
+
+    ConvolveTail& operator=(const ConvolveTail&) = delete;
+
+    void startThread();
+    void threadProc();
+    bool convolve(size_t numsteps) noexcept;
+
+    void addInput(const al::span<const float,ConvolveUpdateSamples> input);
+    void mixOutput(const al::span<std::array<float,ConvolveUpdateSamples*2>> output) noexcept;
+};
+
+ConvolveTail::~ConvolveTail()
+{
+    if(!mThread.joinable())
+        return;
+    mQuit.store(true, std::memory_order_release);
+    mStartSem.post();
+    mThread.join();
+}
+
+void ConvolveTail::startThread()
+{
+    try {
+        mThread = std::thread{&ConvolveTail::threadProc, this};
+    }
+    catch(std::exception &e) {
+        ERR("Failed to start convolution thread: {}", e.what());
+    }
+}
+
+void ConvolveTail::threadProc()
+{
+    SetRTPriority();
+    althrd_setname("alsoft-convolve");
+
+    FPUCtl mixer_mode{};
+    while(true)
+    {
+        mStartSem.wait();
+        if(mQuit.load(std::memory_order_acquire))
+            break;
+
+        convolve(mNumSteps);
+        mDoneSem.post();
+    }
+}
+
+/* Runs up to the given number of steps for the block being processed, and
+ * returns true once the block is done.
+ */
+bool ConvolveTail::convolve(size_t numsteps) noexcept
+{
+    const size_t fftsize{mBlockSize * 2};
+    const size_t ringsize{mBlockSize * 3};
+    const size_t curseg{mCurrentSegment};
+
+    for(;numsteps > 0 && mStep < mNumSteps;--numsteps,++mStep)
+    {
+        if(mStep == 0)
+        {
+            mFft.transform(mBlock.data(), &mComplexData[curseg*fftsize], mFftWorkBuffer.data(),
+                PFFFT_FORWARD);
+            continue;
+        }
+
+        const size_t c{(mStep-1) / (mNumSegs+1)};
+        const size_t seg{(mStep-1) % (mNumSegs+1)};
+        if(seg < mNumSegs)
+        {
+            /* Apply the filter segments from newest to oldest input. */
+            if(seg == 0)
+                std::fill(mFftBuffer.begin(), mFftBuffer.end(), 0.0f);
+            size_t inseg{curseg + seg};
+            if(inseg >= mNumSegs) inseg -= mNumSegs;
+            const auto input = mComplexData.cbegin() + ptrdiff_t(inseg*fftsize);
+            const auto filter = mFilter.begin() + ptrdiff_t((c*mNumSegs + seg)*fftsize);
+            mFft.zconvolve_accumulate(al::to_address(input), al::to_address(filter),
+                mFftBuffer.data());
+            continue;
+        }
+
+        mFft.transform(mFftBuffer.data(), mFftBuffer.data(), mFftWorkBuffer.data(),
+            PFFFT_BACKWARD);
+
+        /* The write position is block-aligned, so each half of the response
+         * is contiguous in the ring buffer.
+         */
+        const auto ring = al::span{mOutput}.subspan(c*ringsize, ringsize);
+        auto fftiter = mFftBuffer.cbegin();
+        size_t pos{mWritePos};
+        for(size_t i{0};i < 2;++i)
+        {
+            const auto dst = ring.subspan(pos, mBlockSize);
+            std::transform(fftiter, fftiter+ptrdiff_t(mBlockSize), dst.begin(), dst.begin(),
+                std::plus{});
+            fftiter += ptrdiff_t(mBlockSize);
+            pos += mBlockSize;
+            if(pos == ringsize) pos = 0;
+        }
+    }
+    if(mStep < mNumSteps)
+        return false;
+
+    mCurrentSegment = curseg ? (curseg-1) : (mNumSegs-1);
+    return true;
+}
+
+void ConvolveTail::addInput(const al::span<const float,ConvolveUpdateSamples> input)
+{
+    std::copy(input.begin(), input.end(), mInput.begin()+ptrdiff_t(mInputPos));
+    mInputPos += input.size();
+    if(mInputPos < mBlockSize)
+    {
+        /* Without a thread, continue processing the previous block a bit each
+         * update, so the load is even instead of spiking once per block.
+         */
+        if(mPending && !mThread.joinable())
+            mPending = !convolve(mStepsPerUpdate);
+        return;
+    }
+    mInputPos = 0;
+
+    /* The previous block's response starts being read after this, so it needs
+     * to be finished before taking the new block.
+     */
+    if(mPending)
+    {
+        if(mThread.joinable())
+            mDoneSem.wait();
+        else
+            convolve(mNumSteps);
+        mPending = false;
+    }
+
+    std::copy(mInput.cbegin(), mInput.cend(), mBlock.begin());
+    mWritePos = mOutputPos + mBlockSize;
+    if(mWritePos >= mBlockSize*3)
+        mWritePos -= mBlockSize*3;
+    mStep = 0;
+
+    if(mThread.joinable())
+    {
+        mPending = true;
+        mStartSem.post();
+    }
+    else
+        mPending = !convolve(mStepsPerUpdate);
+}
+
+void ConvolveTail::mixOutput(const al::span<std::array<float,ConvolveUpdateSamples*2>> output)
+    noexcept
+{
+    const size_t ringsize{mBlockSize * 3};
+    for(size_t c{0};c < mNumChans;++c)
+    {
+        const auto ring = al::span{mOutput}.subspan(c*ringsize + mOutputPos,
+            ConvolveUpdateSamples);
+        std::transform(ring.cbegin(), ring.cend(), output[c].cbegin(), output[c].begin(),
+            std::plus{});
+        std::fill(ring.begin(), ring.end(), 0.0f);
+    }
+    mOutputPos += ConvolveUpdateSamples;
+    if(mOutputPos == ringsize)
+        mOutputPos = 0;
+}
+
+
 struct ConvolutionState final : public EffectState {
     FmtChannels mChannels{};
     AmbiLayout mAmbiLayout{};
@@ -224,9 +784,10 @@ struct ConvolutionState final : public EffectState {
 
     size_t mFifoPos{0};
     alignas(16) std::array<float,ConvolveUpdateSamples*2> mInput{};
-    al::vector<std::array<float,ConvolveUpdateSamples>,16> mFilter;
     al::vector<std::array<float,ConvolveUpdateSamples*2>,16> mOutput;
 
+    ConvolutionFilterPtr mFilter;
+
     PFFFTSetup mFft;
     alignas(16) std::array<float,ConvolveUpdateSize> mFftBuffer{};
     alignas(16) std::array<float,ConvolveUpdateSize> mFftWorkBuffer{};
@@ -242,8 +803,11 @@ struct ConvolutionState final : public EffectState {
         std::array<float,MaxOutputChannels> Target{};
     };
     std::vector<ChannelData> mChans;
+    /* The FFT'd input history. */
     al::vector<float,16> mComplexData;
 
+    std::vector<std::unique_ptr<ConvolveTail>> mTails;
+
 
     ConvolutionState() = default;
     ~ConvolutionState() override = default;
@@ -282,17 +846,11 @@ void ConvolutionState::UpsampleMix(const al::span<FloatBufferLine> samplesOut,
 
 void ConvolutionState::deviceUpdate(const DeviceBase *device, const BufferStorage *buffer)
 {
-    using UhjDecoderType = UhjDecoder<512>;
-    static constexpr auto DecoderPadding = UhjDecoderType::sInputPadding;
-
-    static constexpr uint MaxConvolveAmbiOrder{1u};
-
     if(!mFft)
         mFft = PFFFTSetup{ConvolveUpdateSize, PFFFT_REAL};
 
     mFifoPos = 0;
     mInput.fill(0.0f);
-    decltype(mFilter){}.swap(mFilter);
     decltype(mOutput){}.swap(mOutput);
     mFftBuffer.fill(0.0f);
     mFftWorkBuffer.fill(0.0f);
@@ -302,125 +860,50 @@ void ConvolutionState::deviceUpdate(const DeviceBase *device, const BufferStorag
 
     decltype(mChans){}.swap(mChans);
     decltype(mComplexData){}.swap(mComplexData);
+    decltype(mTails){}.swap(mTails);
 
     /* An empty buffer doesn't need a convolution filter. */
-    if(!buffer || buffer->mSampleLen < 1) return;
+    if(!buffer || buffer->mSampleLen < 1)
+    {
+        mFilter = nullptr;
+        return;
+    }
+
+    /* Get the new filter before releasing the old one, so a device reset can
+     * keep using the same filter if the sample rate didn't change.
+     */
+    mFilter = GetConvolutionFilter(device->Frequency, buffer);
+    if(mFilter->mNumChans == 0)
+    {
+        mFilter = nullptr;
+        return;
+    }
 
     mChannels = buffer->mChannels;
     mAmbiLayout = IsUHJ(mChannels) ? AmbiLayout::FuMa : buffer->mAmbiLayout;
     mAmbiScaling = IsUHJ(mChannels) ? AmbiScaling::UHJ : buffer->mAmbiScaling;
     mAmbiOrder = std::min(buffer->mAmbiOrder, MaxConvolveAmbiOrder);
 
-    const auto realChannels = buffer->channelsFromFmt();
-    const auto numChannels = (mChannels == FmtUHJ2) ? 3u : ChannelsFromFmt(mChannels, mAmbiOrder);
-
+    const auto numChannels = mFilter->mNumChans;
     mChans.resize(numChannels);
 
-    /* The impulse response needs to have the same sample rate as the input and
-     * output. The bsinc24 resampler is decent, but there is high-frequency
-     * attenuation that some people may be able to pick up on. Since this is
-     * called very infrequently, go ahead and use the polyphase resampler.
-     */
-    PPhaseResampler resampler;
-    if(device->Frequency != buffer->mSampleRate)
-        resampler.init(buffer->mSampleRate, device->Frequency);
-    const auto resampledCount = static_cast<uint>(
-        (uint64_t{buffer->mSampleLen}*device->Frequency+(buffer->mSampleRate-1)) /
-        buffer->mSampleRate);
-
     const BandSplitter splitter{device->mXOverFreq / static_cast<float>(device->Frequency)};
     for(auto &e : mChans)
         e.mFilter = splitter;
 
-    mFilter.resize(numChannels, {});
     mOutput.resize(numChannels, {});
 
-    /* Calculate the number of segments needed to hold the impulse response and
-     * the input history (rounded up), and allocate them. Exclude one segment
-     * which gets applied as a time-domain FIR filter. Make sure at least one
-     * segment is allocated to simplify handling.
-     */
-    mNumConvolveSegs = (resampledCount+(ConvolveUpdateSamples-1)) / ConvolveUpdateSamples;
-    mNumConvolveSegs = std::max(mNumConvolveSegs, 2_uz) - 1_uz;
+    /* Allocate the input history for the filter segments. */
+    mNumConvolveSegs = mFilter->mNumHeadSegs;
+    mComplexData.resize(mNumConvolveSegs * ConvolveUpdateSize, 0.0f);
 
-    const size_t complex_length{mNumConvolveSegs * ConvolveUpdateSize * (numChannels+1)};
-    mComplexData.resize(complex_length, 0.0f);
+    for(auto &tail : mFilter->mTails)
+        mTails.emplace_back(std::make_unique<ConvolveTail>(tail, numChannels));
 
-    /* Load the samples from the buffer. */
-    const size_t srclinelength{RoundUp(buffer->mSampleLen+DecoderPadding, 16)};
-    auto srcsamples = std::vector<float>(srclinelength * numChannels);
-    std::fill(srcsamples.begin(), srcsamples.end(), 0.0f);
-    for(size_t c{0};c < numChannels && c < realChannels;++c)
-        LoadSamples(al::span{srcsamples}.subspan(srclinelength*c, buffer->mSampleLen),
-            buffer->mData.data(), c, realChannels, buffer->mType);
-
-    if(IsUHJ(mChannels))
+    if(device->mAsyncConvolution)
     {
-        auto decoder = std::make_unique<UhjDecoderType>();
-        std::array<float*,4> samples{};
-        for(size_t c{0};c < numChannels;++c)
-            samples[c] = al::to_address(srcsamples.begin() + ptrdiff_t(srclinelength*c));
-        decoder->decode({samples.data(), numChannels}, buffer->mSampleLen, buffer->mSampleLen);
-    }
-
-    auto ressamples = std::vector<double>(buffer->mSampleLen + (resampler ? resampledCount : 0));
-    auto ffttmp = al::vector<float,16>(ConvolveUpdateSize);
-    auto fftbuffer = std::vector<std::complex<double>>(ConvolveUpdateSize);
-
-    auto filteriter = mComplexData.begin() + ptrdiff_t(mNumConvolveSegs*ConvolveUpdateSize);
-    for(size_t c{0};c < numChannels;++c)
-    {
-        auto bufsamples = al::span{srcsamples}.subspan(srclinelength*c, buffer->mSampleLen);
-        /* Resample to match the device. */
-        if(resampler)
-        {
-            auto restmp = al::span{ressamples}.subspan(resampledCount, buffer->mSampleLen);
-            std::copy(bufsamples.cbegin(), bufsamples.cend(), restmp.begin());
-            resampler.process(restmp, al::span{ressamples}.first(resampledCount));
-        }
-        else
-            std::copy(bufsamples.cbegin(), bufsamples.cend(), ressamples.begin());
-
-        /* Store the first segment's samples in reverse in the time-domain, to
-         * apply as a FIR filter.
-         */
-        const size_t first_size{std::min(size_t{resampledCount}, ConvolveUpdateSamples)};
-        auto sampleseg = al::span{ressamples.cbegin(), first_size};
-        std::transform(sampleseg.cbegin(), sampleseg.cend(), mFilter[c].rbegin(),
-            [](const double d) noexcept -> float { return static_cast<float>(d); });
-
-        size_t done{first_size};
-        for(size_t s{0};s < mNumConvolveSegs;++s)
-        {
-            const size_t todo{std::min(resampledCount-done, ConvolveUpdateSamples)};
-            sampleseg = al::span{ressamples}.subspan(done, todo);
-
-            /* Apply a double-precision forward FFT for more precise frequency
-             * measurements.
-             */
-            auto iter = std::copy(sampleseg.cbegin(), sampleseg.cend(), fftbuffer.begin());
-            done += todo;
-            std::fill(iter, fftbuffer.end(), std::complex<double>{});
-            forward_fft(al::span{fftbuffer});
-
-            /* Convert to, and pack in, a float buffer for PFFFT. Note that the
-             * first bin stores the real component of the half-frequency bin in
-             * the imaginary component. Also scale the FFT by its length so the
-             * iFFT'd output will be normalized.
-             */
-            static constexpr float fftscale{1.0f / float{ConvolveUpdateSize}};
-            for(size_t i{0};i < ConvolveUpdateSamples;++i)
-            {
-                ffttmp[i*2    ] = static_cast<float>(fftbuffer[i].real()) * fftscale;
-                ffttmp[i*2 + 1] = static_cast<float>((i == 0) ?
-                    fftbuffer[ConvolveUpdateSamples].real() : fftbuffer[i].imag()) * fftscale;
-            }
-            /* Reorder backward to make it suitable for pffft_zconvolve and the
-             * subsequent pffft_transform(..., PFFFT_BACKWARD).
-             */
-            mFft.zreorder(ffttmp.data(), al::to_address(filteriter), PFFFT_BACKWARD);
-            filteriter += ConvolveUpdateSize;
-        }
+        for(auto &tail : mTails)
+            tail->startThread();
     }
 }
 
@@ -646,7 +1129,7 @@ void ConvolutionState::process(const size_t samplesToDo,
         for(size_t c{0};c < mChans.size();++c)
         {
             auto outspan = al::span{mChans[c].mBuffer}.subspan(base, todo);
-            apply_fir(outspan, al::span{mInput}.subspan(1+mFifoPos), mFilter[c]);
+            apply_fir(outspan, al::span{mInput}.subspan(1+mFifoPos), mFilter->mFir[c]);
 
             auto fifospan = al::span{mOutput[c]}.subspan(mFifoPos, todo);
             std::transform(fifospan.cbegin(), fifospan.cend(), outspan.cbegin(), outspan.begin(),
@@ -670,7 +1153,7 @@ void ConvolutionState::process(const size_t samplesToDo,
         mFft.transform(mInput.data(), &mComplexData[curseg*ConvolveUpdateSize],
             mFftWorkBuffer.data(), PFFFT_FORWARD);
 
-        auto filter = mComplexData.cbegin() + ptrdiff_t(mNumConvolveSegs*ConvolveUpdateSize);
+        auto filter = mFilter->mHeadSegs.cbegin();
         for(size_t c{0};c < mChans.size();++c)
         {
             /* Convolve each input segment with its IR filter counterpart
@@ -711,6 +1194,15 @@ void ConvolutionState::process(const size_t samplesToDo,
 
         /* Shift the input history. */
         curseg = curseg ? (curseg-1) : (mNumConvolveSegs-1);
+
+        /* Give the new input to the tail stages, and add their output for the
+         * next update.
+         */
+        for(auto &tail : mTails)
+        {
+            tail->addInput(al::span{mInput}.first<ConvolveUpdateSamples>());
+            tail->mixOutput(mOutput);
+        }
     }
     mCurrentSegment = curseg;
 
@@ -731,3 +1223,14 @@ EffectStateFactory *ConvolutionStateFactory_getFactory()
     static ConvolutionStateFactory ConvolutionFactory{};
     return &ConvolutionFactory;
 }
+
+std::shared_ptr<void> PrepareConvolutionBuffer(const uint devrate, const BufferStorage *buffer)
+{
+    if(!buffer || buffer->mSampleLen < 1)
+        return nullptr;
+
+    /* Hold the filter's reference with the returned pointer. */
+    ConvolutionFilter *filter{GetConvolutionFilter(devrate, buffer).release()};
+    return std::shared_ptr<void>{filter, [](void *ptr) noexcept
+        { static_cast<ConvolutionFilter*>(ptr)->dec_ref(); }};
+}
@@ -62,6 +62,11 @@ struct EffectSlot {
     float Gain{1.0f};
     bool  AuxSendAuto{true};
     EffectSlot *Target{nullptr};
+    /* Number of target slots between this slot and the main output. Slots
+     * with the same depth don't feed each other, so can be processed at the
+     * same time.
+     */
+    uint mTargetDepth{0u};
 
     EffectSlotType EffectType{EffectSlotType::None};
     EffectProps mEffectProps;
@@ -74,8 +79,17 @@ struct EffectSlot {
     bool DecayHFLimit{false};
     float AirAbsorptionGainHF{1.0f};
 
+    /* Set by the mixer when a property update changes the values above that
+     * voices use to send to this slot, until the voices are recalculated.
+     */
+    bool mSendParamsChanged{false};
+
     /* Mixing buffer used by the Wet mix. */
     al::vector<FloatBufferLine,16> mWetBuffer;
+    /* Private output used when processed alongside other slots, added to the
+     * effect's output target afterward.
+     */
+    al::vector<FloatBufferLine,16> mOutputBuffer;
 
 
     static std::unique_ptr<EffectSlotArray> CreatePtrArray(size_t count);
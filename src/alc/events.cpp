@@ -19,6 +19,7 @@ ALCenum EnumFromEventType(const alc::EventType type)
     case alc::EventType::DefaultDeviceChanged: return ALC_EVENT_TYPE_DEFAULT_DEVICE_CHANGED_SOFT;
     case alc::EventType::DeviceAdded: return ALC_EVENT_TYPE_DEVICE_ADDED_SOFT;
     case alc::EventType::DeviceRemoved: return ALC_EVENT_TYPE_DEVICE_REMOVED_SOFT;
+    case alc::EventType::MixerOverrun: return ALC_EVENT_TYPE_MIXER_OVERRUN_SOFT;
     case alc::EventType::Count: break;
     }
     throw std::runtime_error{fmt::format("Invalid EventType: {}", int{al::to_underlying(type)})};
@@ -35,6 +36,7 @@ std::optional<alc::EventType> GetEventType(ALCenum type)
     case ALC_EVENT_TYPE_DEFAULT_DEVICE_CHANGED_SOFT: return alc::EventType::DefaultDeviceChanged;
     case ALC_EVENT_TYPE_DEVICE_ADDED_SOFT: return alc::EventType::DeviceAdded;
     case ALC_EVENT_TYPE_DEVICE_REMOVED_SOFT: return alc::EventType::DeviceRemoved;
+    case ALC_EVENT_TYPE_MIXER_OVERRUN_SOFT: return alc::EventType::MixerOverrun;
     }
     return std::nullopt;
 }
@@ -16,6 +16,7 @@ enum class EventType : uint8_t {
     DefaultDeviceChanged,
     DeviceAdded,
     DeviceRemoved,
+    MixerOverrun,
 
     Count
 };
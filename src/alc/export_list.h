@@ -206,10 +206,19 @@ inline const FuncExport alcFunctions[]{
 
     DECL(alSourcePlayAtTimeSOFT),
     DECL(alSourcePlayAtTimevSOFT),
+    DECL(alSourceStopAtTimeSOFT),
+    DECL(alSourceStopAtTimevSOFT),
+    DECL(alSourceGainRampSOFT),
+    DECL(alSourceGainRampvSOFT),
+
+    DECL(alSourcePropsvSOFT),
+    DECL(alPlayBufferOneShotSOFT),
 
     DECL(alBufferSubDataSOFT),
 
     DECL(alBufferDataStatic),
+    DECL(alBufferDataFileSOFT),
+    DECL(alBufferDataFdSOFT),
 
     DECL(alDebugMessageCallbackEXT),
     DECL(alDebugMessageInsertEXT),
@@ -340,6 +349,8 @@ inline const FuncExport alcFunctions[]{
     DECL(alGetStringiDirectSOFT),
 
     DECL(alBufferDataStaticDirect),
+    DECL(alBufferDataFileDirectSOFT),
+    DECL(alBufferDataFdDirectSOFT),
     DECL(alBufferCallbackDirectSOFT),
     DECL(alBufferSubDataDirectSOFT),
     DECL(alBufferStorageDirectSOFT),
@@ -361,6 +372,12 @@ inline const FuncExport alcFunctions[]{
     DECL(alGetSourcedvDirectSOFT),
     DECL(alSourcePlayAtTimeDirectSOFT),
     DECL(alSourcePlayAtTimevDirectSOFT),
+    DECL(alSourceStopAtTimeDirectSOFT),
+    DECL(alSourceStopAtTimevDirectSOFT),
+    DECL(alSourceGainRampDirectSOFT),
+    DECL(alSourceGainRampvDirectSOFT),
+    DECL(alSourcePropsvDirectSOFT),
+    DECL(alPlayBufferOneShotDirectSOFT),
 
     DECL(alEventControlDirectSOFT),
     DECL(alEventCallbackDirectSOFT),
@@ -485,6 +502,9 @@ inline const EnumExport alcEnumerations[]{
     DECL(ALC_SURROUND_6_1_SOFT),
     DECL(ALC_SURROUND_7_1_SOFT),
 
+    DECL(ALC_MIXER_PROFILE_SIZE_SOFT),
+    DECL(ALC_MIXER_PROFILE_SOFT),
+
     DECL(ALC_NO_ERROR),
     DECL(ALC_INVALID_DEVICE),
     DECL(ALC_INVALID_CONTEXT),
@@ -500,6 +520,7 @@ inline const EnumExport alcEnumerations[]{
     DECL(ALC_EVENT_TYPE_DEFAULT_DEVICE_CHANGED_SOFT),
     DECL(ALC_EVENT_TYPE_DEVICE_ADDED_SOFT),
     DECL(ALC_EVENT_TYPE_DEVICE_REMOVED_SOFT),
+    DECL(ALC_EVENT_TYPE_MIXER_OVERRUN_SOFT),
 
 
     DECL(AL_INVALID),
@@ -910,6 +931,34 @@ inline const EnumExport alcEnumerations[]{
     DECL(AL_PAN_SOFT),
 
     DECL(AL_STOP_SOURCES_ON_DISCONNECT_SOFT),
+
+    DECL(AL_SOURCE_PROPS_POSITION_BIT_SOFT),
+    DECL(AL_SOURCE_PROPS_VELOCITY_BIT_SOFT),
+    DECL(AL_SOURCE_PROPS_DIRECTION_BIT_SOFT),
+    DECL(AL_SOURCE_PROPS_GAIN_BIT_SOFT),
+    DECL(AL_SOURCE_PROPS_PITCH_BIT_SOFT),
+
+    DECL(AL_EFFECTSLOT_ASYNC_BUFFER_SOFT),
+    DECL(AL_EVENT_TYPE_EFFECTSLOT_BUFFER_READY_SOFT),
+    DECL(AL_ASYNC_SOURCE_COMMANDS_SOFT),
+
+    DECL(AL_MAP_FILE_SEQUENTIAL_BIT_SOFT),
+    DECL(AL_MAP_FILE_RANDOM_BIT_SOFT),
+    DECL(AL_MAP_FILE_PRELOAD_BIT_SOFT),
+
+    DECL(AL_BUFFER_QUEUE_CAPACITY_SOFT),
+
+    DECL(AL_LOW_ORDER_PANNING_DISTANCE_SOFT),
+    DECL(AL_LOW_ORDER_PANNING_GAIN_SOFT),
+    DECL(AL_LOW_ORDER_PANNING_SOFT),
+
+    DECL(AL_LISTENER_UPDATE_TOLERANCE_SOFT),
+    DECL(AL_SKIPPED_VOICE_UPDATES_SOFT),
+
+    DECL(AL_RESAMPLER_CACHE_HITS_SOFT),
+    DECL(AL_RESAMPLER_CACHE_MISSES_SOFT),
+    DECL(AL_FILTER_CACHE_HITS_SOFT),
+    DECL(AL_FILTER_CACHE_MISSES_SOFT),
 };
 #if ALSOFT_EAX
 inline const std::array eaxEnumerations{
@@ -2,6 +2,7 @@
 #define CORE_FILTERS_BIQUAD_H
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <utility>
@@ -122,6 +123,9 @@ public:
     /* Rather hacky. It's just here to support "manual" processing. */
     [[nodiscard]] auto getComponents() const noexcept -> std::array<Real,2> { return {{mZ1,mZ2}}; }
     void setComponents(Real z1, Real z2) noexcept { mZ1 = z1; mZ2 = z2; }
+    /** Gets the coefficients as {b0, b1, b2, a1, a2}, for external processing. */
+    [[nodiscard]] auto getCoefficients() const noexcept -> std::array<Real,5>
+    { return {{mB0, mB1, mB2, mA1, mA2}}; }
     [[nodiscard]] auto processOne(const Real in, Real &z1, Real &z2) const noexcept -> Real
     {
         const Real out{in*mB0 + z1};
@@ -7,6 +7,7 @@
 #include <array>
 #include <cassert>
 #include <cctype>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
@@ -19,6 +20,9 @@
 #include <mutex>
 #include <numeric>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -31,7 +35,9 @@
 #include "alspan.h"
 #include "alstring.h"
 #include "ambidefs.h"
+#include "filemap.h"
 #include "filters/splitter.h"
+#include "fmt/core.h"
 #include "helpers.h"
 #include "logging.h"
 #include "mixer/hrtfdefs.h"
@@ -1202,6 +1208,280 @@ al::span<const char> GetResource(int name)
 }
 #endif
 
+
+/* Prepared HRTF data sets can be stored in a cache directory, so later loads
+ * at the same sample rate can map the file instead of loading and resampling
+ * the data set again. A cache file holds the data in the same layout as the
+ * HrtfStore storage (header, field infos, elevation infos, coefficients,
+ * delays), so the store can point directly into the mapping. The mapped pages
+ * are shared with any other process using the same file.
+ */
+[[nodiscard]] constexpr auto GetCacheMarkerName() noexcept { return "ALHRC001"sv; }
+
+struct HrtfCacheHeader {
+    std::array<char,8> mMagic;
+    std::uint32_t mEndianCheck;
+    std::uint32_t mHrirLength;
+    /* Identifies the data set the file was prepared from, as its size and
+     * modification time (or a hash of the data, for built-in resources).
+     */
+    std::uint64_t mSourceSize;
+    std::uint64_t mSourceStamp;
+    std::uint32_t mSampleRate;
+    std::uint32_t mIrSize;
+    std::uint32_t mFdCount;
+    std::uint32_t mEvCount;
+    std::uint32_t mIrCount;
+    std::uint32_t mPadding;
+};
+constexpr std::uint32_t CacheEndianCheck{0x01020304u};
+
+struct HrtfCacheFile {
+    std::string mFilename;
+    std::uint64_t mSourceSize;
+    std::uint64_t mSourceStamp;
+};
+
+struct HrtfCacheLayout {
+    size_t mFieldsOffset;
+    size_t mElevsOffset;
+    size_t mCoeffsOffset;
+    size_t mDelaysOffset;
+    size_t mTotal;
+};
+
+auto GetCacheLayout(const size_t fdCount, const size_t evCount, const size_t irCount) noexcept
+    -> HrtfCacheLayout
+{
+    HrtfCacheLayout layout{};
+    size_t total{sizeof(HrtfCacheHeader)};
+    total = layout.mFieldsOffset = RoundUp(total, alignof(HrtfStore::Field));
+    total += sizeof(HrtfStore::Field)*fdCount;
+    total = layout.mElevsOffset = RoundUp(total, alignof(HrtfStore::Elevation));
+    total += sizeof(HrtfStore::Elevation)*evCount;
+    total = layout.mCoeffsOffset = RoundUp(total, 16);
+    total += sizeof(HrirArray)*irCount;
+    layout.mDelaysOffset = total;
+    total += sizeof(ubyte2)*irCount;
+    layout.mTotal = total;
+    return layout;
+}
+
+/* 64-bit FNV-1a hash. */
+auto HashBytes(const al::span<const char> data) noexcept -> std::uint64_t
+{
+    return std::accumulate(data.begin(), data.end(), 0xcbf29ce484222325_u64,
+        [](const std::uint64_t hash, const char c) noexcept -> std::uint64_t
+        { return (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3_u64; });
+}
+
+/* Gets the cache file to use for the given data set and sample rate, or an
+ * empty optional if the data set can't be identified.
+ */
+auto GetHrtfCacheFile(const std::string &cachepath, const std::string &fname,
+    const uint devrate) -> std::optional<HrtfCacheFile>
+{
+    HrtfCacheFile cache{};
+
+    int residx{};
+    char ch{};
+    if(sscanf(fname.c_str(), "!%d%c", &residx, &ch) == 2 && ch == '_')
+    {
+        const al::span<const char> res{GetResource(residx)};
+        if(res.empty())
+            return std::nullopt;
+        cache.mSourceSize = res.size();
+        cache.mSourceStamp = HashBytes(res);
+    }
+    else
+    {
+        std::error_code ec;
+        const auto path = std::filesystem::u8path(fname);
+        const auto size = std::filesystem::file_size(path, ec);
+        if(ec) return std::nullopt;
+        const auto mtime = std::filesystem::last_write_time(path, ec);
+        if(ec) return std::nullopt;
+        cache.mSourceSize = size;
+        cache.mSourceStamp = static_cast<std::uint64_t>(mtime.time_since_epoch().count());
+    }
+
+    const auto name = fmt::format("{:016x}-{}.mhrc", HashBytes(fname), devrate);
+    const auto path = std::filesystem::u8path(cachepath) / std::filesystem::u8path(name);
+    cache.mFilename = std::string{al::u8_as_char(path.u8string())};
+    return cache;
+}
+
+/* Checks that the field, elevation, and delay data from a cache file are
+ * within the limits the data set loaders enforce, and that the elevations
+ * exactly cover the stored IRs.
+ */
+auto CheckHrtfCacheData(const al::span<const HrtfStore::Field> fields,
+    const al::span<const HrtfStore::Elevation> elevs, const al::span<const ubyte2> delays)
+    noexcept -> bool
+{
+    static constexpr auto MinDistance = float(MinFdDistance) / 1000.0f;
+    static constexpr auto MaxDistance = float(MaxFdDistance) / 1000.0f;
+
+    /* Fields are stored farthest first. */
+    auto lastDistance = MaxDistance;
+    auto totalEvs = 0_uz;
+    for(const auto &field : fields)
+    {
+        if(!(field.distance >= MinDistance && field.distance <= lastDistance))
+            return false;
+        if(field.evCount < MinEvCount || field.evCount > MaxEvCount)
+            return false;
+        lastDistance = field.distance;
+        totalEvs += field.evCount;
+    }
+    if(totalEvs != elevs.size())
+        return false;
+
+    auto irOffset = 0_uz;
+    for(const auto &elev : elevs)
+    {
+        if(elev.azCount < MinAzCount || elev.azCount > MaxAzCount || elev.irOffset != irOffset)
+            return false;
+        irOffset += elev.azCount;
+    }
+    if(irOffset != delays.size())
+        return false;
+
+    static constexpr auto MaxDelay = MaxHrirDelay << HrirDelayFracBits;
+    return std::all_of(delays.begin(), delays.end(), [](const ubyte2 &delay) noexcept
+        { return delay[0] <= MaxDelay && delay[1] <= MaxDelay; });
+}
+
+/* Creates an HrtfStore using the data mapped from the cache file, if it's
+ * valid for the data set and sample rate.
+ */
+auto LoadHrtfCache(const HrtfCacheFile &cache, const uint devrate)
+    -> std::unique_ptr<HrtfStore>
+{
+    auto mapping = FileMapping::Open(cache.mFilename, 0, 0);
+    if(!mapping) return nullptr;
+
+    const al::span<std::byte> data{mapping->data()};
+    HrtfCacheHeader header{};
+    if(data.size() < sizeof(header))
+        return nullptr;
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if(GetCacheMarkerName() != std::string_view{header.mMagic.data(), header.mMagic.size()}
+        || header.mEndianCheck != CacheEndianCheck || header.mHrirLength != HrirLength
+        || header.mSourceSize != cache.mSourceSize || header.mSourceStamp != cache.mSourceStamp
+        || header.mSampleRate != devrate)
+    {
+        TRACE("Cache file {} is out of date", cache.mFilename);
+        return nullptr;
+    }
+    if(header.mIrSize < MinIrLength || header.mIrSize > HrirLength
+        || header.mFdCount < MinFdCount || header.mFdCount > MaxFdCount
+        || header.mEvCount < MinEvCount || header.mIrCount < 1)
+    {
+        WARN("Invalid cache file {}", cache.mFilename);
+        return nullptr;
+    }
+
+    const auto layout = GetCacheLayout(header.mFdCount, header.mEvCount, header.mIrCount);
+    if(data.size() != layout.mTotal)
+    {
+        WARN("Invalid cache file {} size ({} bytes, expected {})", cache.mFilename, data.size(),
+            layout.mTotal);
+        return nullptr;
+    }
+
+    auto fields = al::span{reinterpret_cast<const HrtfStore::Field*>(
+        &data[layout.mFieldsOffset]), header.mFdCount};
+    auto elevs = al::span{reinterpret_cast<HrtfStore::Elevation*>(&data[layout.mElevsOffset]),
+        header.mEvCount};
+    auto coeffs = al::span{reinterpret_cast<const HrirArray*>(&data[layout.mCoeffsOffset]),
+        header.mIrCount};
+    auto delays = al::span{reinterpret_cast<const ubyte2*>(&data[layout.mDelaysOffset]),
+        header.mIrCount};
+
+    /* The data is used as-is, so make sure it's as valid as what the data set
+     * loaders produce.
+     */
+    if(!CheckHrtfCacheData(fields, elevs, delays))
+    {
+        WARN("Invalid cache file {} layout", cache.mFilename);
+        return nullptr;
+    }
+
+    static constexpr auto AlignVal = std::align_val_t{alignof(HrtfStore)};
+    std::unique_ptr<HrtfStore> hrtf{::new(::operator new[](sizeof(HrtfStore), AlignVal))
+        HrtfStore{}};
+    hrtf->mRef.store(1u, std::memory_order_relaxed);
+    hrtf->mSampleRate = devrate & 0xff'ff'ff;
+    hrtf->mIrSize = header.mIrSize & 0xff;
+    hrtf->mFields = fields;
+    hrtf->mElev = elevs;
+    hrtf->mCoeffs = coeffs;
+    hrtf->mDelays = delays;
+    hrtf->mMapping = std::move(*mapping);
+
+    return hrtf;
+}
+
+/* Writes the prepared HrtfStore to the cache file. The data is written to a
+ * temporary file first and then renamed, so other processes never see a
+ * partially written file.
+ */
+void StoreHrtfCache(const std::string &cachepath, const HrtfCacheFile &cache,
+    const HrtfStore &hrtf)
+{
+    const auto &lastElev = hrtf.mElev.back();
+    const size_t irCount{size_t{lastElev.irOffset} + lastElev.azCount};
+
+    HrtfCacheHeader header{};
+    std::copy(GetCacheMarkerName().begin(), GetCacheMarkerName().end(), header.mMagic.begin());
+    header.mEndianCheck = CacheEndianCheck;
+    header.mHrirLength = HrirLength;
+    header.mSourceSize = cache.mSourceSize;
+    header.mSourceStamp = cache.mSourceStamp;
+    header.mSampleRate = hrtf.mSampleRate;
+    header.mIrSize = hrtf.mIrSize;
+    header.mFdCount = static_cast<std::uint32_t>(hrtf.mFields.size());
+    header.mEvCount = static_cast<std::uint32_t>(hrtf.mElev.size());
+    header.mIrCount = static_cast<std::uint32_t>(irCount);
+
+    const auto layout = GetCacheLayout(hrtf.mFields.size(), hrtf.mElev.size(), irCount);
+    auto filedata = std::vector<char>(layout.mTotal, '\0');
+    std::memcpy(filedata.data(), &header, sizeof(header));
+    std::memcpy(&filedata[layout.mFieldsOffset], hrtf.mFields.data(),
+        hrtf.mFields.size_bytes());
+    std::memcpy(&filedata[layout.mElevsOffset], hrtf.mElev.data(), hrtf.mElev.size_bytes());
+    std::memcpy(&filedata[layout.mCoeffsOffset], hrtf.mCoeffs.data(), sizeof(HrirArray)*irCount);
+    std::memcpy(&filedata[layout.mDelaysOffset], hrtf.mDelays.data(), sizeof(ubyte2)*irCount);
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::u8path(cachepath), ec);
+
+    const auto path = std::filesystem::u8path(cache.mFilename);
+    auto temppath = path;
+    temppath += fmt::format(".{:x}.tmp",
+        std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream file{temppath, std::ios::binary | std::ios::trunc};
+        if(!file.write(filedata.data(), static_cast<std::streamsize>(filedata.size())))
+        {
+            WARN("Failed to write HRTF cache file {}", cache.mFilename);
+            file.close();
+            std::filesystem::remove(temppath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(temppath, path, ec);
+    if(ec)
+    {
+        WARN("Failed to write HRTF cache file {}: {}", cache.mFilename, ec.message());
+        std::filesystem::remove(temppath, ec);
+        return;
+    }
+    TRACE("Stored HRTF cache file {}", cache.mFilename);
+}
+
 } // namespace
 
 
@@ -1261,7 +1541,8 @@ std::vector<std::string> EnumerateHrtf(std::optional<std::string> pathopt)
     return list;
 }
 
-HrtfStorePtr GetLoadedHrtf(const std::string_view name, const uint devrate)
+HrtfStorePtr GetLoadedHrtf(const std::string_view name, const uint devrate,
+    const std::optional<std::string> &cachepath)
 try {
     if(devrate > MaxSampleRate)
     {
@@ -1292,6 +1573,21 @@ try {
         }
     }
 
+    /* Use the data set already prepared for this sample rate, if available. */
+    std::optional<HrtfCacheFile> cachefile;
+    if(cachepath && !cachepath->empty())
+        cachefile = GetHrtfCacheFile(*cachepath, fname, devrate);
+    if(cachefile)
+    {
+        if(auto cached = LoadHrtfCache(*cachefile, devrate))
+        {
+            handle = LoadedHrtfs.emplace(handle, fname, devrate, std::move(cached));
+            TRACE("Loaded HRTF {} for sample rate {}hz from cache {}", name, devrate,
+                cachefile->mFilename);
+            return HrtfStorePtr{handle->mEntry.get()};
+        }
+    }
+
     std::unique_ptr<std::istream> stream;
     int residx{};
     char ch{};
@@ -1425,6 +1721,9 @@ try {
         hrtf->mSampleRate = devrate & 0xff'ff'ff;
     }
 
+    if(cachefile)
+        StoreHrtfCache(*cachepath, *cachefile, *hrtf);
+
     handle = LoadedHrtfs.emplace(handle, fname, devrate, std::move(hrtf));
     TRACE("Loaded HRTF {} for sample rate {}hz, {}-sample filter", name,
         uint{handle->mEntry->mSampleRate}, uint{handle->mEntry->mIrSize});
@@ -13,6 +13,7 @@
 #include "alspan.h"
 #include "ambidefs.h"
 #include "bufferline.h"
+#include "filemap.h"
 #include "flexarray.h"
 #include "intrusive_ptr.h"
 #include "mixer/hrtfdefs.h"
@@ -41,6 +42,11 @@ struct alignas(16) HrtfStore {
     al::span<const HrirArray> mCoeffs;
     al::span<const ubyte2> mDelays;
 
+    /* The cache file the above data is mapped from, if any. Otherwise the
+     * data is stored following the struct.
+     */
+    FileMapping mMapping;
+
     void getCoeffs(float elevation, float azimuth, float distance, float spread,
         const HrirSpan coeffs, const al::span<uint,2> delays) const;
 
@@ -93,6 +99,12 @@ struct DirectHrtfState {
 
 
 std::vector<std::string> EnumerateHrtf(std::optional<std::string> pathopt);
-HrtfStorePtr GetLoadedHrtf(const std::string_view name, const uint devrate);
+/**
+ * Gets the named HRTF data set prepared for the given sample rate. If a cache
+ * path is given, prepared data sets are stored there and mapped from there on
+ * later loads.
+ */
+HrtfStorePtr GetLoadedHrtf(const std::string_view name, const uint devrate,
+    const std::optional<std::string> &cachepath);
 
 #endif /* CORE_HRTF_H */
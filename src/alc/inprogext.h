@@ -79,6 +79,206 @@ void AL_APIENTRY alFlushMappedBufferDirectSOFT(ALCcontext *context, ALuint buffe
 #define AL_PAN_SOFT                              0x19ED
 #endif
 
+#ifndef AL_SOFT_source_props_batch
+#define AL_SOFT_source_props_batch
+#define AL_SOURCE_PROPS_POSITION_BIT_SOFT        0x00000001
+#define AL_SOURCE_PROPS_VELOCITY_BIT_SOFT        0x00000002
+#define AL_SOURCE_PROPS_DIRECTION_BIT_SOFT       0x00000004
+#define AL_SOURCE_PROPS_GAIN_BIT_SOFT            0x00000008
+#define AL_SOURCE_PROPS_PITCH_BIT_SOFT           0x00000010
+typedef struct ALsourcePropsSOFT {
+    ALuint source;
+    ALbitfieldSOFT flags;
+    ALfloat position[3];
+    ALfloat velocity[3];
+    ALfloat direction[3];
+    ALfloat gain;
+    ALfloat pitch;
+} ALsourcePropsSOFT;
+typedef void (AL_APIENTRY*LPALSOURCEPROPSVSOFT)(ALsizei count, const ALsourcePropsSOFT *props) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALSOURCEPROPSVDIRECTSOFT)(ALCcontext *context, ALsizei count, const ALsourcePropsSOFT *props) AL_API_NOEXCEPT17;
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API void AL_APIENTRY alSourcePropsvSOFT(ALsizei count, const ALsourcePropsSOFT *props) AL_API_NOEXCEPT;
+void AL_APIENTRY alSourcePropsvDirectSOFT(ALCcontext *context, ALsizei count, const ALsourcePropsSOFT *props) AL_API_NOEXCEPT;
+#endif
+#endif
+
+#ifndef AL_SOFT_effect_slot_async_buffer
+#define AL_SOFT_effect_slot_async_buffer
+#define AL_EFFECTSLOT_ASYNC_BUFFER_SOFT          0x19F1
+#define AL_EVENT_TYPE_EFFECTSLOT_BUFFER_READY_SOFT 0x19F2
+#endif
+
+#ifndef AL_SOFT_async_source_commands
+#define AL_SOFT_async_source_commands
+/* Capability for alEnable/alDisable. While enabled, alSourcePlay[v],
+ * alSourcePause[v], and alSourceStop[v] queue their commands and return
+ * without waiting, and the commands are applied shortly after in the order
+ * they were queued. Source IDs are checked when the commands are applied, and
+ * an invalid ID results in an AL_INVALID_NAME error from a later alGetError
+ * call. Other calls that depend on or change the play state apply any queued
+ * commands first, so they stay in order.
+ */
+#define AL_ASYNC_SOURCE_COMMANDS_SOFT            0x19F3
+#endif
+
+#ifndef AL_SOFT_one_shot_sounds
+#define AL_SOFT_one_shot_sounds
+/* Plays a buffer once on an internal source, which is recycled automatically
+ * when it finishes. A NULL props pointer plays the buffer with the default
+ * source properties. A slot ID of 0 leaves the first auxiliary send unset.
+ *
+ * Internal sources count against the context's source limit while playing,
+ * and a few finished ones are kept for reuse. alGenSources deletes finished
+ * ones as needed to stay under the limit. Their IDs come from the same range
+ * as the app's sources, but alIsSource reports them as invalid and they can't
+ * be deleted with alDeleteSources.
+ */
+typedef struct ALoneShotPropsSOFT {
+    ALfloat gain;
+    ALfloat pitch;
+    ALfloat position[3];
+    ALboolean relative;
+    ALuint slot;
+} ALoneShotPropsSOFT;
+typedef void (AL_APIENTRY*LPALPLAYBUFFERONESHOTSOFT)(ALuint buffer, const ALoneShotPropsSOFT *props) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALPLAYBUFFERONESHOTDIRECTSOFT)(ALCcontext *context, ALuint buffer, const ALoneShotPropsSOFT *props) AL_API_NOEXCEPT17;
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API void AL_APIENTRY alPlayBufferOneShotSOFT(ALuint buffer, const ALoneShotPropsSOFT *props) AL_API_NOEXCEPT;
+void AL_APIENTRY alPlayBufferOneShotDirectSOFT(ALCcontext *context, ALuint buffer, const ALoneShotPropsSOFT *props) AL_API_NOEXCEPT;
+#endif
+#endif
+
+#ifndef AL_SOFT_buffer_queue_capacity
+#define AL_SOFT_buffer_queue_capacity
+/* Source property. A non-zero value gives the source's buffer queue a fixed
+ * capacity, so queueing and unqueueing buffers never allocates memory.
+ * Queueing more buffers than the capacity is an AL_INVALID_OPERATION error.
+ * Can only be set while no buffers are queued. Defaults to 0, for a queue
+ * that grows as needed.
+ */
+#define AL_BUFFER_QUEUE_CAPACITY_SOFT            0x19F4
+#endif
+
+#ifndef AL_SOFT_buffer_data_file
+#define AL_SOFT_buffer_data_file
+/* Sets a buffer's storage to a region of a file, mapped into memory instead
+ * of being copied. The data must already be in the given format, and is read
+ * from the file as it's played. A size of 0 uses the rest of the file after
+ * the offset. A file descriptor may be closed once the call returns.
+ */
+#define AL_MAP_FILE_SEQUENTIAL_BIT_SOFT          0x00000001
+#define AL_MAP_FILE_RANDOM_BIT_SOFT              0x00000002
+#define AL_MAP_FILE_PRELOAD_BIT_SOFT             0x00000004
+typedef void (AL_APIENTRY*LPALBUFFERDATAFILESOFT)(ALuint buffer, ALenum format, const ALchar *filename, ALint64SOFT offset, ALsizei size, ALsizei freq, ALbitfieldSOFT flags) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALBUFFERDATAFDSOFT)(ALuint buffer, ALenum format, ALint fd, ALint64SOFT offset, ALsizei size, ALsizei freq, ALbitfieldSOFT flags) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALBUFFERDATAFILEDIRECTSOFT)(ALCcontext *context, ALuint buffer, ALenum format, const ALchar *filename, ALint64SOFT offset, ALsizei size, ALsizei freq, ALbitfieldSOFT flags) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALBUFFERDATAFDDIRECTSOFT)(ALCcontext *context, ALuint buffer, ALenum format, ALint fd, ALint64SOFT offset, ALsizei size, ALsizei freq, ALbitfieldSOFT flags) AL_API_NOEXCEPT17;
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API void AL_APIENTRY alBufferDataFileSOFT(ALuint buffer, ALenum format, const ALchar *filename, ALint64SOFT offset, ALsizei size, ALsizei freq, ALbitfieldSOFT flags) AL_API_NOEXCEPT;
+AL_API void AL_APIENTRY alBufferDataFdSOFT(ALuint buffer, ALenum format, ALint fd, ALint64SOFT offset, ALsizei size, ALsizei freq, ALbitfieldSOFT flags) AL_API_NOEXCEPT;
+void AL_APIENTRY alBufferDataFileDirectSOFT(ALCcontext *context, ALuint buffer, ALenum format, const ALchar *filename, ALint64SOFT offset, ALsizei size, ALsizei freq, ALbitfieldSOFT flags) AL_API_NOEXCEPT;
+void AL_APIENTRY alBufferDataFdDirectSOFT(ALCcontext *context, ALuint buffer, ALenum format, ALint fd, ALint64SOFT offset, ALsizei size, ALsizei freq, ALbitfieldSOFT flags) AL_API_NOEXCEPT;
+#endif
+#endif
+
+#ifndef AL_SOFT_source_scheduling
+#define AL_SOFT_source_scheduling
+/* Schedules changes for playing or paused sources on the device clock (as
+ * with alSourcePlayAtTimeSOFT), applied by the mixer at the exact sample.
+ * Sources that aren't playing or paused are ignored. A scheduled stop fades
+ * the source out from the given time and stops it, as if it ran out of
+ * buffers. A gain ramp linearly changes a gain applied on top of AL_GAIN, from
+ * its value at the start time to the given gain over the duration, replacing
+ * any previous ramp. The ramp gain starts at 1 each time the source is
+ * played.
+ */
+typedef void (AL_APIENTRY*LPALSOURCESTOPATTIMESOFT)(ALuint source, ALint64SOFT stop_time) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALSOURCESTOPATTIMEVSOFT)(ALsizei n, const ALuint *sources, ALint64SOFT stop_time) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALSOURCEGAINRAMPSOFT)(ALuint source, ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALSOURCEGAINRAMPVSOFT)(ALsizei n, const ALuint *sources, ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALSOURCESTOPATTIMEDIRECTSOFT)(ALCcontext *context, ALuint source, ALint64SOFT stop_time) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALSOURCESTOPATTIMEVDIRECTSOFT)(ALCcontext *context, ALsizei n, const ALuint *sources, ALint64SOFT stop_time) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALSOURCEGAINRAMPDIRECTSOFT)(ALCcontext *context, ALuint source, ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) AL_API_NOEXCEPT17;
+typedef void (AL_APIENTRY*LPALSOURCEGAINRAMPVDIRECTSOFT)(ALCcontext *context, ALsizei n, const ALuint *sources, ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) AL_API_NOEXCEPT17;
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API void AL_APIENTRY alSourceStopAtTimeSOFT(ALuint source, ALint64SOFT stop_time) AL_API_NOEXCEPT;
+AL_API void AL_APIENTRY alSourceStopAtTimevSOFT(ALsizei n, const ALuint *sources, ALint64SOFT stop_time) AL_API_NOEXCEPT;
+AL_API void AL_APIENTRY alSourceGainRampSOFT(ALuint source, ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) AL_API_NOEXCEPT;
+AL_API void AL_APIENTRY alSourceGainRampvSOFT(ALsizei n, const ALuint *sources, ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) AL_API_NOEXCEPT;
+void AL_APIENTRY alSourceStopAtTimeDirectSOFT(ALCcontext *context, ALuint source, ALint64SOFT stop_time) AL_API_NOEXCEPT;
+void AL_APIENTRY alSourceStopAtTimevDirectSOFT(ALCcontext *context, ALsizei n, const ALuint *sources, ALint64SOFT stop_time) AL_API_NOEXCEPT;
+void AL_APIENTRY alSourceGainRampDirectSOFT(ALCcontext *context, ALuint source, ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) AL_API_NOEXCEPT;
+void AL_APIENTRY alSourceGainRampvDirectSOFT(ALCcontext *context, ALsizei n, const ALuint *sources, ALfloat gain, ALint64SOFT start_time, ALint64SOFT duration) AL_API_NOEXCEPT;
+#endif
+#endif
+
+#ifndef AL_SOFT_low_order_panning
+#define AL_SOFT_low_order_panning
+/* Listener properties for when sources get panned at first order, instead of
+ * the device's full ambisonic order. Such sources are mixed together and
+ * up-converted to the full order once per update, making them much cheaper to
+ * mix. By default, a source is panned at first order when it's at least
+ * AL_LOW_ORDER_PANNING_DISTANCE_SOFT units from the listener (default
+ * FLT_MAX), or its gain is below AL_LOW_ORDER_PANNING_GAIN_SOFT (default 0).
+ * The AL_LOW_ORDER_PANNING_SOFT source property overrides this with AL_FALSE
+ * or AL_TRUE, or follows it with AL_AUTO_SOFT (the default). Has no effect
+ * with HRTF or first-order output.
+ */
+#define AL_LOW_ORDER_PANNING_DISTANCE_SOFT       0x19F5
+#define AL_LOW_ORDER_PANNING_GAIN_SOFT           0x19F6
+#define AL_LOW_ORDER_PANNING_SOFT                0x19F7
+#endif
+
+#ifndef AL_SOFT_listener_update_tolerance
+#define AL_SOFT_listener_update_tolerance
+/* A listener property that, when non-0, lets listener updates skip
+ * recalculating sources whose listener-relative geometry changed by no more
+ * than the given amount since they were last calculated. Directions are
+ * compared as unit vectors, the distance relative to the last calculated
+ * distance, and velocities relative to the speed of sound. Head-relative
+ * sources are skipped unless the listener velocity changes. Changes to the
+ * sources themselves and to other context properties always update the
+ * affected sources. Defaults to 0, where every listener update recalculates
+ * all sources. AL_SKIPPED_VOICE_UPDATES_SOFT is a read-only context property
+ * with the total number of skipped source recalculations.
+ */
+#define AL_LISTENER_UPDATE_TOLERANCE_SOFT        0x19F8
+#define AL_SKIPPED_VOICE_UPDATES_SOFT            0x19F9
+#endif
+
+#ifndef AL_SOFT_parameter_cache_stats
+#define AL_SOFT_parameter_cache_stats
+/* Read-only context properties with the number of times source resamplers
+ * and shelf filters were set up from the context's cache of previously
+ * prepared parameters (hits), or had to be prepared anew (misses).
+ */
+#define AL_RESAMPLER_CACHE_HITS_SOFT             0x19FA
+#define AL_RESAMPLER_CACHE_MISSES_SOFT           0x19FB
+#define AL_FILTER_CACHE_HITS_SOFT                0x19FC
+#define AL_FILTER_CACHE_MISSES_SOFT              0x19FD
+#endif
+
+#ifndef ALC_SOFT_mixer_profile
+#define ALC_SOFT_mixer_profile
+/* Queried with alcGetInteger64vSOFT. ALC_MIXER_PROFILE_SOFT returns the
+ * number of mixes done, followed by the total and the longest single-mix time
+ * in nanoseconds for each of the parameter update, voice mixing, effect,
+ * post-process, limiter, distance compensation, dither, and output write
+ * stages.
+ */
+#define ALC_MIXER_PROFILE_SIZE_SOFT              0x19EE
+#define ALC_MIXER_PROFILE_SOFT                   0x19EF
+#endif
+
+#ifndef ALC_SOFT_mixer_overrun_event
+#define ALC_SOFT_mixer_overrun_event
+/* A system event for playback devices, sent when the mixer takes longer to
+ * mix an update than it takes to play.
+ */
+#define ALC_EVENT_TYPE_MIXER_OVERRUN_SOFT        0x19F0
+#endif
+
 /* Non-standard exports. Not part of any extension. */
 AL_API const ALchar* AL_APIENTRY alsoft_get_version(void) noexcept;
 
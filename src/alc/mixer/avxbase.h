@@ -0,0 +1,363 @@
+#ifndef CORE_MIXER_AVXBASE_H
+#define CORE_MIXER_AVXBASE_H
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <variant>
+
+#include "alnumeric.h"
+#include "alspan.h"
+#include "core/bsinc_defs.h"
+#include "core/bufferline.h"
+#include "core/cubic_defs.h"
+#include "core/mixer/hrtfdefs.h"
+#include "core/resampler_limits.h"
+#include "defs.h"
+#include "opthelpers.h"
+
+
+/* Mixer functions shared by the AVX and AVX2 mixers. This must only be
+ * included by those, after enabling the target instruction set and defining
+ * vmadd(x, y, z) (returning x + y*z) for __m128 and __m256, so everything here
+ * is compiled for the given target. It's all in an anonymous namespace to keep
+ * each target's copy separate.
+ */
+namespace {
+
+constexpr uint BSincPhaseDiffBits{MixerFracBits - BSincPhaseBits};
+constexpr uint BSincPhaseDiffOne{1 << BSincPhaseDiffBits};
+constexpr uint BSincPhaseDiffMask{BSincPhaseDiffOne - 1u};
+
+constexpr uint CubicPhaseDiffBits{MixerFracBits - CubicPhaseBits};
+constexpr uint CubicPhaseDiffOne{1 << CubicPhaseDiffBits};
+constexpr uint CubicPhaseDiffMask{CubicPhaseDiffOne - 1u};
+
+/* Combines two 4-element vectors into one 8-element vector. */
+force_inline __m256 vcombine(const __m128 lo, const __m128 hi) noexcept
+{ return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1); }
+
+/* Returns the sum of the 4 elements of the vector. */
+force_inline float vhsum(__m128 x4) noexcept
+{
+    x4 = _mm_add_ps(x4, _mm_shuffle_ps(x4, x4, _MM_SHUFFLE(0, 1, 2, 3)));
+    x4 = _mm_add_ps(x4, _mm_movehl_ps(x4, x4));
+    return _mm_cvtss_f32(x4);
+}
+
+inline void ApplyCoeffs(const al::span<float2> Values, const size_t IrSize,
+    const ConstHrirSpan Coeffs, const float left, const float right)
+{
+    ASSUME(IrSize >= MinIrLength);
+    ASSUME(IrSize <= HrirLength);
+    /* Round up the IR size to a multiple of 2 (2 IRs for 2 channels is 4
+     * floats), as with SSE. The underlying HRIR is a fixed-size multiple of
+     * 2, any extra samples are either 0 (silence) or more IR samples that get
+     * applied for "free".
+     *
+     * Values alternates between 8- and 16-byte alignment, so use unaligned
+     * loads and stores for it rather than shuffling the coefficients.
+     */
+    const auto count4 = size_t{(IrSize+1) >> 1};
+    float *vals{Values[0].data()};
+    const float *coeffs{Coeffs[0].data()};
+
+    const auto lrlr8 = _mm256_setr_ps(left, right, left, right, left, right, left, right);
+    for(size_t td{count4 >> 1};td;--td)
+    {
+        const auto imp8 = _mm256_loadu_ps(coeffs);
+        _mm256_storeu_ps(vals, vmadd(_mm256_loadu_ps(vals), imp8, lrlr8));
+        vals += 8;
+        coeffs += 8;
+    }
+    if((count4&1))
+    {
+        const auto imp4 = _mm_loadu_ps(coeffs);
+        _mm_storeu_ps(vals, vmadd(_mm_loadu_ps(vals), imp4, _mm256_castps256_ps128(lrlr8)));
+    }
+}
+
+force_inline void MixLine(const al::span<const float> InSamples, const al::span<float> dst,
+    float &CurrentGain, const float TargetGain, const float delta, const size_t fade_len,
+    const size_t Counter)
+{
+    const auto step = float{(TargetGain-CurrentGain) * delta};
+
+    size_t pos{0};
+    if(std::abs(step) > std::numeric_limits<float>::epsilon())
+    {
+        const auto gain = CurrentGain;
+        auto step_count = 0.0f;
+        /* Mix with applying gain steps in multiples of 8. */
+        if(const size_t todo{fade_len >> 3})
+        {
+            const auto eight8 = _mm256_set1_ps(8.0f);
+            const auto step8 = _mm256_set1_ps(step);
+            const auto gain8 = _mm256_set1_ps(gain);
+            auto step_count8 = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+            for(size_t i{0};i < todo;++i)
+            {
+                /* dry += val * (gain + step*step_count) */
+                const auto val8 = _mm256_loadu_ps(&InSamples[pos]);
+                const auto dry8 = _mm256_loadu_ps(&dst[pos]);
+                _mm256_storeu_ps(&dst[pos], vmadd(dry8, val8, vmadd(gain8, step8, step_count8)));
+                step_count8 = _mm256_add_ps(step_count8, eight8);
+                pos += 8;
+            }
+
+            /* NOTE: step_count8 now represents the next eight counts after
+             * the last eight mixed samples, so the lowest element represents
+             * the next step count to apply.
+             */
+            step_count = _mm_cvtss_f32(_mm256_castps256_ps128(step_count8));
+        }
+        /* Mix with applying left over gain steps that aren't multiples of 8. */
+        if(const size_t leftover{fade_len&7})
+        {
+            const auto in = InSamples.subspan(pos, leftover);
+            const auto out = dst.subspan(pos);
+
+            std::transform(in.begin(), in.end(), out.begin(), out.begin(),
+                [gain,step,&step_count](const float val, float dry) noexcept -> float
+                {
+                    dry += val * (gain + step*step_count);
+                    step_count += 1.0f;
+                    return dry;
+                });
+            pos += leftover;
+        }
+        if(pos < Counter)
+        {
+            CurrentGain = gain + step*step_count;
+            return;
+        }
+    }
+    CurrentGain = TargetGain;
+
+    if(!(std::abs(TargetGain) > GainSilenceThreshold))
+        return;
+    if(size_t todo{(InSamples.size()-pos) >> 3})
+    {
+        const auto gain8 = _mm256_set1_ps(TargetGain);
+        do {
+            const auto val8 = _mm256_loadu_ps(&InSamples[pos]);
+            const auto dry8 = _mm256_loadu_ps(&dst[pos]);
+            _mm256_storeu_ps(&dst[pos], vmadd(dry8, val8, gain8));
+            pos += 8;
+        } while(--todo);
+    }
+    if(const size_t leftover{(InSamples.size()-pos)&7})
+    {
+        const auto in = InSamples.last(leftover);
+        const auto out = dst.subspan(pos);
+
+        std::transform(in.begin(), in.end(), out.begin(), out.begin(),
+            [TargetGain](const float val, const float dry) noexcept -> float
+            { return dry + val*TargetGain; });
+    }
+}
+
+
+inline void ResampleCubicAVX(const InterpState *state, const al::span<const float> src,
+    uint frac, const uint increment, const al::span<float> dst)
+{
+    ASSUME(frac < MixerFracOne);
+
+    const auto filter = std::get<CubicState>(*state).filter;
+
+    /* Each output sample only needs 4 input samples, so do two output samples
+     * at a time, one in each half of the vector.
+     */
+    size_t pos{MaxResamplerEdge-1};
+    auto dstiter = dst.begin();
+    for(size_t todo{dst.size() >> 1};todo;--todo)
+    {
+        const uint pi0{frac >> CubicPhaseDiffBits}; ASSUME(pi0 < CubicPhaseCount);
+        const float pf0{static_cast<float>(frac&CubicPhaseDiffMask) * (1.0f/CubicPhaseDiffOne)};
+        const size_t pos0{pos};
+        frac += increment;
+        pos  += frac>>MixerFracBits;
+        frac &= MixerFracMask;
+
+        const uint pi1{frac >> CubicPhaseDiffBits}; ASSUME(pi1 < CubicPhaseCount);
+        const float pf1{static_cast<float>(frac&CubicPhaseDiffMask) * (1.0f/CubicPhaseDiffOne)};
+        const size_t pos1{pos};
+        frac += increment;
+        pos  += frac>>MixerFracBits;
+        frac &= MixerFracMask;
+
+        /* f = fil + pf*phd */
+        const auto pf8 = vcombine(_mm_set1_ps(pf0), _mm_set1_ps(pf1));
+        const auto f8 = vmadd(
+            vcombine(_mm_load_ps(filter[pi0].mCoeffs.data()),
+                _mm_load_ps(filter[pi1].mCoeffs.data())), pf8,
+            vcombine(_mm_load_ps(filter[pi0].mDeltas.data()),
+                _mm_load_ps(filter[pi1].mDeltas.data())));
+        /* r = f*src */
+        auto r8 = _mm256_mul_ps(f8, vcombine(_mm_loadu_ps(&src[pos0]), _mm_loadu_ps(&src[pos1])));
+
+        /* Sum each half separately. */
+        r8 = _mm256_hadd_ps(r8, r8);
+        r8 = _mm256_hadd_ps(r8, r8);
+        *(dstiter++) = _mm_cvtss_f32(_mm256_castps256_ps128(r8));
+        *(dstiter++) = _mm_cvtss_f32(_mm256_extractf128_ps(r8, 1));
+    }
+    if(dstiter != dst.end())
+    {
+        const uint pi{frac >> CubicPhaseDiffBits}; ASSUME(pi < CubicPhaseCount);
+        const float pf{static_cast<float>(frac&CubicPhaseDiffMask) * (1.0f/CubicPhaseDiffOne)};
+
+        const auto f4 = vmadd(_mm_load_ps(filter[pi].mCoeffs.data()), _mm_set1_ps(pf),
+            _mm_load_ps(filter[pi].mDeltas.data()));
+        *dstiter = vhsum(_mm_mul_ps(f4, _mm_loadu_ps(&src[pos])));
+    }
+}
+
+inline void ResampleBSincAVX(const InterpState *state, const al::span<const float> src,
+    uint frac, const uint increment, const al::span<float> dst)
+{
+    const auto &bsinc = std::get<BsincState>(*state);
+    const auto sf = bsinc.sf;
+    const auto m = size_t{bsinc.m};
+    ASSUME(m > 0);
+    ASSUME(m <= MaxResamplerPadding);
+    ASSUME(frac < MixerFracOne);
+
+    const auto filter = bsinc.filter.first(4_uz*BSincPhaseCount*m);
+
+    ASSUME(bsinc.l <= MaxResamplerEdge);
+    auto pos = size_t{MaxResamplerEdge-bsinc.l};
+    std::generate(dst.begin(), dst.end(), [&pos,&frac,src,increment,sf,m,filter]() -> float
+    {
+        // Calculate the phase index and factor.
+        const size_t pi{frac >> BSincPhaseDiffBits}; ASSUME(pi < BSincPhaseCount);
+        const float pf{static_cast<float>(frac&BSincPhaseDiffMask) * (1.0f/BSincPhaseDiffOne)};
+
+        // Apply the scale and phase interpolated filter.
+        auto r4 = _mm_setzero_ps();
+        {
+            const auto sf8 = _mm256_set1_ps(sf);
+            const auto pf8 = _mm256_set1_ps(pf);
+            const auto fil = filter.subspan(2_uz*pi*m);
+            const auto phd = fil.subspan(m);
+            const auto scd = fil.subspan(2_uz*BSincPhaseCount*m);
+            const auto spd = scd.subspan(m);
+            auto j = size_t{0};
+
+            /* The filter length is a multiple of 4, but not necessarily of
+             * 8. The filter coefficients are only guaranteed 16-byte aligned.
+             */
+            auto r8 = _mm256_setzero_ps();
+            for(auto td = size_t{m >> 3};td;--td)
+            {
+                /* f = ((fil + sf*scd) + pf*(phd + sf*spd)) */
+                const auto f8 = vmadd(
+                    vmadd(_mm256_loadu_ps(&fil[j]), sf8, _mm256_loadu_ps(&scd[j])),
+                    pf8, vmadd(_mm256_loadu_ps(&phd[j]), sf8, _mm256_loadu_ps(&spd[j])));
+                /* r += f*src */
+                r8 = vmadd(r8, f8, _mm256_loadu_ps(&src[pos+j]));
+                j += 8;
+            }
+            r4 = _mm_add_ps(_mm256_castps256_ps128(r8), _mm256_extractf128_ps(r8, 1));
+            if((m&4))
+            {
+                const auto sf4 = _mm256_castps256_ps128(sf8);
+                const auto f4 = vmadd(
+                    vmadd(_mm_load_ps(&fil[j]), sf4, _mm_load_ps(&scd[j])),
+                    _mm256_castps256_ps128(pf8),
+                    vmadd(_mm_load_ps(&phd[j]), sf4, _mm_load_ps(&spd[j])));
+                r4 = vmadd(r4, f4, _mm_loadu_ps(&src[pos+j]));
+            }
+        }
+        const auto output = vhsum(r4);
+
+        frac += increment;
+        pos  += frac>>MixerFracBits;
+        frac &= MixerFracMask;
+        return output;
+    });
+}
+
+inline void ResampleFastBSincAVX(const InterpState *state, const al::span<const float> src,
+    uint frac, const uint increment, const al::span<float> dst)
+{
+    const auto &bsinc = std::get<BsincState>(*state);
+    const auto m = size_t{bsinc.m};
+    ASSUME(m > 0);
+    ASSUME(m <= MaxResamplerPadding);
+    ASSUME(frac < MixerFracOne);
+
+    const auto filter = bsinc.filter.first(2_uz*m*BSincPhaseCount);
+
+    ASSUME(bsinc.l <= MaxResamplerEdge);
+    size_t pos{MaxResamplerEdge-bsinc.l};
+    std::generate(dst.begin(), dst.end(), [&pos,&frac,src,increment,filter,m]() -> float
+    {
+        // Calculate the phase index and factor.
+        const size_t pi{frac >> BSincPhaseDiffBits}; ASSUME(pi < BSincPhaseCount);
+        const float pf{static_cast<float>(frac&BSincPhaseDiffMask) * (1.0f/BSincPhaseDiffOne)};
+
+        // Apply the phase interpolated filter.
+        auto r4 = _mm_setzero_ps();
+        {
+            const auto pf8 = _mm256_set1_ps(pf);
+            const auto fil = filter.subspan(2_uz*m*pi);
+            const auto phd = fil.subspan(m);
+            auto j = size_t{0};
+
+            auto r8 = _mm256_setzero_ps();
+            for(auto td = size_t{m >> 3};td;--td)
+            {
+                /* f = fil + pf*phd */
+                const auto f8 = vmadd(_mm256_loadu_ps(&fil[j]), pf8, _mm256_loadu_ps(&phd[j]));
+                /* r += f*src */
+                r8 = vmadd(r8, f8, _mm256_loadu_ps(&src[pos+j]));
+                j += 8;
+            }
+            r4 = _mm_add_ps(_mm256_castps256_ps128(r8), _mm256_extractf128_ps(r8, 1));
+            if((m&4))
+            {
+                const auto f4 = vmadd(_mm_load_ps(&fil[j]), _mm256_castps256_ps128(pf8),
+                    _mm_load_ps(&phd[j]));
+                r4 = vmadd(r4, f4, _mm_loadu_ps(&src[pos+j]));
+            }
+        }
+        const auto output = vhsum(r4);
+
+        frac += increment;
+        pos  += frac>>MixerFracBits;
+        frac &= MixerFracMask;
+        return output;
+    });
+}
+
+inline void MixAVX(const al::span<const float> InSamples,
+    const al::span<FloatBufferLine> OutBuffer, const al::span<float> CurrentGains,
+    const al::span<const float> TargetGains, const size_t Counter, const size_t OutPos)
+{
+    const float delta{(Counter > 0) ? 1.0f / static_cast<float>(Counter) : 0.0f};
+    const auto fade_len = std::min(Counter, InSamples.size());
+
+    auto curgains = CurrentGains.begin();
+    auto targetgains = TargetGains.cbegin();
+    for(FloatBufferLine &output : OutBuffer)
+        MixLine(InSamples, al::span{output}.subspan(OutPos), *curgains++, *targetgains++, delta,
+            fade_len, Counter);
+}
+
+inline void MixAVX(const al::span<const float> InSamples, const al::span<float> OutBuffer,
+    float &CurrentGain, const float TargetGain, const size_t Counter)
+{
+    const float delta{(Counter > 0) ? 1.0f / static_cast<float>(Counter) : 0.0f};
+    const auto fade_len = std::min(Counter, InSamples.size());
+
+    MixLine(InSamples, OutBuffer, CurrentGain, TargetGain, delta, fade_len, Counter);
+}
+
+} // namespace
+
+#endif /* CORE_MIXER_AVXBASE_H */
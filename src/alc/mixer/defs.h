@@ -10,6 +10,7 @@
 #include "alspan.h"
 #include "core/bufferline.h"
 #include "core/cubic_defs.h"
+#include "core/filters/biquad.h"
 
 struct HrtfChannelState;
 struct HrtfFilter;
@@ -96,6 +97,27 @@ void MixDirectHrtf_(const FloatBufferSpan LeftOut, const FloatBufferSpan RightOu
     const al::span<float,BufferLineSize> TempBuf, const al::span<HrtfChannelState> ChanState,
     const size_t IrSize, const size_t SamplesToDo);
 
+/* The number of independent filter streams the lane filters process at once. */
+inline constexpr size_t FilterLaneCount{4};
+
+/* A stream for the lane filters, filtering the source samples into the
+ * destination through one biquad, or two in series when mSecond is set. Each
+ * stream uses its own filters' coefficients and state.
+ */
+struct FilterLane {
+    BiquadFilter *mFirst{};
+    BiquadFilter *mSecond{};
+    al::span<const float> mSrc;
+    al::span<float> mDst;
+};
+
+/* Filters up to FilterLaneCount streams. The recursion of a biquad can't be
+ * vectorized for a single stream, but independent streams can be processed
+ * side by side in SIMD lanes.
+ */
+template<typename InstTag>
+void FilterLanes_(const al::span<FilterLane> lanes, const size_t SamplesToDo);
+
 /* Vectorized resampler helpers */
 template<size_t N>
 constexpr void InitPosArrays(uint pos, uint frac, const uint increment,
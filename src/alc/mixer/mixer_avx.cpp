@@ -0,0 +1,121 @@
+#include "config.h"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <variant>
+
+#include "alnumeric.h"
+#include "alspan.h"
+#include "core/bsinc_defs.h"
+#include "core/bufferline.h"
+#include "core/cubic_defs.h"
+#include "core/mixer/hrtfdefs.h"
+#include "core/resampler_limits.h"
+#include "defs.h"
+#include "opthelpers.h"
+
+struct AVXTag;
+struct CubicTag;
+struct BSincTag;
+struct FastBSincTag;
+
+
+/* Everything from here on is compiled for the target instruction set,
+ * including the shared mixer functions and HRTF mixing templates, so the
+ * latter can inline the coefficient function they're given. Other headers
+ * are included above, so their inline functions aren't built for the target
+ * and can't be picked up by code that runs without it.
+ */
+#if defined(__clang__)
+#if !(defined(__AVX__))
+#pragma clang attribute push(__attribute__((target("avx"))), apply_to=function)
+#define AVX_TARGET_PUSHED
+#endif
+#elif defined(__GNUC__)
+#if !(defined(__AVX__))
+#pragma GCC push_options
+#pragma GCC target("avx")
+#define AVX_TARGET_PUSHED
+#endif
+#endif
+
+#include "hrtfbase.h"
+
+namespace {
+
+force_inline __m128 vmadd(const __m128 x, const __m128 y, const __m128 z) noexcept
+{ return _mm_add_ps(x, _mm_mul_ps(y, z)); }
+
+force_inline __m256 vmadd(const __m256 x, const __m256 y, const __m256 z) noexcept
+{ return _mm256_add_ps(x, _mm256_mul_ps(y, z)); }
+
+} // namespace
+
+#include "avxbase.h"
+
+
+template<>
+void Resample_<CubicTag,AVXTag>(const InterpState *state, const al::span<const float> src,
+    uint frac, const uint increment, const al::span<float> dst)
+{ ResampleCubicAVX(state, src, frac, increment, dst); }
+
+template<>
+void Resample_<BSincTag,AVXTag>(const InterpState *state, const al::span<const float> src,
+    uint frac, const uint increment, const al::span<float> dst)
+{ ResampleBSincAVX(state, src, frac, increment, dst); }
+
+template<>
+void Resample_<FastBSincTag,AVXTag>(const InterpState *state, const al::span<const float> src,
+    uint frac, const uint increment, const al::span<float> dst)
+{ ResampleFastBSincAVX(state, src, frac, increment, dst); }
+
+
+template<>
+void MixHrtf_<AVXTag>(const al::span<const float> InSamples, const al::span<float2> AccumSamples,
+    const uint IrSize, const MixHrtfFilter *hrtfparams, const size_t SamplesToDo)
+{ MixHrtfBase<ApplyCoeffs>(InSamples, AccumSamples, IrSize, hrtfparams, SamplesToDo); }
+
+template<>
+void MixHrtfBlend_<AVXTag>(const al::span<const float> InSamples,
+    const al::span<float2> AccumSamples, const uint IrSize, const HrtfFilter *oldparams,
+    const MixHrtfFilter *newparams, const size_t SamplesToDo)
+{
+    MixHrtfBlendBase<ApplyCoeffs>(InSamples, AccumSamples, IrSize, oldparams, newparams,
+        SamplesToDo);
+}
+
+template<>
+void MixDirectHrtf_<AVXTag>(const FloatBufferSpan LeftOut, const FloatBufferSpan RightOut,
+    const al::span<const FloatBufferLine> InSamples, const al::span<float2> AccumSamples,
+    const al::span<float,BufferLineSize> TempBuf, const al::span<HrtfChannelState> ChanState,
+    const size_t IrSize, const size_t SamplesToDo)
+{
+    MixDirectHrtfBase<ApplyCoeffs>(LeftOut, RightOut, InSamples, AccumSamples, TempBuf, ChanState,
+        IrSize, SamplesToDo);
+}
+
+
+template<>
+void Mix_<AVXTag>(const al::span<const float> InSamples, const al::span<FloatBufferLine> OutBuffer,
+    const al::span<float> CurrentGains, const al::span<const float> TargetGains,
+    const size_t Counter, const size_t OutPos)
+{ MixAVX(InSamples, OutBuffer, CurrentGains, TargetGains, Counter, OutPos); }
+
+template<>
+void Mix_<AVXTag>(const al::span<const float> InSamples, const al::span<float> OutBuffer,
+    float &CurrentGain, const float TargetGain, const size_t Counter)
+{ MixAVX(InSamples, OutBuffer, CurrentGain, TargetGain, Counter); }
+
+#ifdef AVX_TARGET_PUSHED
+#undef AVX_TARGET_PUSHED
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif
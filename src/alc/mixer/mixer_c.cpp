@@ -11,6 +11,7 @@
 #include "core/bsinc_defs.h"
 #include "core/bufferline.h"
 #include "core/cubic_defs.h"
+#include "core/filters/biquad.h"
 #include "core/mixer/hrtfdefs.h"
 #include "core/resampler_limits.h"
 #include "defs.h"
@@ -254,6 +255,19 @@ void MixDirectHrtf_<CTag>(const FloatBufferSpan LeftOut, const FloatBufferSpan R
 }
 
 
+template<>
+void FilterLanes_<CTag>(const al::span<FilterLane> lanes, const size_t SamplesToDo)
+{
+    for(const FilterLane &lane : lanes)
+    {
+        if(!lane.mSecond)
+            lane.mFirst->process(lane.mSrc.first(SamplesToDo), lane.mDst);
+        else
+            lane.mFirst->dualProcess(*lane.mSecond, lane.mSrc.first(SamplesToDo), lane.mDst);
+    }
+}
+
+
 template<>
 void Mix_<CTag>(const al::span<const float> InSamples, const al::span<FloatBufferLine> OutBuffer,
     const al::span<float> CurrentGains, const al::span<const float> TargetGains,
@@ -13,6 +13,7 @@
 #include "core/bsinc_defs.h"
 #include "core/bufferline.h"
 #include "core/cubic_defs.h"
+#include "core/filters/biquad.h"
 #include "core/mixer/hrtfdefs.h"
 #include "core/resampler_limits.h"
 #include "defs.h"
@@ -188,6 +189,114 @@ force_inline void MixLine(const al::span<const float> InSamples, const al::span<
     }
 }
 
+
+/* A biquad stage for the lane filters, with each lane holding a different
+ * stream's coefficients and state.
+ */
+struct LaneStage {
+    float32x4_t b0, b1, b2, a1, a2;
+    float32x4_t z1, z2;
+};
+
+/* Loads the given filter of each lane. Lanes without that filter, or without
+ * a stream, get a pass-through filter.
+ */
+auto LoadLaneStage(const al::span<const FilterLane> lanes, BiquadFilter *FilterLane::*filter)
+    -> LaneStage
+{
+    std::array<std::array<float,FilterLaneCount>,7> params{};
+    params[0].fill(1.0f);
+    for(size_t i{0};i < lanes.size();++i)
+    {
+        if(const BiquadFilter *biquad{lanes[i].*filter})
+        {
+            const auto coeffs = biquad->getCoefficients();
+            const auto comps = biquad->getComponents();
+            for(size_t j{0};j < coeffs.size();++j)
+                params[j][i] = coeffs[j];
+            params[5][i] = comps[0];
+            params[6][i] = comps[1];
+        }
+    }
+    return LaneStage{vld1q_f32(params[0].data()), vld1q_f32(params[1].data()),
+        vld1q_f32(params[2].data()), vld1q_f32(params[3].data()), vld1q_f32(params[4].data()),
+        vld1q_f32(params[5].data()), vld1q_f32(params[6].data())};
+}
+
+void StoreLaneStage(const al::span<const FilterLane> lanes, BiquadFilter *FilterLane::*filter,
+    const LaneStage &stage)
+{
+    std::array<float,FilterLaneCount> z1{};
+    std::array<float,FilterLaneCount> z2{};
+    vst1q_f32(z1.data(), stage.z1);
+    vst1q_f32(z2.data(), stage.z2);
+    for(size_t i{0};i < lanes.size();++i)
+    {
+        if(BiquadFilter *biquad{lanes[i].*filter})
+            biquad->setComponents(z1[i], z2[i]);
+    }
+}
+
+/* Same as BiquadFilter::processOne, for each lane. Separate multiplies and
+ * adds are used so the results match the scalar filter.
+ */
+force_inline auto ProcessLaneStage(LaneStage &stage, const float32x4_t input) noexcept
+    -> float32x4_t
+{
+    const float32x4_t output{vaddq_f32(vmulq_f32(input, stage.b0), stage.z1)};
+    stage.z1 = vaddq_f32(vsubq_f32(vmulq_f32(input, stage.b1), vmulq_f32(output, stage.a1)),
+        stage.z2);
+    stage.z2 = vsubq_f32(vmulq_f32(input, stage.b2), vmulq_f32(output, stage.a2));
+    return output;
+}
+
+template<bool Dual>
+void FilterLanes(const al::span<const FilterLane> lanes, const size_t SamplesToDo)
+{
+    LaneStage first{LoadLaneStage(lanes, &FilterLane::mFirst)};
+    LaneStage second{Dual ? LoadLaneStage(lanes, &FilterLane::mSecond) : first};
+    auto process = [&first,&second](const float32x4_t input) -> float32x4_t
+    {
+        if constexpr(Dual)
+            return ProcessLaneStage(second, ProcessLaneStage(first, input));
+        else
+            return ProcessLaneStage(first, input);
+    };
+
+    /* Unused lanes repeat the first stream's input, and drop their output. */
+    std::array<const float*,FilterLaneCount> src{};
+    for(size_t i{0};i < src.size();++i)
+        src[i] = lanes[(i < lanes.size()) ? i : 0].mSrc.data();
+
+    /* Load four samples from each stream and transpose them, so each vector
+     * holds one sample of every stream, and transpose the output back.
+     */
+    size_t pos{0};
+    for(;pos < (SamplesToDo&~3_uz);pos += 4)
+    {
+        std::array<float32x4_t,FilterLaneCount> vals{vld1q_f32(&src[0][pos]),
+            vld1q_f32(&src[1][pos]), vld1q_f32(&src[2][pos]), vld1q_f32(&src[3][pos])};
+        vtranspose4(vals[0], vals[1], vals[2], vals[3]);
+        for(auto &val : vals)
+            val = process(val);
+        vtranspose4(vals[0], vals[1], vals[2], vals[3]);
+        for(size_t i{0};i < lanes.size();++i)
+            vst1q_f32(&lanes[i].mDst[pos], vals[i]);
+    }
+    for(;pos < SamplesToDo;++pos)
+    {
+        std::array<float,FilterLaneCount> vals{};
+        vst1q_f32(vals.data(), process(set_f4(src[0][pos], src[1][pos], src[2][pos],
+            src[3][pos])));
+        for(size_t i{0};i < lanes.size();++i)
+            lanes[i].mDst[pos] = vals[i];
+    }
+
+    StoreLaneStage(lanes, &FilterLane::mFirst, first);
+    if constexpr(Dual)
+        StoreLaneStage(lanes, &FilterLane::mSecond, second);
+}
+
 } // namespace
 
 template<>
@@ -460,6 +569,21 @@ void MixDirectHrtf_<NEONTag>(const FloatBufferSpan LeftOut, const FloatBufferSpa
 }
 
 
+template<>
+void FilterLanes_<NEONTag>(const al::span<FilterLane> lanes, const size_t SamplesToDo)
+{
+    if(lanes.size() < 2)
+        return FilterLanes_<CTag>(lanes, SamplesToDo);
+
+    const bool dual{std::any_of(lanes.begin(), lanes.end(),
+        [](const FilterLane &lane) noexcept { return lane.mSecond != nullptr; })};
+    if(dual)
+        FilterLanes<true>(lanes, SamplesToDo);
+    else
+        FilterLanes<false>(lanes, SamplesToDo);
+}
+
+
 template<>
 void Mix_<NEONTag>(const al::span<const float> InSamples,const al::span<FloatBufferLine> OutBuffer,
     const al::span<float> CurrentGains, const al::span<const float> TargetGains,
@@ -15,6 +15,7 @@
 #include "core/bsinc_defs.h"
 #include "core/bufferline.h"
 #include "core/cubic_defs.h"
+#include "core/filters/biquad.h"
 #include "core/mixer/hrtfdefs.h"
 #include "core/resampler_limits.h"
 #include "defs.h"
@@ -196,6 +197,120 @@ force_inline void MixLine(const al::span<const float> InSamples, const al::span<
     }
 }
 
+
+/* A biquad stage for the lane filters, with each lane holding a different
+ * stream's coefficients and state.
+ */
+struct LaneStage {
+    __m128 b0, b1, b2, a1, a2;
+    __m128 z1, z2;
+};
+
+/* Loads the given filter of each lane. Lanes without that filter, or without
+ * a stream, get a pass-through filter.
+ */
+auto LoadLaneStage(const al::span<const FilterLane> lanes, BiquadFilter *FilterLane::*filter)
+    -> LaneStage
+{
+    alignas(16) std::array<std::array<float,FilterLaneCount>,7> params{};
+    params[0].fill(1.0f);
+    for(size_t i{0};i < lanes.size();++i)
+    {
+        if(const BiquadFilter *biquad{lanes[i].*filter})
+        {
+            const auto coeffs = biquad->getCoefficients();
+            const auto comps = biquad->getComponents();
+            for(size_t j{0};j < coeffs.size();++j)
+                params[j][i] = coeffs[j];
+            params[5][i] = comps[0];
+            params[6][i] = comps[1];
+        }
+    }
+    return LaneStage{_mm_load_ps(params[0].data()), _mm_load_ps(params[1].data()),
+        _mm_load_ps(params[2].data()), _mm_load_ps(params[3].data()),
+        _mm_load_ps(params[4].data()), _mm_load_ps(params[5].data()),
+        _mm_load_ps(params[6].data())};
+}
+
+void StoreLaneStage(const al::span<const FilterLane> lanes, BiquadFilter *FilterLane::*filter,
+    const LaneStage &stage)
+{
+    alignas(16) std::array<float,FilterLaneCount> z1{};
+    alignas(16) std::array<float,FilterLaneCount> z2{};
+    _mm_store_ps(z1.data(), stage.z1);
+    _mm_store_ps(z2.data(), stage.z2);
+    for(size_t i{0};i < lanes.size();++i)
+    {
+        if(BiquadFilter *biquad{lanes[i].*filter})
+            biquad->setComponents(z1[i], z2[i]);
+    }
+}
+
+/* Same as BiquadFilter::processOne, for each lane. The operations are kept in
+ * the same order so the results match the scalar filter.
+ */
+force_inline auto ProcessLaneStage(LaneStage &stage, const __m128 input) noexcept -> __m128
+{
+    const __m128 output{_mm_add_ps(_mm_mul_ps(input, stage.b0), stage.z1)};
+    stage.z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(input, stage.b1),
+        _mm_mul_ps(output, stage.a1)), stage.z2);
+    stage.z2 = _mm_sub_ps(_mm_mul_ps(input, stage.b2), _mm_mul_ps(output, stage.a2));
+    return output;
+}
+
+template<bool Dual>
+void FilterLanes(const al::span<const FilterLane> lanes, const size_t SamplesToDo)
+{
+    LaneStage first{LoadLaneStage(lanes, &FilterLane::mFirst)};
+    LaneStage second{Dual ? LoadLaneStage(lanes, &FilterLane::mSecond) : first};
+    auto process = [&first,&second](const __m128 input) -> __m128
+    {
+        if constexpr(Dual)
+            return ProcessLaneStage(second, ProcessLaneStage(first, input));
+        else
+            return ProcessLaneStage(first, input);
+    };
+
+    /* Unused lanes repeat the first stream's input, and drop their output. */
+    std::array<const float*,FilterLaneCount> src{};
+    for(size_t i{0};i < src.size();++i)
+        src[i] = lanes[(i < lanes.size()) ? i : 0].mSrc.data();
+
+    /* Load four samples from each stream and transpose them, so each vector
+     * holds one sample of every stream, and transpose the output back.
+     */
+    size_t pos{0};
+    for(;pos < (SamplesToDo&~3_uz);pos += 4)
+    {
+        __m128 val0{_mm_loadu_ps(&src[0][pos])};
+        __m128 val1{_mm_loadu_ps(&src[1][pos])};
+        __m128 val2{_mm_loadu_ps(&src[2][pos])};
+        __m128 val3{_mm_loadu_ps(&src[3][pos])};
+        _MM_TRANSPOSE4_PS(val0, val1, val2, val3);
+        val0 = process(val0);
+        val1 = process(val1);
+        val2 = process(val2);
+        val3 = process(val3);
+        _MM_TRANSPOSE4_PS(val0, val1, val2, val3);
+        _mm_storeu_ps(&lanes[0].mDst[pos], val0);
+        if(lanes.size() > 1) _mm_storeu_ps(&lanes[1].mDst[pos], val1);
+        if(lanes.size() > 2) _mm_storeu_ps(&lanes[2].mDst[pos], val2);
+        if(lanes.size() > 3) _mm_storeu_ps(&lanes[3].mDst[pos], val3);
+    }
+    for(;pos < SamplesToDo;++pos)
+    {
+        alignas(16) std::array<float,FilterLaneCount> vals{src[0][pos], src[1][pos],
+            src[2][pos], src[3][pos]};
+        _mm_store_ps(vals.data(), process(_mm_load_ps(vals.data())));
+        for(size_t i{0};i < lanes.size();++i)
+            lanes[i].mDst[pos] = vals[i];
+    }
+
+    StoreLaneStage(lanes, &FilterLane::mFirst, first);
+    if constexpr(Dual)
+        StoreLaneStage(lanes, &FilterLane::mSecond, second);
+}
+
 } // namespace
 
 template<>
@@ -359,6 +474,21 @@ void MixDirectHrtf_<SSETag>(const FloatBufferSpan LeftOut, const FloatBufferSpan
 }
 
 
+template<>
+void FilterLanes_<SSETag>(const al::span<FilterLane> lanes, const size_t SamplesToDo)
+{
+    if(lanes.size() < 2)
+        return FilterLanes_<CTag>(lanes, SamplesToDo);
+
+    const bool dual{std::any_of(lanes.begin(), lanes.end(),
+        [](const FilterLane &lane) noexcept { return lane.mSecond != nullptr; })};
+    if(dual)
+        FilterLanes<true>(lanes, SamplesToDo);
+    else
+        FilterLanes<false>(lanes, SamplesToDo);
+}
+
+
 template<>
 void Mix_<SSETag>(const al::span<const float> InSamples, const al::span<FloatBufferLine> OutBuffer,
     const al::span<float> CurrentGains, const al::span<const float> TargetGains,
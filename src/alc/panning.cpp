@@ -61,6 +61,7 @@
 #include "core/front_stablizer.h"
 #include "core/hrtf.h"
 #include "core/logging.h"
+#include "core/mixer.h"
 #include "core/mixer/hrtfdefs.h"
 #include "core/uhjfilter.h"
 #include "device.h"
@@ -164,16 +165,56 @@ std::unique_ptr<FrontStablizer> CreateStablizer(const size_t outchans, const uin
     return stablizer;
 }
 
-void AllocChannels(al::Device *device, const size_t main_chans, const size_t real_chans)
+/* Sets up the first-order mix's channel mapping, and the gains and HF scaling
+ * to up-convert it to the dry mix.
+ */
+void InitLowOrderMix(al::Device *device)
 {
-    TRACE("Channel config, Main: {}, Real: {}", main_chans, real_chans);
+    const auto acnmap = device->m2DMixing
+        ? al::span{AmbiIndex::FromACN2D}.first(Ambi2DChannelsFromOrder(1))
+        : al::span{AmbiIndex::FromACN}.first(AmbiChannelsFromOrder(1));
+    const auto iter = std::transform(acnmap.cbegin(), acnmap.cend(),
+        device->LowOrder.AmbiMap.begin(),
+        [](const uint8_t &acn) noexcept -> BFChannelConfig { return BFChannelConfig{1.0f, acn}; });
+    std::fill(iter, device->LowOrder.AmbiMap.end(), BFChannelConfig{});
 
-    /* Allocate extra channels for any post-filter output. */
-    const size_t num_chans{main_chans + real_chans};
+    const auto upsampler = device->m2DMixing ? al::span{AmbiScale::FirstOrder2DUp}
+        : al::span{AmbiScale::FirstOrderUp};
+    const auto scales = AmbiScale::GetHFOrderScales(1, device->mAmbiOrder, device->m2DMixing);
+    const BandSplitter splitter{device->mXOverFreq / static_cast<float>(device->Frequency)};
+    for(size_t i{0};i < acnmap.size();++i)
+    {
+        const size_t acn{acnmap[i]};
+        ComputePanGains(&device->Dry, upsampler[acn], 1.0f, device->mLowOrderGains[i]);
+        device->mLowOrderHFScales[i] = scales[AmbiIndex::OrderFromChannel[acn]];
+        device->mLowOrderSplitters[i] = splitter;
+    }
+}
 
-    TRACE("Allocating {} channels, {} bytes", num_chans,
-        num_chans*sizeof(device->MixBuffer[0]));
-    device->MixBuffer.resize(num_chans);
+void AllocChannels(al::Device *device, const size_t main_chans, const size_t real_chans)
+{
+    /* Voices can be panned to a separate first-order mix when the dry mix is
+     * higher-order, except with HRTF where they're rendered directly.
+     */
+    const size_t low_chans{(device->mAmbiOrder < 2 || device->mRenderMode == RenderMode::Hrtf)
+        ? 0u : device->m2DMixing ? Ambi2DChannelsFromOrder(1) : AmbiChannelsFromOrder(1)};
+    TRACE("Channel config, Main: {}, Real: {}, Low-order: {}", main_chans, real_chans,
+        low_chans);
+
+    /* Allocate extra channels for any post-filter output, and the first-order
+     * mix. Keeping them together lets them all be cleared and have partial
+     * mixes in one go.
+     */
+    const size_t num_chans{main_chans + real_chans + low_chans};
+
+    /* Each mixing group gets a copy of the channels following the main mix,
+     * to hold its partial mix.
+     */
+    const size_t total_chans{num_chans * (1u+device->mMixGroupCount)};
+    TRACE("Allocating {} channels, {} bytes", total_chans,
+        total_chans*sizeof(device->MixBuffer[0]));
+    device->MixBuffer.resize(total_chans);
+    device->mMixChannels = static_cast<uint>(num_chans);
     al::span<FloatBufferLine> buffer{device->MixBuffer};
 
     device->Dry.Buffer = buffer.first(main_chans);
@@ -185,6 +226,10 @@ void AllocChannels(al::Device *device, const size_t main_chans, const size_t rea
     }
     else
         device->RealOut.Buffer = device->Dry.Buffer;
+
+    device->LowOrder.Buffer = buffer.first(low_chans);
+    if(low_chans != 0)
+        InitLowOrderMix(device);
 }
 
 
@@ -1155,11 +1200,12 @@ void aluInitRenderer(al::Device *device, int hrtf_id, std::optional<StereoEncodi
     {
         if(device->mHrtfList.empty())
             device->enumerateHrtfs();
+        const auto cachepath = device->configValue<std::string>({}, "hrtf-cache-path");
 
         if(hrtf_id >= 0 && static_cast<uint>(hrtf_id) < device->mHrtfList.size())
         {
             const std::string_view hrtfname{device->mHrtfList[static_cast<uint>(hrtf_id)]};
-            if(HrtfStorePtr hrtf{GetLoadedHrtf(hrtfname, device->Frequency)})
+            if(HrtfStorePtr hrtf{GetLoadedHrtf(hrtfname, device->Frequency, cachepath)})
             {
                 device->mHrtf = std::move(hrtf);
                 device->mHrtfName = hrtfname;
@@ -1170,7 +1216,7 @@ void aluInitRenderer(al::Device *device, int hrtf_id, std::optional<StereoEncodi
         {
             for(const std::string_view hrtfname : device->mHrtfList)
             {
-                if(HrtfStorePtr hrtf{GetLoadedHrtf(hrtfname, device->Frequency)})
+                if(HrtfStorePtr hrtf{GetLoadedHrtf(hrtfname, device->Frequency, cachepath)})
                 {
                     device->mHrtf = std::move(hrtf);
                     device->mHrtfName = hrtfname;
@@ -1254,11 +1300,27 @@ void aluInitEffectPanning(EffectSlot *slot, ALCcontext *context)
     DeviceBase *device{context->mDevice};
     const size_t count{AmbiChannelsFromOrder(device->mAmbiOrder)};
 
-    slot->mWetBuffer.resize(count);
+    /* Extra copies follow the wet buffer for the partial mix of each mixing
+     * group.
+     */
+    slot->mWetBuffer.resize(count * (1u+device->mMixGroupCount));
 
     const auto acnmap = al::span{AmbiIndex::FromACN}.first(count);
     const auto iter = std::transform(acnmap.cbegin(), acnmap.cend(), slot->Wet.AmbiMap.begin(),
         [](const uint8_t &acn) noexcept -> BFChannelConfig { return BFChannelConfig{1.0f, acn}; });
     std::fill(iter, slot->Wet.AmbiMap.end(), BFChannelConfig{});
-    slot->Wet.Buffer = slot->mWetBuffer;
+    slot->Wet.Buffer = al::span{slot->mWetBuffer}.first(count);
+
+    /* When mixing in groups, effects may also be processed concurrently, and
+     * need somewhere to write their output that's large enough for any output
+     * target.
+     */
+    if(device->mMixGroupCount > 0)
+        slot->mOutputBuffer.resize(std::max({count, device->Dry.Buffer.size(),
+            device->RealOut.Buffer.size()}));
+    else
+    {
+        slot->mOutputBuffer.clear();
+        slot->mOutputBuffer.shrink_to_fit();
+    }
 }
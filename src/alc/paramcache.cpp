@@ -0,0 +1,63 @@
+#include "config.h"
+
+#include "paramcache.h"
+
+#include <variant>
+
+#include "albit.h"
+
+
+namespace {
+
+constexpr auto HashBits(const uint a, const uint b, const uint c) noexcept -> uint
+{
+    /* Multiplicative hashing. The top bits of the result select the entry. */
+    return (a*0x9e3779b1u) ^ (b*0x85ebca77u) ^ (c*0xc2b2ae3du);
+}
+
+} // namespace
+
+ResamplerFunc ParamCache::prepareResampler(Resampler resampler, uint increment,
+    InterpState *state)
+{
+    const auto hash = HashBits(increment, static_cast<uint>(resampler), 0u);
+    auto &entry = mResamplers[hash >> (32u-CacheBits)];
+    if(entry.mFunc && entry.mIncrement == increment && entry.mResampler == resampler)
+    {
+        mResamplerHits.store(mResamplerHits.load(std::memory_order_relaxed)+1u,
+            std::memory_order_relaxed);
+        *state = entry.mState;
+        return entry.mFunc;
+    }
+    mResamplerMisses.store(mResamplerMisses.load(std::memory_order_relaxed)+1u,
+        std::memory_order_relaxed);
+
+    entry.mFunc = PrepareResampler(resampler, increment, &entry.mState);
+    entry.mIncrement = increment;
+    entry.mResampler = resampler;
+    *state = entry.mState;
+    return entry.mFunc;
+}
+
+void ParamCache::setShelfParams(BiquadFilter &filter, BiquadType type, float f0norm, float gain)
+{
+    const auto hash = HashBits(al::bit_cast<uint>(f0norm), al::bit_cast<uint>(gain),
+        static_cast<uint>(type));
+    auto &entry = mFilters[hash >> (32u-CacheBits)];
+    if(entry.mValid && entry.mType == type && entry.mF0Norm == f0norm && entry.mGain == gain)
+    {
+        mFilterHits.store(mFilterHits.load(std::memory_order_relaxed)+1u,
+            std::memory_order_relaxed);
+        filter.copyParamsFrom(entry.mFilter);
+        return;
+    }
+    mFilterMisses.store(mFilterMisses.load(std::memory_order_relaxed)+1u,
+        std::memory_order_relaxed);
+
+    entry.mFilter.setParamsFromSlope(type, f0norm, gain, 1.0f);
+    entry.mValid = true;
+    entry.mType = type;
+    entry.mF0Norm = f0norm;
+    entry.mGain = gain;
+    filter.copyParamsFrom(entry.mFilter);
+}
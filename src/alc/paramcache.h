@@ -0,0 +1,58 @@
+#ifndef CORE_PARAMCACHE_H
+#define CORE_PARAMCACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "filters/biquad.h"
+#include "mixer/defs.h"
+
+
+/* A cache of recently prepared voice parameters, for when many voices end up
+ * using the same pitch and filter properties. Each cache is a small direct-
+ * mapped table, with a new entry replacing whatever was in its slot. This is
+ * only used by the mixer when calculating voice parameters, so it needs no
+ * locking. The hit and miss counts are atomic so the app can query them (as
+ * AL_SOFT_parameter_cache_stats context values) while the mixer runs.
+ */
+class ParamCache {
+    static constexpr std::size_t CacheBits{6};
+    static constexpr std::size_t CacheSize{1u << CacheBits};
+
+    struct ResamplerEntry {
+        ResamplerFunc mFunc{};
+        uint mIncrement{};
+        Resampler mResampler{};
+        InterpState mState;
+    };
+    std::array<ResamplerEntry,CacheSize> mResamplers{};
+
+    struct FilterEntry {
+        bool mValid{false};
+        BiquadType mType{};
+        float mF0Norm{};
+        float mGain{};
+        BiquadFilter mFilter;
+    };
+    std::array<FilterEntry,CacheSize> mFilters{};
+
+public:
+    std::atomic<std::uint64_t> mResamplerHits{0u};
+    std::atomic<std::uint64_t> mResamplerMisses{0u};
+    std::atomic<std::uint64_t> mFilterHits{0u};
+    std::atomic<std::uint64_t> mFilterMisses{0u};
+
+    /** Same as PrepareResampler, reusing a previous result if available. */
+    ResamplerFunc prepareResampler(Resampler resampler, uint increment, InterpState *state);
+
+    /**
+     * Sets the filter coefficients for the given shelf filter type, as with
+     * filter.setParamsFromSlope(type, f0norm, gain, 1.0f), reusing previously
+     * calculated coefficients if available.
+     */
+    void setShelfParams(BiquadFilter &filter, BiquadType type, float f0norm, float gain);
+};
+
+#endif /* CORE_PARAMCACHE_H */
@@ -0,0 +1,93 @@
+#ifndef CORE_SOURCE_COMMAND_H
+#define CORE_SOURCE_COMMAND_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+using uint = unsigned int;
+
+
+enum class SourceCommandType : std::uint8_t {
+    Play,
+    Pause,
+    Stop
+};
+
+struct SourceCommand {
+    uint mSourceID{0u};
+    SourceCommandType mType{};
+};
+
+/* A fixed-size queue of source commands. Any number of threads may push to it
+ * without locking or allocating, while only one thread at a time may pop from
+ * it. Each cell has a sequence number that tells whether it's free for the
+ * writer at a given position, or holds a command for the reader.
+ */
+class SourceCommandQueue {
+    static constexpr std::size_t QueueSize{1024};
+    static_assert((QueueSize&(QueueSize-1)) == 0, "QueueSize must be a power of 2");
+
+    struct Cell {
+        std::atomic<std::size_t> mSequence{};
+        SourceCommand mCommand{};
+    };
+    std::array<Cell,QueueSize> mCells{};
+
+    std::atomic<std::size_t> mWritePos{0u};
+    std::size_t mReadPos{0u};
+
+public:
+    SourceCommandQueue() noexcept
+    {
+        for(std::size_t i{0};i < mCells.size();++i)
+            mCells[i].mSequence.store(i, std::memory_order_relaxed);
+    }
+    SourceCommandQueue(const SourceCommandQueue&) = delete;
+    SourceCommandQueue& operator=(const SourceCommandQueue&) = delete;
+
+    /** Adds a command to the queue. Returns false if the queue is full. */
+    bool push(const SourceCommand &cmd) noexcept
+    {
+        std::size_t pos{mWritePos.load(std::memory_order_relaxed)};
+        while(true)
+        {
+            Cell &cell = mCells[pos & (QueueSize-1)];
+            const std::size_t seq{cell.mSequence.load(std::memory_order_acquire)};
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if(diff == 0)
+            {
+                if(mWritePos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+                {
+                    cell.mCommand = cmd;
+                    cell.mSequence.store(pos+1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff < 0)
+                return false;
+            else
+                pos = mWritePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Removes the next command from the queue, if any. Must not be called by
+     * more than one thread at a time.
+     */
+    std::optional<SourceCommand> pop() noexcept
+    {
+        Cell &cell = mCells[mReadPos & (QueueSize-1)];
+        if(cell.mSequence.load(std::memory_order_acquire) != mReadPos+1)
+            return std::nullopt;
+
+        const SourceCommand cmd{cell.mCommand};
+        cell.mSequence.store(mReadPos+QueueSize, std::memory_order_release);
+        ++mReadPos;
+        return cmd;
+    }
+};
+
+#endif /* CORE_SOURCE_COMMAND_H */
@@ -12,6 +12,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <new>
 #include <optional>
@@ -46,6 +47,12 @@ struct CTag;
 #if HAVE_SSE
 struct SSETag;
 #endif
+#if HAVE_AVX
+struct AVXTag;
+#endif
+#if HAVE_AVX2
+struct AVX2Tag;
+#endif
 #if HAVE_NEON
 struct NEONTag;
 #endif
@@ -71,8 +78,11 @@ using HrtfMixerBlendFunc = void(*)(const al::span<const float> InSamples,
     const al::span<float2> AccumSamples, const uint IrSize, const HrtfFilter *oldparams,
     const MixHrtfFilter *newparams, const size_t SamplesToDo);
 
+using FilterLanesFunc = void(*)(const al::span<FilterLane> lanes, const size_t SamplesToDo);
+
 HrtfMixerFunc MixHrtfSamples{MixHrtf_<CTag>};
 HrtfMixerBlendFunc MixHrtfBlendSamples{MixHrtfBlend_<CTag>};
+FilterLanesFunc FilterLanes{FilterLanes_<CTag>};
 
 inline MixerOutFunc SelectMixer()
 {
@@ -80,6 +90,14 @@ inline MixerOutFunc SelectMixer()
     if((CPUCapFlags&CPU_CAP_NEON))
         return Mix_<NEONTag>;
 #endif
+#if HAVE_AVX2
+    if((CPUCapFlags&CPU_CAP_AVX2) && (CPUCapFlags&CPU_CAP_FMA3))
+        return Mix_<AVX2Tag>;
+#endif
+#if HAVE_AVX
+    if((CPUCapFlags&CPU_CAP_AVX))
+        return Mix_<AVXTag>;
+#endif
 #if HAVE_SSE
     if((CPUCapFlags&CPU_CAP_SSE))
         return Mix_<SSETag>;
@@ -93,6 +111,14 @@ inline MixerOneFunc SelectMixerOne()
     if((CPUCapFlags&CPU_CAP_NEON))
         return Mix_<NEONTag>;
 #endif
+#if HAVE_AVX2
+    if((CPUCapFlags&CPU_CAP_AVX2) && (CPUCapFlags&CPU_CAP_FMA3))
+        return Mix_<AVX2Tag>;
+#endif
+#if HAVE_AVX
+    if((CPUCapFlags&CPU_CAP_AVX))
+        return Mix_<AVXTag>;
+#endif
 #if HAVE_SSE
     if((CPUCapFlags&CPU_CAP_SSE))
         return Mix_<SSETag>;
@@ -106,6 +132,14 @@ inline HrtfMixerFunc SelectHrtfMixer()
     if((CPUCapFlags&CPU_CAP_NEON))
         return MixHrtf_<NEONTag>;
 #endif
+#if HAVE_AVX2
+    if((CPUCapFlags&CPU_CAP_AVX2) && (CPUCapFlags&CPU_CAP_FMA3))
+        return MixHrtf_<AVX2Tag>;
+#endif
+#if HAVE_AVX
+    if((CPUCapFlags&CPU_CAP_AVX))
+        return MixHrtf_<AVXTag>;
+#endif
 #if HAVE_SSE
     if((CPUCapFlags&CPU_CAP_SSE))
         return MixHrtf_<SSETag>;
@@ -119,6 +153,14 @@ inline HrtfMixerBlendFunc SelectHrtfBlendMixer()
     if((CPUCapFlags&CPU_CAP_NEON))
         return MixHrtfBlend_<NEONTag>;
 #endif
+#if HAVE_AVX2
+    if((CPUCapFlags&CPU_CAP_AVX2) && (CPUCapFlags&CPU_CAP_FMA3))
+        return MixHrtfBlend_<AVX2Tag>;
+#endif
+#if HAVE_AVX
+    if((CPUCapFlags&CPU_CAP_AVX))
+        return MixHrtfBlend_<AVXTag>;
+#endif
 #if HAVE_SSE
     if((CPUCapFlags&CPU_CAP_SSE))
         return MixHrtfBlend_<SSETag>;
@@ -126,6 +168,19 @@ inline HrtfMixerBlendFunc SelectHrtfBlendMixer()
     return MixHrtfBlend_<CTag>;
 }
 
+inline FilterLanesFunc SelectFilterLanes()
+{
+#if HAVE_NEON
+    if((CPUCapFlags&CPU_CAP_NEON))
+        return FilterLanes_<NEONTag>;
+#endif
+#if HAVE_SSE
+    if((CPUCapFlags&CPU_CAP_SSE))
+        return FilterLanes_<SSETag>;
+#endif
+    return FilterLanes_<CTag>;
+}
+
 } // namespace
 
 void Voice::InitMixer(std::optional<std::string> resopt)
@@ -180,6 +235,7 @@ void Voice::InitMixer(std::optional<std::string> resopt)
     MixSamplesOne = SelectMixerOne();
     MixHrtfBlendSamples = SelectHrtfBlendMixer();
     MixHrtfSamples = SelectHrtfMixer();
+    FilterLanes = SelectFilterLanes();
 }
 
 
@@ -242,37 +298,43 @@ void SendSourceStoppedEvent(ContextBase *context, uint id)
 }
 
 
-al::span<const float> DoFilters(BiquadFilter &lpfilter, BiquadFilter &hpfilter,
-    const al::span<float,BufferLineSize> dst, const al::span<const float> src, int type)
+/* Sets up the lane filter stream for the given filter type, returning false if
+ * the samples are used unfiltered.
+ */
+bool PrepareFilterLane(FilterLane &lane, BiquadFilter &lpfilter, BiquadFilter &hpfilter,
+    int type)
 {
     switch(type)
     {
     case AF_None:
-        lpfilter.clear();
-        hpfilter.clear();
         break;
 
     case AF_LowPass:
-        lpfilter.process(src, dst);
         hpfilter.clear();
-        return dst.first(src.size());
+        lane.mFirst = &lpfilter;
+        lane.mSecond = nullptr;
+        return true;
     case AF_HighPass:
         lpfilter.clear();
-        hpfilter.process(src, dst);
-        return dst.first(src.size());
+        lane.mFirst = &hpfilter;
+        lane.mSecond = nullptr;
+        return true;
 
     case AF_BandPass:
-        DualBiquad{lpfilter, hpfilter}.process(src, dst);
-        return dst.first(src.size());
+        lane.mFirst = &lpfilter;
+        lane.mSecond = &hpfilter;
+        return true;
     }
-    return src;
+    lpfilter.clear();
+    hpfilter.clear();
+    return false;
 }
 
 
 template<FmtType Type>
 inline void LoadSamples(const al::span<float> dstSamples, const al::span<const std::byte> srcData,
     const size_t srcChan, const size_t srcOffset, const size_t srcStep,
-    const size_t samplesPerBlock [[maybe_unused]]) noexcept
+    const size_t samplesPerBlock [[maybe_unused]], ADPCMCache *cache [[maybe_unused]]) noexcept
 {
     using TypeTraits = al::FmtTypeTraits<Type>;
     using SampleType = typename TypeTraits::Type;
@@ -294,7 +356,7 @@ inline void LoadSamples(const al::span<float> dstSamples, const al::span<const s
 template<>
 inline void LoadSamples<FmtIMA4>(al::span<float> dstSamples, al::span<const std::byte> src,
     const size_t srcChan, const size_t srcOffset, const size_t srcStep,
-    const size_t samplesPerBlock) noexcept
+    const size_t samplesPerBlock, ADPCMCache *cache) noexcept
 {
     static constexpr int MaxStepIndex{static_cast<int>(IMAStep_size.size()) - 1};
 
@@ -308,13 +370,13 @@ inline void LoadSamples<FmtIMA4>(al::span<float> dstSamples, al::span<const std:
     /* Calculate how many samples need to be skipped in the block. */
     size_t skip{srcOffset % samplesPerBlock};
 
-    /* NOTE: This could probably be optimized better. */
     auto dst = dstSamples.begin();
     while(dst != dstSamples.end())
     {
         /* Each IMA4 block starts with a signed 16-bit sample, and a signed
          * 16-bit table index. The table index needs to be clamped.
          */
+        const std::byte *block{src.data()};
         int sample{int(src[srcChan*4 + 0]) | (int(src[srcChan*4 + 1]) << 8)};
         int index{int(src[srcChan*4 + 2]) | (int(src[srcChan*4 + 3]) << 8)};
         auto nibbleData = src.subspan((srcStep+srcChan)*4);
@@ -323,13 +385,27 @@ inline void LoadSamples<FmtIMA4>(al::span<float> dstSamples, al::span<const std:
         sample = (sample^0x8000) - 32768;
         index = std::clamp((index^0x8000) - 32768, 0, MaxStepIndex);
 
-        if(skip == 0)
+        /* The position in the block of the next sample to decode. If a state
+         * was saved from a previous load of this block, resume from it.
+         * Otherwise, drop any saved states for the block since its data may
+         * have been replaced (e.g. a refilled stream buffer).
+         */
+        size_t blockPos{1};
+        if(const auto *point = (cache && skip > 0) ? cache->find(block, skip) : nullptr)
         {
-            *dst = static_cast<float>(sample) / 32768.0f;
-            if(++dst == dstSamples.end()) return;
+            sample = point->mState[0];
+            index = point->mState[1];
+            blockPos = point->mOffset;
         }
         else
-            --skip;
+        {
+            if(cache) cache->forget(block);
+            if(skip == 0)
+            {
+                *dst = static_cast<float>(sample) / 32768.0f;
+                if(++dst == dstSamples.end()) return;
+            }
+        }
 
         auto decode_sample = [&sample,&index](const uint8_t nibble)
         {
@@ -351,9 +427,8 @@ inline void LoadSamples<FmtIMA4>(al::span<float> dstSamples, al::span<const std:
          * being ignored for proper state on the remaining samples.
          */
         static constexpr auto NibbleMask = std::byte{0xf};
-        size_t nibbleOffset{0};
-        const size_t startOffset{skip + 1};
-        for(;skip;--skip)
+        size_t nibbleOffset{blockPos - 1};
+        for(;blockPos < skip;++blockPos)
         {
             const size_t byteShift{(nibbleOffset&1) * 4};
             const size_t wordOffset{(nibbleOffset>>1) & ~3_uz};
@@ -363,11 +438,13 @@ inline void LoadSamples<FmtIMA4>(al::span<float> dstSamples, al::span<const std:
             const auto nval = (nibbleData[byteOffset]>>byteShift) & NibbleMask;
             std::ignore = decode_sample(al::to_underlying(nval));
         }
+        skip = 0;
 
         /* Second, decode the rest of the block and write to the output, until
-         * the end of the block or the end of output.
+         * the end of the block or the end of output. Save the decoder state
+         * periodically for the next load.
          */
-        const size_t todo{std::min(samplesPerBlock-startOffset, size_t(dstSamples.end()-dst))};
+        const size_t todo{std::min(samplesPerBlock-blockPos, size_t(dstSamples.end()-dst))};
         dst = std::generate_n(dst, todo, [&]
         {
             const size_t byteShift{(nibbleOffset&1) * 4};
@@ -376,7 +453,10 @@ inline void LoadSamples<FmtIMA4>(al::span<float> dstSamples, al::span<const std:
             ++nibbleOffset;
 
             const auto nval = (nibbleData[byteOffset]>>byteShift) & NibbleMask;
-            return static_cast<float>(decode_sample(al::to_underlying(nval))) / 32768.0f;
+            const int ret{decode_sample(al::to_underlying(nval))};
+            if(cache && (++blockPos%ADPCMCache::Interval) == 0)
+                cache->store(block, blockPos, {sample, index, 0});
+            return static_cast<float>(ret) / 32768.0f;
         });
     }
 }
@@ -384,7 +464,7 @@ inline void LoadSamples<FmtIMA4>(al::span<float> dstSamples, al::span<const std:
 template<>
 inline void LoadSamples<FmtMSADPCM>(al::span<float> dstSamples, al::span<const std::byte> src,
     const size_t srcChan, const size_t srcOffset, const size_t srcStep,
-    const size_t samplesPerBlock) noexcept
+    const size_t samplesPerBlock, ADPCMCache *cache) noexcept
 {
     assert(srcStep > 0 || srcStep <= 2);
     assert(srcChan < srcStep);
@@ -403,6 +483,7 @@ inline void LoadSamples<FmtMSADPCM>(al::span<float> dstSamples, al::span<const s
          * nibble sample value. This is followed by the two initial 16-bit
          * sample history values.
          */
+        const std::byte *block{src.data()};
         const uint8_t blockpred{std::min(uint8_t(src[srcChan]), uint8_t{6})};
         int delta{int(src[srcStep + 2*srcChan + 0]) | (int(src[srcStep + 2*srcChan + 1]) << 8)};
 
@@ -420,21 +501,30 @@ inline void LoadSamples<FmtMSADPCM>(al::span<float> dstSamples, al::span<const s
         /* The second history sample is "older", so it's the first to be
          * written out.
          */
-        if(skip == 0)
+        size_t blockPos{2};
+        if(const auto *point = (cache && skip > 1) ? cache->find(block, skip) : nullptr)
         {
-            *dst = static_cast<float>(sampleHistory[1]) / 32768.0f;
-            if(++dst == dstSamples.end()) return;
-            *dst = static_cast<float>(sampleHistory[0]) / 32768.0f;
-            if(++dst == dstSamples.end()) return;
+            sampleHistory[0] = point->mState[0];
+            sampleHistory[1] = point->mState[1];
+            delta = point->mState[2];
+            blockPos = point->mOffset;
         }
-        else if(skip == 1)
+        else
         {
-            --skip;
-            *dst = static_cast<float>(sampleHistory[0]) / 32768.0f;
-            if(++dst == dstSamples.end()) return;
+            if(cache) cache->forget(block);
+            if(skip == 0)
+            {
+                *dst = static_cast<float>(sampleHistory[1]) / 32768.0f;
+                if(++dst == dstSamples.end()) return;
+                *dst = static_cast<float>(sampleHistory[0]) / 32768.0f;
+                if(++dst == dstSamples.end()) return;
+            }
+            else if(skip == 1)
+            {
+                *dst = static_cast<float>(sampleHistory[0]) / 32768.0f;
+                if(++dst == dstSamples.end()) return;
+            }
         }
-        else
-            skip -= 2;
 
         auto decode_sample = [&sampleHistory,&delta,coeffs](const uint8_t nibble)
         {
@@ -455,9 +545,8 @@ inline void LoadSamples<FmtMSADPCM>(al::span<float> dstSamples, al::span<const s
          * channel. First, skip samples.
          */
         static constexpr auto NibbleMask = std::byte{0xf};
-        const size_t startOffset{skip + 2};
-        size_t nibbleOffset{srcChan};
-        for(;skip;--skip)
+        size_t nibbleOffset{(blockPos-2)*srcStep + srcChan};
+        for(;blockPos < skip;++blockPos)
         {
             const size_t byteOffset{nibbleOffset>>1};
             const size_t byteShift{((nibbleOffset&1)^1) * 4};
@@ -466,11 +555,12 @@ inline void LoadSamples<FmtMSADPCM>(al::span<float> dstSamples, al::span<const s
             const auto nval = (input[byteOffset]>>byteShift) & NibbleMask;
             std::ignore = decode_sample(al::to_underlying(nval));
         }
+        skip = 0;
 
         /* Now decode the rest of the block, until the end of the block or the
-         * dst buffer is filled.
+         * dst buffer is filled, periodically saving the decoder state.
          */
-        const size_t todo{std::min(samplesPerBlock-startOffset, size_t(dstSamples.end()-dst))};
+        const size_t todo{std::min(samplesPerBlock-blockPos, size_t(dstSamples.end()-dst))};
         dst = std::generate_n(dst, todo, [&]
         {
             const size_t byteOffset{nibbleOffset>>1};
@@ -478,18 +568,21 @@ inline void LoadSamples<FmtMSADPCM>(al::span<float> dstSamples, al::span<const s
             nibbleOffset += srcStep;
 
             const auto nval = (input[byteOffset]>>byteShift) & NibbleMask;
-            return static_cast<float>(decode_sample(al::to_underlying(nval))) / 32768.0f;
+            const int ret{decode_sample(al::to_underlying(nval))};
+            if(cache && (++blockPos%ADPCMCache::Interval) == 0)
+                cache->store(block, blockPos, {sampleHistory[0], sampleHistory[1], delta});
+            return static_cast<float>(ret) / 32768.0f;
         });
     }
 }
 
 void LoadSamples(const al::span<float> dstSamples, const al::span<const std::byte> src,
     const size_t srcChan, const size_t srcOffset, const FmtType srcType, const size_t srcStep,
-    const size_t samplesPerBlock) noexcept
+    const size_t samplesPerBlock, ADPCMCache *cache) noexcept
 {
 #define HANDLE_FMT(T) case T:                                                 \
     LoadSamples<T>(dstSamples, src, srcChan, srcOffset, srcStep,              \
-        samplesPerBlock);                                                     \
+        samplesPerBlock, cache);                                              \
     break
 
     switch(srcType)
@@ -509,7 +602,7 @@ void LoadSamples(const al::span<float> dstSamples, const al::span<const std::byt
 
 void LoadBufferStatic(VoiceBufferItem *buffer, VoiceBufferItem *bufferLoopItem,
     const size_t dataPosInt, const FmtType sampleType, const size_t srcChannel,
-    const size_t srcStep, al::span<float> voiceSamples)
+    const size_t srcStep, al::span<float> voiceSamples, ADPCMCache *cache)
 {
     if(!bufferLoopItem)
     {
@@ -520,7 +613,7 @@ void LoadBufferStatic(VoiceBufferItem *buffer, VoiceBufferItem *bufferLoopItem,
             const size_t buffer_remaining{buffer->mSampleLen - dataPosInt};
             const size_t remaining{std::min(voiceSamples.size(), buffer_remaining)};
             LoadSamples(voiceSamples.first(remaining), buffer->mSamples, srcChannel, dataPosInt,
-                sampleType, srcStep, buffer->mBlockAlign);
+                sampleType, srcStep, buffer->mBlockAlign, cache);
             lastSample = voiceSamples[remaining-1];
             voiceSamples = voiceSamples.subspan(remaining);
         }
@@ -540,7 +633,7 @@ void LoadBufferStatic(VoiceBufferItem *buffer, VoiceBufferItem *bufferLoopItem,
         /* Load what's left of this loop iteration */
         const size_t remaining{std::min(voiceSamples.size(), loopEnd-dataPosInt)};
         LoadSamples(voiceSamples.first(remaining), buffer->mSamples, srcChannel, intPos,
-            sampleType, srcStep, buffer->mBlockAlign);
+            sampleType, srcStep, buffer->mBlockAlign, cache);
         voiceSamples = voiceSamples.subspan(remaining);
 
         /* Load repeats of the loop to fill the buffer. */
@@ -548,7 +641,7 @@ void LoadBufferStatic(VoiceBufferItem *buffer, VoiceBufferItem *bufferLoopItem,
         while(const size_t toFill{std::min(voiceSamples.size(), loopSize)})
         {
             LoadSamples(voiceSamples.first(toFill), buffer->mSamples, srcChannel, loopStart,
-                sampleType, srcStep, buffer->mBlockAlign);
+                sampleType, srcStep, buffer->mBlockAlign, cache);
             voiceSamples = voiceSamples.subspan(toFill);
         }
     }
@@ -563,7 +656,7 @@ void LoadBufferCallback(VoiceBufferItem *buffer, const size_t dataPosInt,
     {
         const size_t remaining{std::min(voiceSamples.size(), numCallbackSamples-dataPosInt)};
         LoadSamples(voiceSamples.first(remaining), buffer->mSamples, srcChannel, dataPosInt,
-            sampleType, srcStep, buffer->mBlockAlign);
+            sampleType, srcStep, buffer->mBlockAlign, nullptr);
         lastSample = voiceSamples[remaining-1];
         voiceSamples = voiceSamples.subspan(remaining);
     }
@@ -574,7 +667,7 @@ void LoadBufferCallback(VoiceBufferItem *buffer, const size_t dataPosInt,
 
 void LoadBufferQueue(VoiceBufferItem *buffer, VoiceBufferItem *bufferLoopItem,
     size_t dataPosInt, const FmtType sampleType, const size_t srcChannel,
-    const size_t srcStep, al::span<float> voiceSamples)
+    const size_t srcStep, al::span<float> voiceSamples, ADPCMCache *cache)
 {
     float lastSample{0.0f};
     /* Crawl the buffer queue to fill in the temp buffer */
@@ -590,7 +683,7 @@ void LoadBufferQueue(VoiceBufferItem *buffer, VoiceBufferItem *bufferLoopItem,
 
         const size_t remaining{std::min(voiceSamples.size(), buffer->mSampleLen-dataPosInt)};
         LoadSamples(voiceSamples.first(remaining), buffer->mSamples, srcChannel, dataPosInt,
-            sampleType, srcStep, buffer->mBlockAlign);
+            sampleType, srcStep, buffer->mBlockAlign, cache);
 
         lastSample = voiceSamples[remaining-1];
         voiceSamples = voiceSamples.subspan(remaining);
@@ -606,12 +699,94 @@ void LoadBufferQueue(VoiceBufferItem *buffer, VoiceBufferItem *bufferLoopItem,
 }
 
 
+void SendMixEvents(ContextBase *context, const uint id, const uint buffers_done,
+    const bool stopped, const bool oneshot)
+{
+    /* One-shot sounds don't send events to the app. Their sources are instead
+     * handed back for reuse once they stop.
+     */
+    if(oneshot)
+    {
+        if(stopped)
+        {
+            if(RingBuffer *ring{context->mOneShotsDone.get()})
+                std::ignore = ring->write(&id, 1);
+        }
+        return;
+    }
+
+    const auto enabledevt = context->mEnabledEvts.load(std::memory_order_acquire);
+    if(buffers_done > 0 && enabledevt.test(al::to_underlying(AsyncEnableBits::BufferCompleted)))
+    {
+        RingBuffer *ring{context->mAsyncEvents.get()};
+        auto evt_vec = ring->getWriteVector();
+        if(evt_vec[0].len > 0)
+        {
+            auto &evt = InitAsyncEvent<AsyncBufferCompleteEvent>(evt_vec[0].buf);
+            evt.mId = id;
+            evt.mCount = buffers_done;
+            ring->writeAdvance(1);
+        }
+    }
+
+    if(stopped && enabledevt.test(al::to_underlying(AsyncEnableBits::SourceState)))
+        SendSourceStoppedEvent(context, id);
+}
+
+
+/* Number of samples a voice fades out over when reaching a scheduled stop. */
+constexpr int ScheduledStopFade{64};
+
+/* Applies the scheduled gain ramp and stop fade to the voice's samples, which
+ * start at output offset OutPos of the update starting at deviceTime. StopPos
+ * is the output offset the stop fade starts at.
+ */
+void ApplyScheduledGain(const al::span<float*> channels, const uint count,
+    const VoiceGainRamp &ramp, const nanoseconds deviceTime, const uint OutPos,
+    const int StopPos, const uint frequency)
+{
+    const auto get_time = [deviceTime,frequency](const uint pos) noexcept
+    { return deviceTime + nanoseconds{seconds{pos}}/frequency; };
+
+    const uint endPos{OutPos + count};
+    if(StopPos >= static_cast<int>(endPos))
+    {
+        /* If the ramp doesn't change over these samples, they all get the same
+         * gain.
+         */
+        const auto start = get_time(OutPos);
+        const auto end = get_time(endPos);
+        if(end <= ramp.mStart || start >= ramp.mEnd)
+        {
+            const float gain{ramp.at(start)};
+            if(gain == 1.0f) LIKELY return;
+
+            for(float *samples : channels)
+                std::transform(samples, samples+count, samples,
+                    [gain](const float s) noexcept -> float { return s * gain; });
+            return;
+        }
+    }
+
+    for(uint i{0};i < count;++i)
+    {
+        const int pos{static_cast<int>(OutPos + i)};
+        const float stopgain{std::clamp(static_cast<float>(StopPos+ScheduledStopFade-pos)
+            / static_cast<float>(ScheduledStopFade), 0.0f, 1.0f)};
+        const float gain{ramp.at(get_time(OutPos + i)) * stopgain};
+        for(float *samples : channels)
+            samples[i] *= gain;
+    }
+}
+
+
 void DoHrtfMix(const al::span<const float> samples, DirectParams &parms, const float TargetGain,
-    const size_t Counter, size_t OutPos, const bool IsPlaying, DeviceBase *Device)
+    const size_t Counter, size_t OutPos, const bool IsPlaying, MixerScratch &Scratch,
+    DeviceBase *Device)
 {
-    const uint IrSize{Device->mIrSize};
-    const auto HrtfSamples = al::span{Device->ExtraSampleData};
-    const auto AccumSamples = al::span{Device->HrtfAccumData};
+    const uint IrSize{Device->getMixIrSize(Device->mIrSize)};
+    const auto HrtfSamples = al::span{Scratch.ExtraSampleData};
+    const auto AccumSamples = al::span{Scratch.HrtfAccumData};
 
     /* Copy the HRTF history and new input samples into a temp buffer. */
     auto src_iter = std::copy(parms.Hrtf.History.begin(), parms.Hrtf.History.end(),
@@ -685,7 +860,7 @@ void DoHrtfMix(const al::span<const float> samples, DirectParams &parms, const f
 
 void DoNfcMix(const al::span<const float> samples, al::span<FloatBufferLine> OutBuffer,
     DirectParams &parms, const al::span<const float,MaxOutputChannels> OutGains,
-    const uint Counter, const uint OutPos, DeviceBase *Device)
+    const uint Counter, const uint OutPos, MixerScratch &Scratch, DeviceBase *Device)
 {
     using FilterProc = void (NfcFilter::*)(const al::span<const float>, const al::span<float>);
     static constexpr std::array<FilterProc,MaxAmbiOrder+1> NfcProcess{{
@@ -697,7 +872,7 @@ void DoNfcMix(const al::span<const float> samples, al::span<FloatBufferLine> Out
     auto CurrentGains = al::span{parms.Gains.Current}.subspan(1);
     auto TargetGains = OutGains.subspan(1);
 
-    const auto nfcsamples = al::span{Device->ExtraSampleData}.first(samples.size());
+    const auto nfcsamples = al::span{Scratch.ExtraSampleData}.first(samples.size());
     size_t order{1};
     while(const size_t chancount{Device->NumChannelsPerOrder[order]})
     {
@@ -706,7 +881,10 @@ void DoNfcMix(const al::span<const float> samples, al::span<FloatBufferLine> Out
             OutPos);
         if(++order == MaxAmbiOrder+1)
             break;
+        /* A first-order mix ends before the device's order does. */
         OutBuffer = OutBuffer.subspan(chancount);
+        if(OutBuffer.empty())
+            break;
         CurrentGains = CurrentGains.subspan(chancount);
         TargetGains = TargetGains.subspan(chancount);
     }
@@ -715,10 +893,8 @@ void DoNfcMix(const al::span<const float> samples, al::span<FloatBufferLine> Out
 } // namespace
 
 void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds deviceTime,
-    const uint SamplesToDo)
+    const uint SamplesToDo, MixerScratch &Scratch, const uint Group)
 {
-    static constexpr std::array<float,MaxOutputChannels> SilentTarget{};
-
     ASSUME(SamplesToDo > 0);
 
     DeviceBase *Device{Context->mDevice};
@@ -751,6 +927,25 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
 
     uint OutPos{0u};
 
+    /* Get the output offset of a scheduled stop, which is where the voice
+     * starts fading out. This is negative if the fade started in a previous
+     * update.
+     */
+    int StopPos{std::numeric_limits<int>::max()};
+    if(mStopTime != nanoseconds::max()) UNLIKELY
+    {
+        const auto diff = std::max(mStopTime - deviceTime, -nanoseconds{seconds{1}});
+        if(diff < seconds{1})
+            StopPos = std::max(static_cast<int>(round<seconds>(diff * Device->Frequency).count()),
+                -ScheduledStopFade);
+    }
+
+    /* Ends the voice for a scheduled stop, as if it ran out of buffers. */
+    auto end_scheduled = [this,Context,DataPosInt,DataPosFrac,Group]
+    {
+        advancePosition(Context, DataPosInt, DataPosFrac, nullptr, nullptr, 0u, Group);
+    };
+
     /* Check if we're doing a delayed start, and we start in this update. */
     if(mStartTime > deviceTime) UNLIKELY
     {
@@ -773,15 +968,54 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
          * count.
          */
         OutPos = static_cast<uint>(round<seconds>(diff * Device->Frequency).count());
+
+        /* If a scheduled stop comes first, the voice ends without playing. */
+        if(StopPos <= static_cast<int>(std::min(OutPos, SamplesToDo)))
+        {
+            end_scheduled();
+            return;
+        }
         if(OutPos >= SamplesToDo) return;
     }
 
+    /* If the fade out for a scheduled stop finishes in this update, only mix
+     * up to the end of it.
+     */
+    const bool StopEnds{vstate == Playing
+        && StopPos <= static_cast<int>(SamplesToDo) - ScheduledStopFade};
+    const uint MixEnd{StopEnds ? static_cast<uint>(std::max(StopPos+ScheduledStopFade, 0))
+        : SamplesToDo};
+    if(MixEnd <= OutPos) UNLIKELY
+    {
+        end_scheduled();
+        return;
+    }
+
     /* Calculate the number of samples to mix, and the number of (resampled)
      * samples that need to be loaded (mixing samples and decoder padding).
      */
-    const uint samplesToMix{SamplesToDo - OutPos};
+    const uint samplesToMix{MixEnd - OutPos};
     const uint samplesToLoad{samplesToMix + mDecoderPadding};
 
+    /* A virtual voice that has faded out doesn't need to be decoded,
+     * resampled, or mixed. Only its position is advanced, and the resampler
+     * history for the end of the update is loaded so it can seamlessly
+     * resume.
+     */
+    if(vstate == Playing && mFlags.test(VoiceIsVirtual) && mFlags.test(VoiceFadedOut)
+        && BufferListItem)
+    {
+        if(StopEnds)
+        {
+            end_scheduled();
+            return;
+        }
+        loadVirtualHistory(DataPosInt, DataPosFrac, BufferListItem, BufferLoopItem, samplesToMix);
+        advancePosition(Context, DataPosInt, DataPosFrac, BufferListItem, BufferLoopItem,
+            samplesToMix, Group);
+        return;
+    }
+
     /* Get a span of pointers to hold the floating point, deinterlaced,
      * resampled buffer data to be mixed.
      */
@@ -789,7 +1023,7 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
     const auto MixingSamples = al::span{SamplePointers}.first(mChans.size());
     {
         const uint channelStep{(samplesToLoad+3u)&~3u};
-        auto base = Device->mSampleData.end() - MixingSamples.size()*channelStep;
+        auto base = Scratch.mSampleData.end() - MixingSamples.size()*channelStep;
         std::generate(MixingSamples.begin(), MixingSamples.end(), [&base,channelStep]
         {
             const auto ret = base;
@@ -807,12 +1041,12 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
         : MixingSamples.size()};
     for(size_t chan{0};chan < realChannels;++chan)
     {
-        static constexpr uint ResBufSize{std::tuple_size_v<decltype(DeviceBase::mResampleData)>};
+        static constexpr uint ResBufSize{std::tuple_size_v<decltype(MixerScratch::mResampleData)>};
         static constexpr uint srcSizeMax{ResBufSize - MaxResamplerEdge};
 
         const al::span prevSamples{mPrevSamples[chan]};
-        std::copy(prevSamples.cbegin(), prevSamples.cend(), Device->mResampleData.begin());
-        const auto resampleBuffer = al::span{Device->mResampleData}.subspan<MaxResamplerEdge>();
+        std::copy(prevSamples.cbegin(), prevSamples.cend(), Scratch.mResampleData.begin());
+        const auto resampleBuffer = al::span{Scratch.mResampleData}.subspan<MaxResamplerEdge>();
         int intPos{DataPosInt};
         uint fracPos{DataPosFrac};
 
@@ -906,7 +1140,7 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
                 const auto bufferSamples = resampleBuffer.subspan(srcSampleDelay,
                     srcBufferSize-srcSampleDelay);
                 LoadBufferStatic(BufferListItem, BufferLoopItem, uintPos, mFmtType, chan,
-                    mFrameStep, bufferSamples);
+                    mFrameStep, bufferSamples, &mChans[chan].mADPCMCache);
             }
             else if(mFlags.test(VoiceIsCallback))
             {
@@ -944,7 +1178,7 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
                 const auto bufferSamples = resampleBuffer.subspan(srcSampleDelay,
                     srcBufferSize-srcSampleDelay);
                 LoadBufferQueue(BufferListItem, BufferLoopItem, uintPos, mFmtType, chan,
-                    mFrameStep, bufferSamples);
+                    mFrameStep, bufferSamples, &mChans[chan].mADPCMCache);
             }
 
             /* If there's a matching sample step and no phase offset, use a
@@ -954,7 +1188,7 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
                 std::copy_n(resampleBuffer.cbegin(), dstBufferSize,
                     MixingSamples[chan]+samplesLoaded);
             else
-                mResampler(&mResampleState, Device->mResampleData, fracPos, increment,
+                mResampler(&mResampleState, Scratch.mResampleData, fracPos, increment,
                     {MixingSamples[chan]+samplesLoaded, dstBufferSize});
 
             /* Store the last source samples used for next time. */
@@ -968,7 +1202,7 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
                 {
                     const size_t dstOffset{samplesToMix - samplesLoaded};
                     const size_t srcOffset{(dstOffset*increment + fracPos) >> MixerFracBits};
-                    std::copy_n(Device->mResampleData.cbegin()+srcOffset, prevSamples.size(),
+                    std::copy_n(Scratch.mResampleData.cbegin()+srcOffset, prevSamples.size(),
                         prevSamples.begin());
                 }
             }
@@ -986,8 +1220,8 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
                  * resampleBuffer to the front to reuse it. prevSamples isn't
                  * reliable since it's only updated for the end of the mix.
                  */
-                std::copy_n(Device->mResampleData.cbegin()+srcOffset, MaxResamplerPadding,
-                    Device->mResampleData.begin());
+                std::copy_n(Scratch.mResampleData.cbegin()+srcOffset, MaxResamplerPadding,
+                    Scratch.mResampleData.begin());
             }
         }
     }
@@ -1016,6 +1250,12 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
         }
     }
 
+    /* A MonoDup voice's second channel aliases the first, which must only be
+     * scaled once.
+     */
+    ApplyScheduledGain(MixingSamples.first((mFmtChannels == FmtMonoDup) ? 1 : mChans.size()),
+        samplesToMix, mGainRamp, deviceTime, OutPos, StopPos, Device->Frequency);
+
     const uint Counter{mFlags.test(VoiceIsFading) ? std::min(samplesToMix, 64u) : 0u};
     if(!Counter)
     {
@@ -1040,32 +1280,52 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
         }
     }
 
+    /* A voice that's stopping, or was just made virtual, fades out to
+     * silence.
+     */
+    const bool audible{vstate == Playing && !mFlags.test(VoiceIsVirtual)};
+
+    /* Now filter and mix to the appropriate outputs. Each channel's direct and
+     * send paths are independent filter streams, so they're queued up with
+     * the streams of other voices mixed with this scratch storage, and get
+     * filtered together before being mixed. Unfiltered paths are mixed
+     * directly.
+     */
+    auto add_path = [&,this](const uint chan, const uint path, BiquadFilter &lpfilter,
+        BiquadFilter &hpfilter, const int type, const al::span<const float> samples)
+    {
+        const PendingLaneMix mixparams{this, chan, path, Counter, OutPos, Group, audible,
+            vstate == Playing};
+        FilterLane lane{};
+        if(!PrepareFilterLane(lane, lpfilter, hpfilter, type))
+            return mixPath(mixparams, samples, Scratch, Device);
+
+        /* Queued streams are filtered together for the same number of
+         * samples.
+         */
+        if(Scratch.mNumLanes > 0 && Scratch.mLaneSamples != samplesToMix)
+            FlushFilterLanes(Scratch, Device);
+
+        const size_t idx{Scratch.mNumLanes++};
+        const auto line = al::span{Scratch.FilteredData[idx]}.first(samplesToMix);
+        std::copy(samples.begin(), samples.end(), line.begin());
+        lane.mSrc = line;
+        lane.mDst = line;
+        Scratch.mLanes[idx] = lane;
+        Scratch.mLaneMixes[idx] = mixparams;
+        Scratch.mLaneSamples = samplesToMix;
+        if(Scratch.mNumLanes == Scratch.mLanes.size())
+            FlushFilterLanes(Scratch, Device);
+    };
+
     auto voiceSamples = MixingSamples.begin();
-    for(auto &chandata : mChans)
+    for(uint chan{0};chan < mChans.size();++chan)
     {
-        /* Now filter and mix to the appropriate outputs. */
-        const al::span<float,BufferLineSize> FilterBuf{Device->FilteredData};
+        ChannelData &chandata = mChans[chan];
+        const al::span<const float> samples{*voiceSamples, samplesToMix};
         {
             DirectParams &parms = chandata.mDryParams;
-            const auto samples = DoFilters(parms.LowPass, parms.HighPass, FilterBuf,
-                {*voiceSamples, samplesToMix}, mDirect.FilterType);
-
-            if(mFlags.test(VoiceHasHrtf))
-            {
-                const float TargetGain{parms.Hrtf.Target.Gain * float(vstate == Playing)};
-                DoHrtfMix(samples, parms, TargetGain, Counter, OutPos, (vstate == Playing),
-                    Device);
-            }
-            else
-            {
-                const auto TargetGains = (vstate == Playing) ? al::span{parms.Gains.Target}
-                    : al::span{SilentTarget};
-                if(mFlags.test(VoiceHasNfc))
-                    DoNfcMix(samples, mDirect.Buffer, parms, TargetGains, Counter, OutPos, Device);
-                else
-                    MixSamples(samples, mDirect.Buffer, parms.Gains.Current, TargetGains, Counter,
-                        OutPos);
-            }
+            add_path(chan, 0, parms.LowPass, parms.HighPass, mDirect.FilterType, samples);
         }
 
         for(uint send{0};send < NumSends;++send)
@@ -1074,19 +1334,21 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
                 continue;
 
             SendParams &parms = chandata.mWetParams[send];
-            const auto samples = DoFilters(parms.LowPass, parms.HighPass, FilterBuf,
-                {*voiceSamples, samplesToMix}, mSend[send].FilterType);
-
-            const auto TargetGains = (vstate == Playing) ? al::span{parms.Gains.Target}
-                : al::span{SilentTarget};
-            MixSamples(samples, mSend[send].Buffer, parms.Gains.Current, TargetGains, Counter,
-                OutPos);
+            add_path(chan, send+1, parms.LowPass, parms.HighPass, mSend[send].FilterType,
+                samples);
         }
 
         ++voiceSamples;
     }
 
+    /* A voice that may stop with this mix can be reused after it's stopped,
+     * so its queued streams need to be mixed now.
+     */
+    if(vstate != Playing || StopEnds)
+        FlushFilterLanes(Scratch, Device);
+
     mFlags.set(VoiceIsFading);
+    mFlags.set(VoiceFadedOut, !audible);
 
     /* Don't update positions and buffers if we were stopping. */
     if(vstate == Stopping) UNLIKELY
@@ -1095,6 +1357,149 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
         return;
     }
 
+    if(StopEnds) UNLIKELY
+    {
+        end_scheduled();
+        return;
+    }
+
+    advancePosition(Context, DataPosInt, DataPosFrac, BufferListItem, BufferLoopItem,
+        samplesToMix, Group);
+}
+
+void Voice::mixPath(const PendingLaneMix &params, const al::span<const float> samples,
+    MixerScratch &Scratch, DeviceBase *Device)
+{
+    static constexpr std::array<float,MaxOutputChannels> SilentTarget{};
+
+    ChannelData &chandata = mChans[params.mChannel];
+    if(params.mPath == 0)
+    {
+        DirectParams &parms = chandata.mDryParams;
+        if(mFlags.test(VoiceHasHrtf))
+        {
+            const float TargetGain{parms.Hrtf.Target.Gain * float(params.mAudible)};
+            DoHrtfMix(samples, parms, TargetGain, params.mCounter, params.mOutPos,
+                params.mIsPlaying, Scratch, Device);
+            return;
+        }
+
+        /* When mixing a group, redirect output to the group's partial mix.
+         * These follow the main buffers they mirror, the dry/real output in the
+         * device's MixBuffer and the wet buffers in each effect slot's
+         * mWetBuffer.
+         */
+        const auto DirectOut = !params.mGroup ? mDirect.Buffer : al::span{mDirect.Buffer.data()
+            + size_t{Device->mMixChannels}*params.mGroup, mDirect.Buffer.size()};
+        const auto TargetGains = params.mAudible ? al::span{parms.Gains.Target}
+            : al::span{SilentTarget};
+        if(mFlags.test(VoiceHasNfc))
+            DoNfcMix(samples, DirectOut, parms, TargetGains, params.mCounter, params.mOutPos,
+                Scratch, Device);
+        else
+            MixSamples(samples, DirectOut, parms.Gains.Current, TargetGains, params.mCounter,
+                params.mOutPos);
+    }
+    else
+    {
+        const uint send{params.mPath - 1};
+        SendParams &parms = chandata.mWetParams[send];
+        const auto buffer = mSend[send].Buffer;
+        const auto SendOut = !params.mGroup ? buffer
+            : al::span{buffer.data() + buffer.size()*params.mGroup, buffer.size()};
+        const auto TargetGains = params.mAudible ? al::span{parms.Gains.Target}
+            : al::span{SilentTarget};
+        MixSamples(samples, SendOut, parms.Gains.Current, TargetGains, params.mCounter,
+            params.mOutPos);
+    }
+}
+
+void FlushFilterLanes(MixerScratch &Scratch, DeviceBase *Device)
+{
+    const size_t numLanes{std::exchange(Scratch.mNumLanes, 0_uz)};
+    if(numLanes == 0) return;
+
+    const auto lanes = al::span{Scratch.mLanes}.first(numLanes);
+    FilterLanes(lanes, Scratch.mLaneSamples);
+    for(size_t i{0};i < numLanes;++i)
+    {
+        const PendingLaneMix &params = Scratch.mLaneMixes[i];
+        params.mVoice->mixPath(params, lanes[i].mDst, Scratch, Device);
+    }
+}
+
+void Voice::loadVirtualHistory(const int DataPosInt, const uint DataPosFrac,
+    VoiceBufferItem *BufferListItem, VoiceBufferItem *BufferLoopItem, const uint samplesToMix)
+{
+    /* The history holds the source samples around the position at the end of
+     * the update, MaxResamplerEdge samples on either side.
+     */
+    const uint srcAdvance{(DataPosFrac + mStep*samplesToMix) >> MixerFracBits};
+    const int histStart{DataPosInt + static_cast<int>(srcAdvance) - int{MaxResamplerEdge}};
+
+    /* Any samples before the start of the current buffer come from the old
+     * history, which is behind by the amount advanced. If the voice was still
+     * before the start of the buffer, these are silent.
+     */
+    const auto numOld = std::min(static_cast<size_t>(std::max(-histStart, 0)),
+        size_t{MaxResamplerPadding});
+
+    auto srcPos = static_cast<size_t>(std::max(histStart, 0));
+    if(mFlags.test(VoiceIsStatic) && BufferLoopItem)
+    {
+        const size_t loopStart{BufferListItem->mLoopStart};
+        const size_t loopEnd{BufferListItem->mLoopEnd};
+        if(srcPos >= loopEnd)
+            srcPos = ((srcPos-loopStart)%(loopEnd-loopStart)) + loopStart;
+    }
+
+    const size_t realChannels{(mFmtChannels == FmtMonoDup) ? 1u
+        : (mFmtChannels == FmtUHJ2 || mFmtChannels == FmtSuperStereo) ? 2u
+        : mChans.size()};
+    for(size_t chan{0};chan < realChannels;++chan)
+    {
+        const al::span prevSamples{mPrevSamples[chan]};
+        if(DataPosInt >= 0)
+        {
+            /* The ranges overlap, and are the same if not advanced. */
+            if(srcAdvance > 0)
+                std::copy_n(prevSamples.cbegin()+srcAdvance, numOld, prevSamples.begin());
+        }
+        else
+            std::fill_n(prevSamples.begin(), numOld, 0.0f);
+
+        const auto bufferSamples = prevSamples.subspan(numOld);
+        if(mFlags.test(VoiceIsStatic))
+            LoadBufferStatic(BufferListItem, BufferLoopItem, srcPos, mFmtType, chan, mFrameStep,
+                bufferSamples, &mChans[chan].mADPCMCache);
+        else
+            LoadBufferQueue(BufferListItem, BufferLoopItem, srcPos, mFmtType, chan, mFrameStep,
+                bufferSamples, &mChans[chan].mADPCMCache);
+    }
+
+    /* Clear the filter and HRTF history, which the voice will fade in over
+     * when it resumes.
+     */
+    for(auto &chandata : mChans)
+    {
+        chandata.mAmbiSplitter.clear();
+        chandata.mDryParams.LowPass.clear();
+        chandata.mDryParams.HighPass.clear();
+        chandata.mDryParams.Hrtf.History.fill(0.0f);
+        for(auto &parms : chandata.mWetParams)
+        {
+            parms.LowPass.clear();
+            parms.HighPass.clear();
+        }
+    }
+}
+
+void Voice::advancePosition(ContextBase *Context, int DataPosInt, uint DataPosFrac,
+    VoiceBufferItem *BufferListItem, VoiceBufferItem *BufferLoopItem, const uint samplesToMix,
+    const uint Group)
+{
+    const uint increment{mStep};
+
     /* Update voice positions and buffers as needed. */
     DataPosFrac += increment*samplesToMix;
     DataPosInt  += static_cast<int>(DataPosFrac>>MixerFracBits);
@@ -1177,29 +1582,29 @@ void Voice::mix(const State vstate, ContextBase *Context, const nanoseconds devi
     }
     std::atomic_thread_fence(std::memory_order_release);
 
-    /* Send any events now, after the position/buffer info was updated. */
-    const auto enabledevt = Context->mEnabledEvts.load(std::memory_order_acquire);
-    if(buffers_done > 0 && enabledevt.test(al::to_underlying(AsyncEnableBits::BufferCompleted)))
-    {
-        RingBuffer *ring{Context->mAsyncEvents.get()};
-        auto evt_vec = ring->getWriteVector();
-        if(evt_vec[0].len > 0)
-        {
-            auto &evt = InitAsyncEvent<AsyncBufferCompleteEvent>(evt_vec[0].buf);
-            evt.mId = SourceID;
-            evt.mCount = buffers_done;
-            ring->writeAdvance(1);
-        }
-    }
-
     if(!BufferListItem)
     {
         /* If the voice just ended, set it to Stopping so the next render
          * ensures any residual noise fades to 0 amplitude.
          */
         mPlayState.store(Stopping, std::memory_order_release);
-        if(enabledevt.test(al::to_underlying(AsyncEnableBits::SourceState)))
-            SendSourceStoppedEvent(Context, SourceID);
+    }
+
+    /* Send any events now, after the position/buffer info was updated. */
+    if(!Group)
+        SendMixEvents(Context, SourceID, buffers_done, !BufferListItem,
+            mFlags.test(VoiceIsOneShot));
+    else
+        mPendingEvents = PendingEvents{SourceID, buffers_done, !BufferListItem};
+}
+
+void Voice::sendPendingEvents(ContextBase *Context)
+{
+    if(mPendingEvents.mBuffersDone > 0 || mPendingEvents.mStopped)
+    {
+        SendMixEvents(Context, mPendingEvents.mSourceID, mPendingEvents.mBuffersDone,
+            mPendingEvents.mStopped, mFlags.test(VoiceIsOneShot));
+        mPendingEvents = PendingEvents{};
     }
 }
 
@@ -1226,6 +1631,8 @@ void Voice::prepare(DeviceBase *device)
     mChans.resize(num_channels);
     mPrevSamples.reserve(std::max(2u, num_channels));
     mPrevSamples.resize(num_channels);
+    for(auto &chandata : mChans)
+        chandata.mADPCMCache.clear();
 
     mDecoder = nullptr;
     mDecoderPadding = 0;
@@ -1337,4 +1744,7 @@ void Voice::prepare(DeviceBase *device)
         }
         mFlags.reset(VoiceIsAmbisonic);
     }
+
+    /* The cleared parameters can't be rescaled or reused by the next update. */
+    mFlags.set(VoiceNeedsFullUpdate);
 }
@@ -22,11 +22,14 @@
 #include "opthelpers.h"
 #include "resampler_limits.h"
 #include "uhjfilter.h"
+#include "vecmat.h"
 #include "vector.h"
 
 struct ContextBase;
 struct DeviceBase;
 struct EffectSlot;
+struct MixerScratch;
+struct PendingLaneMix;
 enum class DistanceModel : unsigned char;
 
 using uint = unsigned int;
@@ -35,12 +38,83 @@ using uint = unsigned int;
 inline constexpr size_t MaxSendCount{6};
 
 
+/* Decoder states saved while loading ADPCM samples, so a later load from the
+ * middle of the same block can resume from the nearest earlier state instead
+ * of decoding from the start of the block. This keeps large ADPCM blocks from
+ * being repeatedly decoded as they play, which would otherwise happen with
+ * each mix.
+ */
+struct ADPCMCache {
+    /* How many samples apart the states are saved within a block. */
+    static constexpr uint Interval{32};
+
+    struct Checkpoint {
+        const std::byte *mBlock{};
+        uint mOffset{};
+        std::array<int,3> mState{};
+    };
+    std::array<Checkpoint,4> mPoints{};
+    uint mNext{0u};
+
+    /** Finds the latest saved state for the block at or before the offset. */
+    [[nodiscard]]
+    auto find(const std::byte *block, const size_t offset) const noexcept -> const Checkpoint*
+    {
+        const Checkpoint *ret{nullptr};
+        for(const auto &point : mPoints)
+        {
+            if(point.mBlock == block && point.mOffset <= offset
+                && (!ret || point.mOffset > ret->mOffset))
+                ret = &point;
+        }
+        return ret;
+    }
+
+    void store(const std::byte *block, const size_t offset, const std::array<int,3> &state)
+        noexcept
+    {
+        for(const auto &point : mPoints)
+        {
+            if(point.mBlock == block && point.mOffset == offset)
+                return;
+        }
+        mPoints[mNext] = Checkpoint{block, static_cast<uint>(offset), state};
+        mNext = (mNext+1) % static_cast<uint>(mPoints.size());
+    }
+
+    /** Drops any saved states for the block. */
+    void forget(const std::byte *block) noexcept
+    {
+        for(auto &point : mPoints)
+        {
+            if(point.mBlock == block)
+                point = Checkpoint{};
+        }
+    }
+
+    void clear() noexcept
+    {
+        mPoints.fill(Checkpoint{});
+        mNext = 0;
+    }
+};
+
+
 enum class SpatializeMode : unsigned char {
     Off,
     On,
     Auto
 };
 
+/* Whether a voice is panned at first order, instead of the device's full
+ * ambisonic order. Auto uses the context's distance and gain thresholds.
+ */
+enum class LowOrderMode : unsigned char {
+    Off,
+    On,
+    Auto
+};
+
 enum class DirectMode : unsigned char {
     Off,
     DropMismatch,
@@ -51,6 +125,20 @@ enum class DirectMode : unsigned char {
 inline constexpr uint MaxPitch{10};
 
 
+/* The source's position, direction, and velocity in listener space, which is
+ * calculated for a batch of voices at once by CalcVoiceGeometry.
+ */
+struct VoiceGeometry {
+    alu::Vector ToSource;
+    alu::Vector Direction;
+    float Distance;
+    bool Directional;
+    /* The source and listener velocities along the ToSource vector. */
+    float SourceVel;
+    float ListenerVel;
+};
+
+
 enum {
     AF_None = 0,
     AF_LowPass = 1,
@@ -130,6 +218,7 @@ struct VoiceProps {
     Resampler mResampler;
     DirectMode DirectChannels;
     SpatializeMode mSpatializeMode;
+    LowOrderMode mLowOrderMode;
 
     bool DryGainHFAuto;
     bool WetGainAuto;
@@ -171,6 +260,26 @@ struct VoicePropsItem : public VoiceProps {
     std::atomic<VoicePropsItem*> next{nullptr};
 };
 
+/* A linear gain ramp scheduled on the device clock, applied on top of the
+ * voice's mixing gains. The gain holds at mFrom until mStart, and at mTo from
+ * mEnd on.
+ */
+struct VoiceGainRamp {
+    std::chrono::nanoseconds mStart{};
+    std::chrono::nanoseconds mEnd{};
+    float mFrom{1.0f};
+    float mTo{1.0f};
+
+    [[nodiscard]] auto at(const std::chrono::nanoseconds time) const noexcept -> float
+    {
+        if(time >= mEnd) return mTo;
+        if(time <= mStart) return mFrom;
+        const auto t = static_cast<double>((time-mStart).count())
+            / static_cast<double>((mEnd-mStart).count());
+        return mFrom + static_cast<float>(t)*(mTo-mFrom);
+    }
+};
+
 enum : uint {
     VoiceIsStatic,
     VoiceIsCallback,
@@ -179,6 +288,11 @@ enum : uint {
     VoiceIsFading,
     VoiceHasHrtf,
     VoiceHasNfc,
+    VoiceIsLowOrder,
+    VoiceIsVirtual,
+    VoiceFadedOut,
+    VoiceIsOneShot,
+    VoiceNeedsFullUpdate,
 
     VoiceFlagCount
 };
@@ -217,6 +331,12 @@ struct SIMDALIGN Voice {
 
     std::chrono::nanoseconds mStartTime{};
 
+    /* Scheduled stop time and gain ramp. These are reset when the voice is
+     * started, and after that are only set by the mixer from voice changes.
+     */
+    std::chrono::nanoseconds mStopTime{std::chrono::nanoseconds::max()};
+    VoiceGainRamp mGainRamp;
+
     /* Properties for the attached buffer(s). */
     FmtChannels mFmtChannels{};
     FmtType mFmtType{};
@@ -239,12 +359,26 @@ struct SIMDALIGN Voice {
     InterpState mResampleState;
 
     std::bitset<VoiceFlagCount> mFlags;
+    /* The loudest target gain of any output, used to rank voices. */
+    float mAudibleGain{0.0f};
+    /* The listener-relative geometry the parameters were last calculated
+     * with, to check if a listener update changed it enough to recalculate.
+     */
+    VoiceGeometry mGeometry{};
     uint mNumCallbackBlocks{0};
     uint mCallbackBlockBase{0};
 
     struct TargetData {
         int FilterType{};
         al::span<FloatBufferLine> Buffer;
+
+        /* The base gain and filter parameters the target gains and filters
+         * were last calculated with, so gain and filter changes only need to
+         * update the outputs they affect.
+         */
+        float BaseGain{};
+        float GainHF{}, HFReference{};
+        float GainLF{}, LFReference{};
     };
     TargetData mDirect;
     std::array<TargetData,MaxSendCount> mSend;
@@ -263,17 +397,48 @@ struct SIMDALIGN Voice {
 
         DirectParams mDryParams;
         std::array<SendParams,MaxSendCount> mWetParams;
+
+        ADPCMCache mADPCMCache;
     };
     al::vector<ChannelData> mChans{2};
 
+    /* Events from mixing on a worker thread. The async event ring buffer only
+     * allows one writer, so these are held until the mixer thread sends them.
+     */
+    struct PendingEvents {
+        uint mSourceID{};
+        uint mBuffersDone{};
+        bool mStopped{};
+    };
+    PendingEvents mPendingEvents;
+
     Voice() = default;
     ~Voice() = default;
 
     Voice(const Voice&) = delete;
     Voice& operator=(const Voice&) = delete;
 
+    /**
+     * Mixes the voice using the given scratch storage. Group 0 mixes directly
+     * to the voice's target buffers, while groups 1 and up mix to the partial
+     * mix buffers of that group, and hold any events in mPendingEvents to be
+     * sent with sendPendingEvents. Filtered streams may be left queued in the
+     * scratch storage, to be mixed by FlushFilterLanes.
+     */
     void mix(const State vstate, ContextBase *Context, const std::chrono::nanoseconds deviceTime,
-        const uint SamplesToDo);
+        const uint SamplesToDo, MixerScratch &Scratch, const uint Group);
+    /** Mixes the samples of one channel's direct path or send. */
+    void mixPath(const PendingLaneMix &params, const al::span<const float> samples,
+        MixerScratch &Scratch, DeviceBase *Device);
+
+    void sendPendingEvents(ContextBase *Context);
+
+    void loadVirtualHistory(const int DataPosInt, const uint DataPosFrac,
+        VoiceBufferItem *BufferListItem, VoiceBufferItem *BufferLoopItem,
+        const uint samplesToMix);
+    void advancePosition(ContextBase *Context, int DataPosInt, uint DataPosFrac,
+        VoiceBufferItem *BufferListItem, VoiceBufferItem *BufferLoopItem,
+        const uint samplesToMix, const uint Group);
 
     void prepare(DeviceBase *device);
 
@@ -282,4 +447,11 @@ struct SIMDALIGN Voice {
 
 inline Resampler ResamplerDefault{Resampler::Gaussian};
 
+/**
+ * Filters and mixes the streams queued in the scratch storage. This must be
+ * called after mixing voices with the scratch storage, before the voices are
+ * updated again.
+ */
+void FlushFilterLanes(MixerScratch &Scratch, DeviceBase *Device);
+
 #endif /* CORE_VOICE_H */
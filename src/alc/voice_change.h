@@ -2,6 +2,7 @@
 #define VOICE_CHANGE_H
 
 #include <atomic>
+#include <chrono>
 
 struct Voice;
 
@@ -13,7 +14,9 @@ enum class VChangeState {
     Stop,
     Play,
     Pause,
-    Restart
+    Restart,
+    StopAt,
+    GainRamp
 };
 struct VoiceChange {
     Voice *mOldVoice{nullptr};
@@ -21,6 +24,13 @@ struct VoiceChange {
     uint mSourceID{0};
     VChangeState mState{};
 
+    /* Device clock time for StopAt and GainRamp changes, with the ramp's
+     * duration and target gain.
+     */
+    std::chrono::nanoseconds mTime{};
+    std::chrono::nanoseconds mDuration{};
+    float mGain{};
+
     std::atomic<VoiceChange*> mNext{nullptr};
 };
 
@@ -0,0 +1,93 @@
+#include "config.h"
+
+#include "workerpool.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "althrd_setname.h"
+#include "device.h"
+#include "fpu_ctrl.h"
+#include "helpers.h"
+#include "logging.h"
+
+
+WorkerPool::WorkerPool(std::size_t numthreads) : mRequestedCount{numthreads}
+{
+    numthreads = std::max(numthreads, std::size_t{1}) - 1;
+    mWorkers.reserve(numthreads);
+    try {
+        for(std::size_t i{0};i < numthreads;++i)
+        {
+            auto &worker = mWorkers.emplace_back(std::make_unique<Worker>());
+            worker->mThread = std::thread{&WorkerPool::workerProc, this, worker.get()};
+        }
+    }
+    catch(std::exception &e) {
+        ERR("Failed to start mixer worker thread {}: {}", mWorkers.size(), e.what());
+        if(!mWorkers.empty() && !mWorkers.back()->mThread.joinable())
+            mWorkers.pop_back();
+    }
+    TRACE("Started {} mixer worker thread{}", mWorkers.size(), (mWorkers.size()==1)?"":"s");
+}
+
+WorkerPool::~WorkerPool()
+{
+    mQuit.store(true, std::memory_order_release);
+    for(auto &worker : mWorkers)
+        worker->mStartSem.post();
+    for(auto &worker : mWorkers)
+        worker->mThread.join();
+}
+
+
+void WorkerPool::processTasks() noexcept
+{
+    std::size_t idx{mNextTask.fetch_add(1u, std::memory_order_relaxed)};
+    while(idx < mTaskCount)
+    {
+        mTaskFunc(mTaskData, idx);
+        idx = mNextTask.fetch_add(1u, std::memory_order_relaxed);
+    }
+}
+
+void WorkerPool::workerProc(Worker *self)
+{
+    SetRTPriority();
+    althrd_setname(GetMixerWorkerThreadName());
+
+    FPUCtl mixer_mode{};
+    while(true)
+    {
+        self->mStartSem.wait();
+        if(mQuit.load(std::memory_order_acquire))
+            break;
+
+        processTasks();
+        mDoneSem.post();
+    }
+}
+
+void WorkerPool::dispatch(TaskFunc func, void *userdata, std::size_t count)
+{
+    if(count == 0) return;
+
+    mTaskFunc = func;
+    mTaskData = userdata;
+    mTaskCount = count;
+    mNextTask.store(0u, std::memory_order_relaxed);
+
+    /* Only wake as many workers as there are tasks left for, after the one
+     * this thread will take. The semaphores ensure the task info set above is
+     * visible to the workers, and that their results are visible here once
+     * they signal being done.
+     */
+    const std::size_t numworkers{std::min(mWorkers.size(), count-1)};
+    for(std::size_t i{0};i < numworkers;++i)
+        mWorkers[i]->mStartSem.post();
+
+    processTasks();
+
+    for(std::size_t i{0};i < numworkers;++i)
+        mDoneSem.wait();
+}
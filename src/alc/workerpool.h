@@ -0,0 +1,71 @@
+#ifndef CORE_WORKERPOOL_H
+#define CORE_WORKERPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "alsem.h"
+
+
+/* A persistent set of threads the mixer can hand a batch of independent tasks
+ * to. The calling thread takes part in processing the tasks, and run() only
+ * returns once every task has finished. The tasks must not throw.
+ */
+class WorkerPool {
+    using TaskFunc = void(*)(void *userdata, std::size_t idx) noexcept;
+
+    struct Worker {
+        std::thread mThread;
+        al::semaphore mStartSem;
+    };
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::size_t mRequestedCount{};
+    al::semaphore mDoneSem;
+
+    TaskFunc mTaskFunc{};
+    void *mTaskData{};
+    std::size_t mTaskCount{};
+    std::atomic<std::size_t> mNextTask{};
+    std::atomic<bool> mQuit{false};
+
+    void processTasks() noexcept;
+    void workerProc(Worker *self);
+    void dispatch(TaskFunc func, void *userdata, std::size_t count);
+
+public:
+    /* Creates a pool with the given number of threads, including the thread
+     * calling run().
+     */
+    explicit WorkerPool(std::size_t numthreads);
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    ~WorkerPool();
+
+    [[nodiscard]]
+    auto threadCount() const noexcept -> std::size_t { return mWorkers.size() + 1; }
+    /* The number of threads the pool was created with, which may be more than
+     * the threads that could be started.
+     */
+    [[nodiscard]]
+    auto requestedCount() const noexcept -> std::size_t { return mRequestedCount; }
+
+    /**
+     * Calls func(idx) for each idx in [0...count), spread over the available
+     * threads. The order the tasks run in, and which thread runs them, is
+     * unspecified.
+     */
+    template<typename F>
+    void run(const std::size_t count, F&& func)
+    {
+        using FuncT = std::remove_reference_t<F>;
+        static constexpr auto invoker = [](void *userdata, std::size_t idx) noexcept -> void
+        { (*static_cast<FuncT*>(userdata))(idx); };
+        dispatch(invoker, const_cast<std::remove_const_t<FuncT>*>(std::addressof(func)), count);
+    }
+};
+
+#endif /* CORE_WORKERPOOL_H */
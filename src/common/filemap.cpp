@@ -0,0 +1,235 @@
+#include "config.h"
+
+#include "filemap.h"
+
+#include <cerrno>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+
+#include "strutils.h"
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+/* Checks the requested range against the file size, returning the length to
+ * map (or 0 if invalid, with errno set).
+ */
+auto CheckRange(const std::uint64_t filesize, const std::uint64_t offset, std::size_t length)
+    noexcept -> std::size_t
+{
+    if(offset >= filesize)
+    {
+        errno = EINVAL;
+        return 0;
+    }
+    const std::uint64_t avail{filesize - offset};
+    if(length == 0)
+    {
+        if(avail > std::numeric_limits<std::size_t>::max())
+        {
+            errno = EFBIG;
+            return 0;
+        }
+        length = static_cast<std::size_t>(avail);
+    }
+    else if(length > avail)
+    {
+        errno = EINVAL;
+        return 0;
+    }
+    return length;
+}
+
+} // namespace
+
+
+FileMapping::FileMapping(FileMapping&& rhs) noexcept
+    : mBase{std::exchange(rhs.mBase, nullptr)}, mBaseSize{std::exchange(rhs.mBaseSize, 0u)}
+    , mData{std::exchange(rhs.mData, {})}
+{ }
+
+FileMapping& FileMapping::operator=(FileMapping&& rhs) noexcept
+{
+    if(this != &rhs)
+    {
+        unmap();
+        mBase = std::exchange(rhs.mBase, nullptr);
+        mBaseSize = std::exchange(rhs.mBaseSize, 0u);
+        mData = std::exchange(rhs.mData, {});
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+auto FileMapping::MapHandle(void *file, const std::uint64_t offset, std::size_t length)
+    -> std::optional<FileMapping>
+{
+    LARGE_INTEGER filesize{};
+    if(!GetFileSizeEx(file, &filesize))
+    {
+        errno = EIO;
+        return std::nullopt;
+    }
+    length = CheckRange(static_cast<std::uint64_t>(filesize.QuadPart), offset, length);
+    if(length == 0) return std::nullopt;
+
+    /* Views have to start on a multiple of the allocation granularity. */
+    SYSTEM_INFO sysinfo{};
+    GetSystemInfo(&sysinfo);
+    const std::uint64_t base_offset{offset - offset%sysinfo.dwAllocationGranularity};
+    const auto lead = static_cast<std::size_t>(offset - base_offset);
+    if(length > std::numeric_limits<std::size_t>::max() - lead)
+    {
+        errno = EFBIG;
+        return std::nullopt;
+    }
+
+    HANDLE mapping{CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr)};
+    if(!mapping)
+    {
+        errno = EACCES;
+        return std::nullopt;
+    }
+    /* The view holds a reference to the mapping object, so it can be closed
+     * right away.
+     */
+    void *base{MapViewOfFile(mapping, FILE_MAP_COPY, static_cast<DWORD>(base_offset>>32),
+        static_cast<DWORD>(base_offset), length+lead)};
+    CloseHandle(mapping);
+    if(!base)
+    {
+        errno = ENOMEM;
+        return std::nullopt;
+    }
+
+    return FileMapping{base, length+lead, lead, length};
+}
+
+auto FileMapping::Open(const std::string &fname, const std::uint64_t offset,
+    const std::size_t length) -> std::optional<FileMapping>
+{
+    std::wstring wname{utf8_to_wstr(fname)};
+    HANDLE file{CreateFileW(wname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)};
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        errno = ENOENT;
+        return std::nullopt;
+    }
+    auto ret = MapHandle(file, offset, length);
+    CloseHandle(file);
+    return ret;
+}
+
+auto FileMapping::Open(const int fd, const std::uint64_t offset, const std::size_t length)
+    -> std::optional<FileMapping>
+{
+    auto file = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        errno = EBADF;
+        return std::nullopt;
+    }
+    return MapHandle(file, offset, length);
+}
+
+void FileMapping::unmap() noexcept
+{
+    if(mBase)
+        UnmapViewOfFile(mBase);
+    mBase = nullptr;
+    mBaseSize = 0;
+    mData = {};
+}
+
+/* Windows has no equivalent for access pattern hints. */
+void FileMapping::advise(Advice) const noexcept
+{ }
+
+#else
+
+auto FileMapping::Open(const std::string &fname, const std::uint64_t offset,
+    const std::size_t length) -> std::optional<FileMapping>
+{
+    const int fd{open(fname.c_str(), O_RDONLY | O_CLOEXEC)};
+    if(fd < 0) return std::nullopt;
+
+    auto ret = Open(fd, offset, length);
+    const int err{errno};
+    close(fd);
+    errno = err;
+    return ret;
+}
+
+auto FileMapping::Open(const int fd, const std::uint64_t offset, std::size_t length)
+    -> std::optional<FileMapping>
+{
+    struct stat st{};
+    if(fstat(fd, &st) != 0)
+        return std::nullopt;
+    length = CheckRange(static_cast<std::uint64_t>(st.st_size), offset, length);
+    if(length == 0) return std::nullopt;
+
+    /* Mappings have to start on a page boundary. */
+    const auto pagesize = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    const std::uint64_t base_offset{offset - offset%pagesize};
+    const auto lead = static_cast<std::size_t>(offset - base_offset);
+    if(length > std::numeric_limits<std::size_t>::max() - lead
+        || base_offset > static_cast<std::uint64_t>(std::numeric_limits<off_t>::max()))
+    {
+        errno = EOVERFLOW;
+        return std::nullopt;
+    }
+
+    /* A private writable mapping lets the data be modified in place like any
+     * other buffer storage, with only the written pages being copied.
+     */
+    void *base{mmap(nullptr, length+lead, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd,
+        static_cast<off_t>(base_offset))};
+    if(base == MAP_FAILED)
+        return std::nullopt;
+
+    return FileMapping{base, length+lead, lead, length};
+}
+
+void FileMapping::unmap() noexcept
+{
+    if(mBase)
+        munmap(mBase, mBaseSize);
+    mBase = nullptr;
+    mBaseSize = 0;
+    mData = {};
+}
+
+void FileMapping::advise(const Advice advice) const noexcept
+{
+    if(!mBase) return;
+
+    int posix_advice{POSIX_MADV_NORMAL};
+    switch(advice)
+    {
+    case Advice::Normal: posix_advice = POSIX_MADV_NORMAL; break;
+    case Advice::Sequential: posix_advice = POSIX_MADV_SEQUENTIAL; break;
+    case Advice::Random: posix_advice = POSIX_MADV_RANDOM; break;
+    case Advice::WillNeed: posix_advice = POSIX_MADV_WILLNEED; break;
+    }
+    std::ignore = posix_madvise(mBase, mBaseSize, posix_advice);
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef AL_FILEMAP_H
+#define AL_FILEMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "alspan.h"
+
+
+/* A private, copy-on-write mapping of part of a file. Until written to, the
+ * mapped pages are read on demand from the OS's file cache, and are shared
+ * with any other mapping of the same file.
+ */
+class FileMapping {
+    void *mBase{nullptr};
+    std::size_t mBaseSize{0u};
+    al::span<std::byte> mData;
+
+    FileMapping(void *base, std::size_t basesize, std::size_t offset, std::size_t length)
+        noexcept
+        : mBase{base}, mBaseSize{basesize}, mData{static_cast<std::byte*>(base)+offset, length}
+    { }
+
+#ifdef _WIN32
+    static auto MapHandle(void *file, std::uint64_t offset, std::size_t length)
+        -> std::optional<FileMapping>;
+#endif
+    void unmap() noexcept;
+
+public:
+    enum class Advice : std::uint8_t {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed
+    };
+
+    FileMapping() noexcept = default;
+    FileMapping(const FileMapping&) = delete;
+    FileMapping(FileMapping&& rhs) noexcept;
+    ~FileMapping() { unmap(); }
+
+    FileMapping& operator=(const FileMapping&) = delete;
+    FileMapping& operator=(FileMapping&& rhs) noexcept;
+
+    /**
+     * Maps length bytes of the named file (in UTF-8), starting at the given
+     * byte offset. A length of 0 maps to the end of the file. Returns an
+     * empty optional on failure, with errno set.
+     */
+    static auto Open(const std::string &fname, std::uint64_t offset, std::size_t length)
+        -> std::optional<FileMapping>;
+    /**
+     * Same as above, but with an already opened file descriptor. The
+     * descriptor is not closed, and may be closed by the caller once mapped.
+     */
+    static auto Open(int fd, std::uint64_t offset, std::size_t length)
+        -> std::optional<FileMapping>;
+
+    [[nodiscard]] auto data() const noexcept -> al::span<std::byte> { return mData; }
+    [[nodiscard]] auto empty() const noexcept -> bool { return mData.empty(); }
+
+    /** Hints to the OS how the mapped data will be accessed. */
+    void advise(Advice advice) const noexcept;
+
+    void reset() noexcept { unmap(); }
+};
+
+#endif /* AL_FILEMAP_H */